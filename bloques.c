@@ -0,0 +1,97 @@
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "bloques.h"
+
+#define BYTES_POR_BLOQUE 16384
+#define MINIMO_POR_BLOQUE 16
+#define PRIMER_BLOQUE 8             // Elementos del primer bloque
+
+/* Encabezado de cada bloque. La union lo deja del tamaño de los tipos mas
+ * alineados, asi los elementos que siguen quedan bien alineados.
+ */
+struct bloque {
+    union {
+        bloque_t* siguiente;
+        long double alineacion_real;
+        void* alineacion_puntero;
+        long long alineacion_entero;
+    } encabezado;
+};
+
+/* Primer elemento de un bloque */
+static char* elementos(bloque_t* bloque) {
+    return (char*) (bloque + 1);
+}
+
+void bloques_inicializar(bloques_t* bloques, size_t tam, const memoria_t* memoria) {
+    // El elemento libre guarda el puntero al siguiente libre.
+    if(tam < sizeof(void*)) tam = sizeof(void*);
+    tam = (tam + sizeof(void*) - 1) / sizeof(void*) * sizeof(void*);
+
+    bloques->tam = tam;
+    bloques->por_bloque = BYTES_POR_BLOQUE / tam;
+    if(bloques->por_bloque < MINIMO_POR_BLOQUE) bloques->por_bloque = MINIMO_POR_BLOQUE;
+    bloques->bloques = NULL;
+    bloques->en_bloque = 0;
+    bloques->usados = 0;
+    bloques->libres = NULL;
+    bloques->entregados = 0;
+    bloques->bytes = 0;
+    bloques->memoria = memoria;
+}
+
+void* bloques_pedir(bloques_t* bloques) {
+    void* elemento;
+
+    if(bloques->libres)
+    {
+        elemento = bloques->libres;
+        bloques->libres = *(void**) elemento;
+    }
+    else
+    {
+        if(!bloques->bloques || bloques->usados == bloques->en_bloque)
+        {
+            size_t en_bloque = bloques->en_bloque ? 2 * bloques->en_bloque : PRIMER_BLOQUE;
+            if(en_bloque > bloques->por_bloque) en_bloque = bloques->por_bloque;
+
+            size_t bytes = sizeof(bloque_t) + bloques->tam * en_bloque;
+            bloque_t* bloque = memoria_pedir(bloques->memoria, bytes);
+            if(!bloque) return NULL;
+            bloque->encabezado.siguiente = bloques->bloques;
+            bloques->bloques = bloque;
+            bloques->en_bloque = en_bloque;
+            bloques->usados = 0;
+            bloques->bytes += bytes;
+        }
+        elemento = elementos(bloques->bloques) + bloques->tam * bloques->usados++;
+    }
+
+    bloques->entregados++;
+    return elemento;
+}
+
+void bloques_devolver(bloques_t* bloques, void* elemento) {
+    *(void**) elemento = bloques->libres;
+    bloques->libres = elemento;
+    bloques->entregados--;
+}
+
+size_t bloques_memoria(const bloques_t* bloques) {
+    return bloques->bytes;
+}
+
+void bloques_liberar(bloques_t* bloques) {
+    while(bloques->bloques)
+    {
+        bloque_t* siguiente = bloques->bloques->encabezado.siguiente;
+        memoria_liberar(bloques->memoria, bloques->bloques);
+        bloques->bloques = siguiente;
+    }
+    bloques->en_bloque = 0;
+    bloques->usados = 0;
+    bloques->libres = NULL;
+    bloques->entregados = 0;
+    bloques->bytes = 0;
+}
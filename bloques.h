@@ -0,0 +1,52 @@
+#ifndef BLOQUES_H
+#define BLOQUES_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "memoria.h"
+
+/*
+ * BLOQUES
+ * Reserva de elementos de tamaño fijo. La memoria se pide de a bloques
+ * (un malloc para muchos elementos) y los elementos devueltos quedan en una
+ * lista de libres para reutilizarlos. El primer bloque es chico y cada uno
+ * duplica al anterior hasta el maximo, asi una reserva con pocos elementos
+ * no ocupa un bloque grande. Los bloques recien se liberan todos juntos con
+ * bloques_liberar, sin recorrer los elementos.
+ */
+
+typedef struct bloque bloque_t;
+
+typedef struct bloques {
+    size_t tam;                 // Tamaño de cada elemento (multiplo de sizeof(void*))
+    size_t por_bloque;          // Maximo de elementos por bloque
+    size_t en_bloque;           // Elementos del bloque actual
+    bloque_t* bloques;          // Bloques pedidos, el primero es el actual
+    size_t usados;              // Elementos del bloque actual ya entregados
+    void* libres;               // Elementos devueltos, enlazados entre si
+    size_t entregados;          // Elementos en uso
+    size_t bytes;               // Bytes pedidos para los bloques
+    const memoria_t* memoria;   // De donde salen los bloques (NULL: malloc)
+} bloques_t;
+
+/* Inicializa la reserva para elementos de tam bytes que pide sus bloques a
+ * memoria (NULL para usar malloc). No pide memoria.
+ */
+void bloques_inicializar(bloques_t* bloques, size_t tam, const memoria_t* memoria);
+
+/* Devuelve un elemento sin inicializar, o NULL si no hubo memoria. */
+void* bloques_pedir(bloques_t* bloques);
+
+/* Devuelve a la reserva un elemento pedido con bloques_pedir. */
+void bloques_devolver(bloques_t* bloques, void* elemento);
+
+/* Devuelve los bytes pedidos para los bloques, en uso o no. */
+size_t bloques_memoria(const bloques_t* bloques);
+
+/* Libera todos los bloques. Los elementos que no se devolvieron dejan de ser
+ * validos. La reserva queda vacia y se puede volver a usar.
+ */
+void bloques_liberar(bloques_t* bloques);
+
+#endif // BLOQUES_H
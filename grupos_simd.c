@@ -0,0 +1,106 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "grupos_simd.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define GRUPOS_X86
+#include <immintrin.h>
+#endif
+
+/* Respaldo escalar: grupos de 8 bytes */
+
+static uint32_t coincidir_escalar(const uint8_t* grupo, uint8_t valor) {
+    uint32_t mascara = 0;
+    for(unsigned i = 0; i < 8; i++)
+        if(grupo[i] == valor) mascara |= 1u << i;
+    return mascara;
+}
+
+static uint32_t libres_escalar(const uint8_t* grupo) {
+    uint32_t mascara = 0;
+    for(unsigned i = 0; i < 8; i++)
+        if(grupo[i] & 0x80) mascara |= 1u << i;
+    return mascara;
+}
+
+#ifdef GRUPOS_X86
+
+/* SSE2: grupos de 16 bytes */
+
+__attribute__((target("sse2")))
+static uint32_t coincidir_sse2(const uint8_t* grupo, uint8_t valor) {
+    __m128i bytes = _mm_loadu_si128((const __m128i*) grupo);
+    return (uint32_t) _mm_movemask_epi8(_mm_cmpeq_epi8(bytes, _mm_set1_epi8((char) valor)));
+}
+
+__attribute__((target("sse2")))
+static uint32_t libres_sse2(const uint8_t* grupo) {
+    return (uint32_t) _mm_movemask_epi8(_mm_loadu_si128((const __m128i*) grupo));
+}
+
+/* AVX2: grupos de 32 bytes */
+
+__attribute__((target("avx2")))
+static uint32_t coincidir_avx2(const uint8_t* grupo, uint8_t valor) {
+    __m256i bytes = _mm256_loadu_si256((const __m256i*) grupo);
+    return (uint32_t) _mm256_movemask_epi8(_mm256_cmpeq_epi8(bytes, _mm256_set1_epi8((char) valor)));
+}
+
+__attribute__((target("avx2")))
+static uint32_t libres_avx2(const uint8_t* grupo) {
+    return (uint32_t) _mm256_movemask_epi8(_mm256_loadu_si256((const __m256i*) grupo));
+}
+
+#endif // GRUPOS_X86
+
+static const grupo_operaciones_t OPERACIONES_ESCALAR = { GRUPO_ESCALAR, 8, coincidir_escalar, libres_escalar };
+#ifdef GRUPOS_X86
+static const grupo_operaciones_t OPERACIONES_SSE2 = { GRUPO_SSE2, 16, coincidir_sse2, libres_sse2 };
+static const grupo_operaciones_t OPERACIONES_AVX2 = { GRUPO_AVX2, 32, coincidir_avx2, libres_avx2 };
+#endif
+
+/* Se lee y se escribe con atomicos: lo usan todos los hilos */
+static const grupo_operaciones_t* operaciones = NULL;
+static pthread_once_t eleccion_automatica = PTHREAD_ONCE_INIT;
+
+/* Devuelve si el procesador soporta el conjunto de instrucciones */
+static bool soportado(grupo_instrucciones_t instrucciones) {
+#ifdef GRUPOS_X86
+    __builtin_cpu_init();
+    if(instrucciones == GRUPO_AVX2) return __builtin_cpu_supports("avx2");
+    if(instrucciones == GRUPO_SSE2) return __builtin_cpu_supports("sse2");
+#endif
+    return instrucciones == GRUPO_ESCALAR;
+}
+
+grupo_instrucciones_t grupo_elegir_instrucciones(grupo_instrucciones_t instrucciones) {
+    if(instrucciones == GRUPO_AUTOMATICO) instrucciones = GRUPO_AVX2;
+
+    // Baja hasta encontrar uno soportado; el escalar siempre lo esta.
+    while(instrucciones > GRUPO_ESCALAR && !soportado(instrucciones))
+        instrucciones--;
+
+    const grupo_operaciones_t* elegidas = &OPERACIONES_ESCALAR;
+#ifdef GRUPOS_X86
+    if(instrucciones == GRUPO_SSE2) elegidas = &OPERACIONES_SSE2;
+    if(instrucciones == GRUPO_AVX2) elegidas = &OPERACIONES_AVX2;
+#endif
+    __atomic_store_n(&operaciones, elegidas, __ATOMIC_RELEASE);
+    return elegidas->instrucciones;
+}
+
+/* Eleccion automatica, una sola vez; respeta una eleccion anterior */
+static void elegir_automaticas(void) {
+    if(!__atomic_load_n(&operaciones, __ATOMIC_ACQUIRE)) grupo_elegir_instrucciones(GRUPO_AUTOMATICO);
+}
+
+const grupo_operaciones_t* grupo_operaciones(void) {
+    const grupo_operaciones_t* elegidas = __atomic_load_n(&operaciones, __ATOMIC_ACQUIRE);
+    if(elegidas) return elegidas;
+
+    pthread_once(&eleccion_automatica, elegir_automaticas);
+    return __atomic_load_n(&operaciones, __ATOMIC_ACQUIRE);
+}
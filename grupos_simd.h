@@ -0,0 +1,40 @@
+#ifndef GRUPOS_SIMD_H
+#define GRUPOS_SIMD_H
+
+#include <stdint.h>
+
+/*
+ * Comparacion de grupos de bytes de control para el hash cerrado por grupos.
+ * Cada funcion devuelve una mascara de bits donde el bit i indica que el
+ * byte i del grupo cumple la condicion. El conjunto de instrucciones se elige
+ * en tiempo de ejecucion segun el procesador, con un respaldo escalar.
+ */
+
+typedef enum {
+    GRUPO_AUTOMATICO,       // El mejor disponible en el procesador
+    GRUPO_ESCALAR,          // 8 bytes por grupo, sin SIMD
+    GRUPO_SSE2,             // 16 bytes por grupo
+    GRUPO_AVX2              // 32 bytes por grupo
+} grupo_instrucciones_t;
+
+#define GRUPO_ANCHO_MAXIMO 32
+
+typedef struct grupo_operaciones {
+    grupo_instrucciones_t instrucciones;
+    unsigned ancho;                                             // Bytes por grupo
+    uint32_t (*coincidir)(const uint8_t* grupo, uint8_t valor); // Bytes iguales a valor
+    uint32_t (*libres)(const uint8_t* grupo);                   // Bytes con el bit alto en 1
+} grupo_operaciones_t;
+
+/* Devuelve las operaciones en uso. La primera vez las elige, una sola vez
+ * aunque la pidan varios hilos a la vez.
+ */
+const grupo_operaciones_t* grupo_operaciones(void);
+
+/* Fuerza un conjunto de instrucciones. Si el procesador no lo soporta se usa
+ * el mejor disponible por debajo.
+ * Post: Devuelve el conjunto que quedo en uso.
+ */
+grupo_instrucciones_t grupo_elegir_instrucciones(grupo_instrucciones_t instrucciones);
+
+#endif // GRUPOS_SIMD_H
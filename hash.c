@@ -1,9 +1,13 @@
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 
+#include "hash.h"
+#include "hash_cerrado.h"
+
 #ifdef LOCAL
 #include "Lista/lista.h"
 #else
@@ -11,12 +15,30 @@
 #endif
 
 #include "lookup3.h" /* lookup3.c, by Bob Jenkins, May 2006, Public Domain. */
+#include "hash_rapido.h"
+#include "bloques.h"
+#include "hilos.h"
+#include "memoria.h"
 
 #define LARGO_INICIAL 773
 #define FACTOR_CARGA_MAXIMO 2.5
-#define FACTOR_CARGA_MINIMO 0.5
-#define AUMENTO_LIBRE 2             // Factor para aumentar largo del arreglo
-#define REDUCCION_LIBRE 0.25        // Factor para reducir largo del arreglo
+#define FACTOR_CARGA_MINIMO 0.25
+#define CRECIMIENTO 4               // Despues de redimensionar la carga queda en FACTOR_CARGA_MAXIMO / CRECIMIENTO
+#define MIGRACION_POR_OPERACION 16  // Posiciones del vector viejo que migra cada escritura
+#define LARGO_MAXIMO_LISTA 16       // Con el desborde activado, las listas no pasan de este largo
+#define TROZO_DESBORDE 64           // Nodos por trozo del desborde
+#define CLAVE_CORTA 24              // Bytes de clave (con el '\0') que entran dentro del nodo
+#define CLASES_CLAVE 4              // Reservas para claves de 32, 64, 128 y 256 bytes (con el '\0')
+#define CLAVE_MINIMA 32
+#define LARGO_AFUERA UINT32_MAX     // nodo_hash_t.largo de las claves cuyo largo no entra en 32 bits
+#define CANTIDAD_CHICA 8            // Hasta esta cantidad de claves el hash abierto no tiene vector
+#define LOTE 16                     // Claves que hash_obtener_lote busca a la vez
+#define TRAMO_CARGA 262144          // Pares que hash_guardar_lote ordena a la vez
+#define BITS_RADIX 11               // Bits de la posicion por pasada del ordenamiento
+#define MINIMO_PARALELO 16384       // Pares o nodos desde los que se reparte el trabajo entre hilos
+#define PARTES_POR_HILO 4           // Tareas en que se divide cada trabajo, por hilo
+#define RANGOS_GUARDADO 64          // Rangos de posiciones en que se reparte guardar un tramo
+#define VECINOS_LOTE 16             // Pares de una misma posicion que se comparan al guardar por rangos
 
 /*
  * HASH ABIERTO
@@ -25,35 +47,193 @@
  * Las listas almacenan Nodo_hash con par Clave/Valor
  */
 
+/*
+ * HASH CERRADO
+ * Con hash_crear_tipo se puede elegir un motor de direccionamiento abierto
+ * (ver hash_cerrado.h). En ese caso no se usan ni el vector ni las listas.
+ */
+
+/*
+ * REDIMENSION INCREMENTAL
+ * Con hash_redimension_incremental el hash abierto no reubica todo de una vez:
+ * pide el vector nuevo y deja el viejo al lado. Cada guardar o borrar migra
+ * MIGRACION_POR_OPERACION posiciones del viejo, en orden. Mientras dura la
+ * migracion las claves nuevas van al vector nuevo y las busquedas miran la
+ * posicion del viejo (si todavia no se migro) y la del nuevo.
+ */
+
+/*
+ * HISTERESIS
+ * Crecer y achicar llevan el vector al mismo largo objetivo, el que deja la
+ * carga en factor_carga_maximo / crecimiento (ver largo_objetivo). Como ese
+ * valor queda estrictamente entre los dos umbrales, despues de redimensionar
+ * hacen falta muchas altas o bajas para llegar a cualquiera de ellos: un hash
+ * que guarda y borra alrededor de un umbral no redimensiona una y otra vez.
+ * El vector nunca baja de largo_minimo (el de las opciones o lo reservado).
+ */
+
+/*
+ * DESBORDE ORDENADO
+ * Cada hash usa una semilla al azar, asi no se pueden elegir de antemano
+ * claves que caigan todas en la misma posicion. Por si igual pasa (o la
+ * funcion de hash es mala), cuando la lista de una posicion llega a
+ * LARGO_MAXIMO_LISTA las claves nuevas de esa posicion van al desborde: los
+ * nodos ordenados por codigo, largo y bytes de la clave, repartidos en trozos
+ * de hasta TROZO_DESBORDE nodos. Se busca con busqueda binaria primero entre
+ * los trozos (por su ultimo nodo) y despues dentro del trozo. Insertar o
+ * borrar solo corre nodos dentro de un trozo; cuando uno se llena se parte
+ * en dos y cuando se vacia se libera, asi que el costo por clave no crece
+ * con el desborde aunque todas las claves caigan en la misma posicion.
+ * El desborde no depende del vector, asi que las redimensiones no lo tocan.
+ */
+
+/*
+ * MEMORIA DEL HASH ABIERTO
+ * Los nodo_hash_t, los nodos de las listas y las claves de hasta 256 bytes
+ * salen de reservas por bloques (ver bloques.h) propias de cada hash: un
+ * malloc cada muchos elementos y listas de libres para reusar lo que se
+ * borra. Las claves se redondean a la clase de tamaño (potencia de 2) que
+ * les alcanza; las mas largas usan malloc. hash_destruir libera los bloques
+ * enteros y solo recorre los nodos si tiene que destruir datos o claves
+ * largas.
+ * Las claves de menos de CLAVE_CORTA bytes se guardan dentro del nodo (40
+ * bytes), en el lugar del puntero a la copia: compararlas no sale del nodo.
+ * clave_de_nodo elige segun el largo. Los nodos no se mueven, asi que el
+ * puntero que devuelve el iterador es estable. El largo ocupa 32 bits junto
+ * al codigo; el de una clave de 4 GB o mas va al lado del puntero a su copia
+ * (ver largo_de_nodo).
+ */
+
+/*
+ * HASH CHICO
+ * El hash abierto no pide el vector al crearse. Mientras tenga hasta
+ * CANTIDAD_CHICA claves guarda los punteros a sus nodos (y sus codigos) en un
+ * arreglo dentro de la estructura, donde se buscan recorriendolo. Al guardar
+ * una clave mas pide el vector de LARGO_INICIAL (o el reservado) y pasa los nodos a las
+ * listas; desde ahi sigue como siempre aunque se vacie. Se reconoce porque
+ * vector es NULL (y largo 0).
+ */
+
+/*
+ * BUSQUEDA POR LOTES
+ * hash_obtener_lote y hash_pertenece_lote buscan de a LOTE claves. Primero
+ * las hashean todas y piden (memoria_anticipar) la posicion de cada una;
+ * despues, en pasadas separadas, la lista, su primer nodo y el nodo_hash_t.
+ * Cada pasada solo lee lo que pidio la anterior, asi las esperas a la memoria
+ * de las LOTE claves se superponen en vez de sumarse. Recien al final se
+ * busca cada clave como en hash_obtener. Durante una migracion o sin vector
+ * no se anticipa nada mas que la estructura del hash cerrado.
+ */
+
+/*
+ * CARGA POR LOTES
+ * hash_guardar_lote agranda el hash una sola vez para todos los pares (y no lo
+ * deja achicarse hasta terminar). Despues toma hasta TRAMO_CARGA pares, los
+ * hashea, los ordena por la posicion que les toca (radix sort, estable) y
+ * recien ahi los guarda. Asi el vector (o las ranuras) se recorre en orden en
+ * lugar de saltar al azar, y los nodos de una misma posicion salen seguidos
+ * de la reserva. Como el orden es estable, las claves repetidas se guardan en
+ * el orden recibido y queda la ultima.
+ */
+
+/*
+ * CARGA Y REDIMENSION EN PARALELO
+ * Con opciones.hilos mayor que 1, hash_guardar_lote reparte entre los hilos
+ * (ver hilos.h) hashear los pares, repartirlos en grupos por rangos de
+ * posicion (cada parte de los pares escribe en su lugar de cada grupo, asi se
+ * conserva el orden recibido) y ordenar cada grupo: el resultado es el mismo
+ * ordenamiento estable que en un solo hilo. Para guardarlos, cada hilo toma
+ * RANGOS_GUARDADO rangos de posiciones, que no se pisan: primero busca las
+ * claves de su rango y despues enlaza los nodos nuevos en sus listas (o
+ * coloca las ranuras nuevas en su rango). En el medio, en un solo hilo y en
+ * orden, se piden los nodos, las listas y las copias de las claves, porque
+ * las reservas, el allocator y el desborde son de todo el hash. El abierto
+ * queda identico al guardado de a uno. En el cerrado una ranura que se
+ * correria al rango siguiente se coloca al final, en orden, asi que los
+ * tramos grandes se guardan por rangos aunque no haya hilos: el resultado no
+ * depende de la cantidad de hilos.
+ * Al reubicar todo el vector, cada hilo separa los nodos de un rango del
+ * vector viejo en listas intermedias, una por rango del nuevo, y despues
+ * cada hilo reenlaza los de un rango del nuevo, con listas pedidas antes. Las
+ * ranuras del cerrado se reubican igual, por rangos (ver hash_cerrado.c).
+ * Con menos de MINIMO_PARALELO pares o nodos, o sin memoria para los
+ * arreglos auxiliares, se hace todo en un solo hilo.
+ */
+
 /* Standar documentation: GIGO. */
 
-/* Tipo de función para destruir dato */
-typedef void (*hash_destruir_dato_t)(void *);
+/* Trozo del desborde: hasta TROZO_DESBORDE nodos ordenados */
+typedef struct trozo {
+    size_t cantidad;
+    struct nodo_hash* nodos[TROZO_DESBORDE];
+} trozo_t;
+
+/* Nodos que no entraron en su lista. Cada trozo esta ordenado, ninguno esta
+ * vacio y todos sus nodos van antes que los del trozo siguiente.
+ */
+typedef struct desborde {
+    trozo_t** trozos;
+    size_t cantidad_trozos;
+    size_t capacidad_trozos;
+    size_t cantidad;                        /* Nodos en todos los trozos */
+} desborde_t;
 
 /* Estructura principal del Hash */
-typedef struct hash {
+struct hash {
     size_t tam;                             /* Cantidad de elementos en el vector */
     size_t largo;                           /* Cantidad memoria del vector */
     hash_destruir_dato_t destruir_dato;     /* Funcion para destruir los datos */
     void** vector;                          /* Arreglo (HashTable) para guardar las listas */
-    bool redimensionando;                   /* Evita que redimensione cuando esta en proceso de redimension */
-} hash_t ;
+    hash_tipo_t tipo;                       /* Motor de almacenamiento */
+    hash_cerrado_t cerrado;                 /* Ranuras, solo para los tipos HASH_CERRADO_* */
+    hash_funcion_t funcion;                 /* Funcion de hash de las claves */
+    hash_largo_t politica;                  /* Largos del vector y como se elige la posicion */
+    hash_opciones_t opciones;               /* Con las que se creo; incremental se puede cambiar */
+    void** vector_viejo;                    /* Vector que se esta migrando, o NULL */
+    size_t largo_viejo;                     /* Largo del vector viejo, 0 si no hay */
+    size_t migradas;                        /* Posiciones del vector viejo ya migradas */
+    uint64_t semilla;                       /* Semilla de la funcion de hash, al azar */
+    bool con_desborde;                      /* Las listas largas desbordan al arreglo ordenado */
+    desborde_t desborde;                    /* Nodos que no entraron en su lista */
+    bloques_t nodos;                        /* Reserva de nodo_hash_t */
+    bloques_t nodos_lista;                  /* Reserva de nodos de las listas */
+    bloques_t claves[CLASES_CLAVE];         /* Reservas de claves por clase de tamaño */
+    size_t claves_grandes;                  /* Bytes de claves pedidas afuera de las reservas */
+    const memoria_t* memoria;               /* &allocator, o NULL para usar malloc */
+    hilos_t* hilos;                         /* Si opciones.hilos > 1, se crea al usarlo */
+    memoria_t allocator;                    /* Copia del allocator recibido */
+    size_t largo_minimo;                    /* El vector no se achica por debajo (sin ajustar) */
+    struct nodo_hash* chicos[CANTIDAD_CHICA];   /* Nodos mientras no hay vector */
+    uint32_t codigos_chicos[CANTIDAD_CHICA];    /* Sus codigos, para no mirar los nodos */
+};
 
 /* Nodo para guardar en la Lista */
 typedef struct nodo_hash {
-    char* clave;
     void* dato;
+    uint32_t codigo;                        /* Hash completo de la clave, no se recalcula */
+    uint32_t largo;                         /* Largo de la clave sin el '\0', o LARGO_AFUERA */
+    union {
+        char corta[CLAVE_CORTA];            /* Si largo < CLAVE_CORTA */
+        struct {
+            char* copia;                    /* Si no, copia afuera del nodo */
+            size_t largo;                   /* Solo si el del nodo es LARGO_AFUERA */
+        } larga;
+    } clave;
 } nodo_hash_t;
 
-/* Iterador del hash */
-typedef struct hash_iter {
-    lista_t* actual;
-    lista_iter_t* lista_iter;
-    size_t posicion_actual;
-    size_t numero_lista_actual;
-    size_t items_recorridos;
-    const hash_t* hash;
-} hash_iter_t;
+/* Clave recibida del usuario con su largo y su codigo, que se calculan una
+ * sola vez por operacion.
+ */
+typedef struct clave_hash {
+    const char* clave;
+    size_t largo;
+    uint32_t codigo;
+} clave_hash_t;
+
+/* Iterador del hash: un hash_recorrido_t en memoria dinamica */
+struct hash_iter {
+    hash_recorrido_t recorrido;
+};
 
 /************* PROTOTIPOS *************/
 bool hash_redimensionar(hash_t* hash);
@@ -65,393 +245,2360 @@ void vector_limpiar(void* vector[], size_t largo) {
         vector[i] = NULL;
 }
 
-/* Algoritmo de Hash by Bob Jenkins.
- * Post: Devuelve un entero dentro del rango de 0 a largo-1.
- */
-size_t hashear(const char *key, size_t largo) {
-    if(strlen(key)==0) return 0;
-
-	unsigned int initval;
-    unsigned int hashAddress;
-    initval = 5381;
-    hashAddress = lookup3(key, strlen(key), initval);
-    return (hashAddress % largo);
-    //return (hashAddress & (largo-1)); SOLO PARA LARGOS DE 2^n
+/* Algoritmo de Hash by Bob Jenkins, para compatibilidad */
+uint64_t hash_funcion_lookup3(const void *clave, size_t largo, uint64_t semilla) {
+    return lookup3(clave, largo, (uint32_t) semilla);
 }
 
-/* Crea el Hash */
-hash_t *hash_crear(hash_destruir_dato_t destruir_dato) {
-    hash_t *hash = malloc(sizeof(hash_t));
-    if(!hash) return NULL;
-
-    hash->destruir_dato = destruir_dato;
-    hash->redimensionando = false;
-    hash->tam = 0;
-    hash->largo = LARGO_INICIAL;
-    hash->vector = malloc(sizeof(void*) * hash->largo);
-
-    if(!hash->vector)
-    {
-    	free(hash);
-    	return NULL;
-    }
+/* Hash de 64 bits estilo wyhash / XXH3 (ver hash_rapido.h) */
+uint64_t hash_funcion_rapida(const void *clave, size_t largo, uint64_t semilla) {
+    return hash_rapido(clave, largo, semilla);
+}
 
-    vector_limpiar(hash->vector, hash->largo);
+/* Arma la clave con su largo y un codigo ya calculado, plegando sus 64 bits
+ * a los 32 del codigo.
+ */
+static clave_hash_t clave_hasheada(const char *key, size_t largo, uint64_t codigo) {
+    clave_hash_t clave;
+    clave.clave = key;
+    clave.largo = largo;
+    clave.codigo = (uint32_t) (codigo ^ (codigo >> 32));
+    return clave;
+}
 
-    return hash;
+/* Aplica la funcion de hash del hash. El largo lo da quien llama, la clave no
+ * se recorre buscando el '\0'.
+ * Post: Devuelve la clave con su largo y su codigo completo.
+ */
+static clave_hash_t hashear(const hash_t *hash, const char *key, size_t largo) {
+    return clave_hasheada(key, largo, hash->funcion(key, largo, hash->semilla));
 }
 
-/* Copia la clave en memoria para evitar que el usuario la cambie */
-char* copiar_clave(const char *clave) {
-    char* clave_copiada = (char *) calloc(strlen(clave)+1, sizeof(char));
-    strcpy(clave_copiada, clave);
-    return clave_copiada;
+/* Codigo de la clave con la funcion y la semilla del hash */
+uint64_t hash_codigo(const hash_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return 0;
+    return hash->funcion(clave, largo, hash->semilla);
 }
 
-/* Destruir el iterador una vez usado.
- * WARN: Si puntero_lista != NULL se crea una lista nueva cuando no existe.
+/* Finalizador de MurmurHash3: mezcla los bits del codigo para que los bajos,
+ * que son los unicos que mira la mascara, dependan de todos.
  */
-lista_iter_t* obtener_iterador_lista_por_clave(const hash_t *hash, const char *clave, lista_t** puntero_lista ) {
-    if(!hash || !clave) return NULL;
-
-    size_t clave_hasheada = hashear(clave, hash->largo);
+static uint32_t mezclar(uint32_t codigo) {
+    codigo ^= codigo >> 16;
+    codigo *= 0x85ebca6bu;
+    codigo ^= codigo >> 13;
+    codigo *= 0xc2b2ae35u;
+    codigo ^= codigo >> 16;
+    return codigo;
+}
 
-    lista_t* lista = hash->vector[clave_hasheada];
-    if(!lista)
-    {
-        if(puntero_lista)
-        {
-            hash->vector[clave_hasheada] = lista_crear();
-            *puntero_lista = hash->vector[clave_hasheada];
-        }
-        return NULL;
-    }
+/* Devuelve la posicion del vector que le corresponde a un codigo,
+ * un entero dentro del rango de 0 a largo-1, segun la politica del hash.
+ */
+static size_t posicion_en_vector(const hash_t *hash, uint32_t codigo, size_t largo) {
+    if(hash->politica == HASH_LARGO_POTENCIA_DE_2)
+        return mezclar(codigo) & (largo - 1);
+    if(hash->politica == HASH_LARGO_MULTIPLICATIVO)
+        return (size_t)(((uint64_t)codigo * largo) >> 32);
+    return codigo % largo;
+}
 
-    lista_iter_t* lista_iter = lista_iter_crear(lista);
-    if(!lista_iter) return NULL;
+/* Ajusta un largo de vector a la politica del hash: con HASH_LARGO_POTENCIA_DE_2
+ * lo redondea hacia arriba a potencia de 2.
+ */
+static size_t ajustar_largo(const hash_t *hash, size_t largo) {
+    if(hash->politica != HASH_LARGO_POTENCIA_DE_2) return largo;
 
-    if(puntero_lista) *puntero_lista = lista;
+    size_t potencia = 1;
+    while(potencia < largo) potencia <<= 1;
+    return potencia;
+}
 
-    while(!lista_iter_al_final(lista_iter) && strcmp(clave, ((nodo_hash_t*) lista_iter_ver_actual(lista_iter))->clave) != 0 )
-        lista_iter_avanzar(lista_iter);
+/* Devuelve si el hash usa el motor de direccionamiento abierto */
+static bool es_cerrado(const hash_t *hash) {
+    return hash->tipo != HASH_ABIERTO;
+}
 
-    return lista_iter;
+/* Crea el Hash */
+hash_t *hash_crear(hash_destruir_dato_t destruir_dato) {
+    return hash_crear_tipo(destruir_dato, HASH_ABIERTO);
 }
 
-/* Determina si clave pertenece o no al hash.
- * Pre: La estructura hash fue inicializada
- */
-bool hash_pertenece(const hash_t *hash, const char *clave) {
-    lista_iter_t* lista_iter = obtener_iterador_lista_por_clave(hash, clave, NULL);
-    bool pertenece = (lista_iter && !lista_iter_al_final(lista_iter));
-    lista_iter_destruir(lista_iter);
-    return pertenece;
+/* Crea el Hash con el motor de almacenamiento indicado */
+hash_t *hash_crear_tipo(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo) {
+    hash_opciones_t opciones;
+    hash_opciones_por_defecto(&opciones);
+    opciones.tipo = tipo;
+    return hash_crear_con_opciones(destruir_dato, &opciones);
 }
 
-// TODO: Documentar.
-nodo_hash_t* crear_nodo(const char *clave, void* dato) {
-    if(!clave) return NULL;
+/* Crea el Hash con lugar para capacidad claves */
+hash_t *hash_crear_con_capacidad(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, size_t capacidad) {
+    hash_opciones_t opciones;
+    hash_opciones_por_defecto(&opciones);
+    opciones.tipo = tipo;
+    opciones.capacidad = capacidad;
+    return hash_crear_con_opciones(destruir_dato, &opciones);
+}
 
-    nodo_hash_t* nodo = malloc(sizeof(nodo_hash_t));
-    if(!nodo) return NULL;
+/* Crea el Hash pidiendo toda su memoria al allocator */
+hash_t *hash_crear_con_allocator(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, const hash_allocator_t *allocator) {
+    hash_opciones_t opciones;
+    hash_opciones_por_defecto(&opciones);
+    opciones.tipo = tipo;
+    opciones.allocator = allocator;
+    return hash_crear_con_opciones(destruir_dato, &opciones);
+}
 
-    char* clave_copiada = copiar_clave(clave);
-    nodo->clave = clave_copiada;
-    nodo->dato = dato;
-    return nodo;
+/* Completa las opciones por defecto */
+void hash_opciones_por_defecto(hash_opciones_t *opciones) {
+    if(!opciones) return;
+    opciones->tipo = HASH_ABIERTO;
+    opciones->capacidad = 0;
+    opciones->allocator = NULL;
+    opciones->incremental = false;
+    opciones->factor_carga_maximo = FACTOR_CARGA_MAXIMO;
+    opciones->factor_carga_minimo = FACTOR_CARGA_MINIMO;
+    opciones->crecimiento = CRECIMIENTO;
+    opciones->largo_minimo = LARGO_INICIAL;
+    opciones->achicar = true;
+    opciones->hilos = 1;
 }
 
-/* Guarda un elemento en el hash, si la clave ya se encuentra en la
- * estructura, la reemplaza. De no poder guardarlo devuelve false.
- * Pre: La estructura hash fue inicializada
- * Post: Se almacenó el par (clave, dato)
- IMPORTANTE: (a) COPIAR CLAVE (para que no te la modifique el usuario) (b) Destruir dato si hay que actualizar
- */
-bool hash_guardar(hash_t *hash, const char *clave, void *dato) {
-    if(!hash || !clave || !hash_redimensionar(hash)) return false;
+/* Devuelve si las opciones cumplen lo que pide hash_opciones_t */
+static bool opciones_validas(const hash_opciones_t *opciones) {
+    const hash_allocator_t* allocator = opciones->allocator;
+    if(allocator && (!allocator->pedir || !allocator->liberar)) return false;
 
-    lista_t* lista = NULL;
-    lista_iter_t* lista_iter = obtener_iterador_lista_por_clave(hash, clave, &lista);
-    bool pertenece = (lista_iter && !lista_iter_al_final(lista_iter));
+    return opciones->factor_carga_maximo > 0 && opciones->crecimiento > 1
+        && opciones->factor_carga_minimo >= 0
+        && opciones->factor_carga_minimo < opciones->factor_carga_maximo / opciones->crecimiento
+        && opciones->largo_minimo > 0 && opciones->hilos > 0;
+}
 
-    if(pertenece)
+/* Crea el Hash con las opciones recibidas */
+hash_t *hash_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones) {
+    hash_opciones_t por_defecto;
+    if(!opciones)
     {
-        nodo_hash_t* nodo = lista_iter_ver_actual(lista_iter);
-        if(hash->destruir_dato) hash->destruir_dato(nodo->dato);
-        nodo->dato = dato;
-        lista_iter_destruir(lista_iter);
-        return true;
+        hash_opciones_por_defecto(&por_defecto);
+        opciones = &por_defecto;
     }
-    lista_iter_destruir(lista_iter);
+    if(!opciones_validas(opciones)) return NULL;
 
-    nodo_hash_t* nodo = crear_nodo(clave, dato);
-    if(!nodo) return false;
+    const hash_allocator_t* allocator = opciones->allocator;
+    hash_t *hash = memoria_pedir(allocator, sizeof(hash_t));
+    if(!hash) return NULL;
 
-    bool insertado = lista_insertar_ultimo(lista, nodo);
-    if(!insertado)
+    hash->opciones = *opciones;
+    hash->memoria = NULL;
+    if(allocator)
     {
-        free(nodo->clave);
-        free(nodo);
-        return false;
+        hash->allocator = *allocator;
+        hash->memoria = &hash->allocator;
     }
+    hash->opciones.allocator = hash->memoria;
+    hash_tipo_t tipo = opciones->tipo;
 
-    hash->tam++;
-    return insertado;
+    hash->destruir_dato = destruir_dato;
+    hash->tam = 0;
+    hash->tipo = tipo;
+    hash->funcion = hash_funcion_rapida;
+    hash->politica = HASH_LARGO_MODULO;
+    hash->vector_viejo = NULL;
+    hash->largo_viejo = 0;
+    hash->migradas = 0;
+    hash->largo_minimo = opciones->largo_minimo;
+    hash->semilla = hash_rapido_semilla(hash);
+    hash->con_desborde = true;
+    hash->desborde.trozos = NULL;
+    hash->desborde.cantidad_trozos = 0;
+    hash->desborde.capacidad_trozos = 0;
+    hash->desborde.cantidad = 0;
+    hash->claves_grandes = 0;
+    hash->hilos = NULL;
+    bloques_inicializar(&hash->nodos, sizeof(nodo_hash_t), hash->memoria);
+    bloques_inicializar(&hash->nodos_lista, lista_tam_nodo(), hash->memoria);
+    for(size_t i = 0; i < CLASES_CLAVE; i++)
+        bloques_inicializar(&hash->claves[i], (size_t) CLAVE_MINIMA << i, hash->memoria);
+
+    if(es_cerrado(hash))
+    {
+        hash->largo = 0;
+        hash->vector = NULL;
+        sondeo_t sondeo = SONDEO_LINEAL;
+        if(tipo == HASH_CERRADO_ROBIN_HOOD) sondeo = SONDEO_ROBIN_HOOD;
+        if(tipo == HASH_CERRADO_GRUPOS) sondeo = SONDEO_GRUPOS;
+        if(!hash_cerrado_inicializar(&hash->cerrado, sondeo, hash->memoria))
+        {
+            memoria_liberar(hash->memoria, hash);
+            return NULL;
+        }
+        hash->cerrado.achicar = opciones->achicar;
+        // Las ranuras crecen solas en cualquier insercion: los hilos se crean
+        // ya (si no se puede, redimensiona en uno).
+        if(opciones->hilos > 1) hash->hilos = hilos_crear(opciones->hilos);
+        hash->cerrado.hilos = hash->hilos;
+    }
+    else
+    {
+        // El vector se pide recien cuando no alcanza el arreglo de chicos.
+        hash->largo = 0;
+        hash->vector = NULL;
+    }
 
+    if(opciones->capacidad && !hash_reservar(hash, opciones->capacidad))
+    {
+        hash_destruir(hash);
+        return NULL;
+    }
+    return hash;
 }
 
-/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
- * NULL si el dato no estaba.
- * Pre: La estructura hash fue inicializada
- * Post: El elemento fue borrado de la estructura y se lo devolvió,
- * en el caso de que estuviera guardado.
- IMPORTANTE: DSTRUIR DATO SI NO ES NULL
+/* Devuelve la clase de tamaño para una clave de 'largo' bytes (sin el '\0'),
+ * o CLASES_CLAVE si no entra en ninguna.
  */
-void* hash_borrar(hash_t *hash, const char *clave) {
-    if(!hash || !clave || !hash_redimensionar(hash)) return NULL;
-
-    lista_t* lista = NULL;
-    lista_iter_t* lista_iter = obtener_iterador_lista_por_clave(hash, clave, &lista);
-    bool pertenece = (lista_iter && !lista_iter_al_final(lista_iter));
+static size_t clase_clave(size_t largo) {
+    size_t clase = 0;
+    while(clase < CLASES_CLAVE && ((size_t) CLAVE_MINIMA << clase) < largo + 1)
+        clase++;
+    return clase;
+}
 
-    if(!pertenece)
+/* Pide memoria para una clave de 'largo' bytes mas el '\0'. El hash cerrado
+ * libera sus claves por su cuenta, asi que no usa las reservas.
+ */
+static char* pedir_clave(hash_t *hash, size_t largo) {
+    size_t clase = clase_clave(largo);
+    if(es_cerrado(hash) || clase == CLASES_CLAVE)
     {
-        if(lista) lista_destruir(lista, NULL);
-        hash->vector[hashear(clave, hash->largo)] = NULL;   // TODO: No me gusta, pero es necesario dejarlo en NULL.
-        lista_iter_destruir(lista_iter);
-        return NULL;
+        char* clave = memoria_pedir(hash->memoria, largo + 1);
+        if(clave && !es_cerrado(hash)) hash->claves_grandes += largo + 1;
+        return clave;
     }
+    return bloques_pedir(&hash->claves[clase]);
+}
 
-    nodo_hash_t* nodo = lista_borrar(lista, lista_iter);
-    lista_iter_destruir(lista_iter);
-
-    if(!nodo) return NULL;
-
-    void* dato = nodo->dato;
-
-    free(nodo->clave);
-    free(nodo);
-
-    if(lista_esta_vacia(lista))
+/* Libera una clave pedida con pedir_clave */
+static void liberar_clave(hash_t *hash, char *clave, size_t largo) {
+    size_t clase = clase_clave(largo);
+    if(es_cerrado(hash) || clase == CLASES_CLAVE)
     {
-        lista_destruir(lista, NULL);
-        hash->vector[hashear(clave, hash->largo)] = NULL;    // TODO: No me gusta, pero es necesario dejarlo en NULL.
+        if(!es_cerrado(hash)) hash->claves_grandes -= largo + 1;
+        memoria_liberar(hash->memoria, clave);
+        return;
     }
+    bloques_devolver(&hash->claves[clase], clave);
+}
 
-    hash->tam--;
+/* Copia la clave en memoria para evitar que el usuario la cambie. La copia
+ * siempre termina en '\0', aunque la original no.
+ */
+static char* copiar_clave(hash_t *hash, const clave_hash_t *clave) {
+    char* clave_copiada = pedir_clave(hash, clave->largo);
+    if(!clave_copiada) return NULL;
+    memcpy(clave_copiada, clave->clave, clave->largo);
+    clave_copiada[clave->largo] = '\0';
+    return clave_copiada;
+}
 
-    return dato;
+/* Devuelve la copia de la clave del nodo, este adentro o afuera */
+static const char* clave_de_nodo(const nodo_hash_t *nodo) {
+    return nodo->largo < CLAVE_CORTA ? nodo->clave.corta : nodo->clave.larga.copia;
 }
 
-/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
- * devuelve NULL.
- * Pre: La estructura hash fue inicializada
- */
-void* hash_obtener(const hash_t *hash, const char *clave) {
-    lista_iter_t* lista_iter = obtener_iterador_lista_por_clave(hash, clave, NULL);
-    bool pertenece = (lista_iter && !lista_iter_al_final(lista_iter));
-    void* dato = pertenece ? ((nodo_hash_t*)lista_iter_ver_actual(lista_iter))->dato : NULL;
-    lista_iter_destruir(lista_iter);
-    return dato;
+/* Devuelve el largo de la clave del nodo */
+static size_t largo_de_nodo(const nodo_hash_t *nodo) {
+    return nodo->largo != LARGO_AFUERA ? nodo->largo : nodo->clave.larga.largo;
 }
 
-/* Devuelve la cantidad de elementos del hash.
- * Pre: La estructura hash fue inicializada
+/* Criterio para lista_buscar: el nodo tiene la clave_hash_t recibida en extra.
+ * Solo compara los bytes si coinciden el codigo y el largo.
  */
-size_t hash_cantidad(const hash_t *hash) {
-	return hash ? hash->tam : 0;
+static bool es_clave_buscada(const void *dato, const void *extra) {
+    const nodo_hash_t* nodo = dato;
+    const clave_hash_t* clave = extra;
+    return nodo->codigo == clave->codigo && largo_de_nodo(nodo) == clave->largo && memcmp(clave_de_nodo(nodo), clave->clave, clave->largo) == 0;
 }
 
-/* Destruye la estructura liberando la memoria pedida y llamando a la función
- * destruir para cada par (clave, dato).
- * Pre: La estructura hash fue inicializada
- * Post: La estructura hash fue destruida
+/* Compara un nodo con una clave por codigo, largo y bytes, en ese orden */
+static int comparar_clave(const nodo_hash_t *nodo, const clave_hash_t *clave) {
+    if(nodo->codigo != clave->codigo) return nodo->codigo < clave->codigo ? -1 : 1;
+    size_t largo = largo_de_nodo(nodo);
+    if(largo != clave->largo) return largo < clave->largo ? -1 : 1;
+    return memcmp(clave_de_nodo(nodo), clave->clave, clave->largo);
+}
+
+/* Devuelve el trozo donde esta o iria la clave: el primero cuyo ultimo
+ * nodo no es menor que ella, o el ultimo si no hay ninguno.
+ * Pre: El desborde tiene trozos.
  */
-void hash_destruir(hash_t *hash) {
-    if(!hash) return;
+static size_t desborde_trozo(const desborde_t *desborde, const clave_hash_t *clave) {
+    size_t desde = 0, hasta = desborde->cantidad_trozos - 1;
 
-    for(size_t i=0;i<hash->largo;i++)
+    while(desde < hasta)
     {
-        lista_t* lista = hash->vector[i];
-        if(!lista) continue;
+        size_t medio = desde + (hasta - desde) / 2;
+        const trozo_t* trozo = desborde->trozos[medio];
+        if(comparar_clave(trozo->nodos[trozo->cantidad - 1], clave) < 0) desde = medio + 1;
+        else hasta = medio;
+    }
+    return desde;
+}
 
-        while(!lista_esta_vacia(lista))
-        {
-            nodo_hash_t* nodo = lista_borrar_primero(lista);
-            if(hash->destruir_dato != NULL)
-                hash->destruir_dato(nodo->dato);
+/* Busqueda binaria en un trozo del desborde.
+ * Post: Devuelve el indice de la clave, o donde habria que insertarla si no
+ * esta; encontrada indica cual de los dos.
+ */
+static size_t trozo_indice(const trozo_t *trozo, const clave_hash_t *clave, bool *encontrada) {
+    size_t desde = 0, hasta = trozo->cantidad;
+    *encontrada = false;
 
-            free(nodo->clave);
-            free(nodo);
+    while(desde < hasta)
+    {
+        size_t medio = desde + (hasta - desde) / 2;
+        int comparacion = comparar_clave(trozo->nodos[medio], clave);
+        if(comparacion == 0)
+        {
+            *encontrada = true;
+            return medio;
         }
-        free(lista);
+        if(comparacion < 0) desde = medio + 1;
+        else hasta = medio;
     }
-    free(hash->vector);
-    free(hash);
+    return desde;
 }
 
-/* Iterador del hash */
+/* Devuelve el nodo del desborde con la clave, o NULL si no esta */
+static nodo_hash_t* desborde_buscar(const desborde_t *desborde, const clave_hash_t *clave) {
+    if(!desborde->cantidad) return NULL;
 
-/* Itera el vector del Hash desde la posicion actual del iterador hasta la proxima posicion != NULL */
-bool buscar_proxima_lista(hash_iter_t *hash_iter) {
-    hash_iter->actual = hash_iter->hash->vector[hash_iter->posicion_actual];
+    const trozo_t* trozo = desborde->trozos[desborde_trozo(desborde, clave)];
+    bool encontrada;
+    size_t indice = trozo_indice(trozo, clave, &encontrada);
+    return encontrada ? trozo->nodos[indice] : NULL;
+}
 
-    while(!hash_iter->actual && hash_iter->posicion_actual < hash_iter->hash->largo-1)
-        hash_iter->actual = hash_iter->hash->vector[++hash_iter->posicion_actual];
+/* Agrega un trozo vacio en la posicion indice de los trozos.
+ * Post: Devuelve el trozo, o NULL si no hubo memoria (y no cambia nada).
+ */
+static trozo_t* desborde_agregar_trozo(desborde_t *desborde, size_t indice, const memoria_t *memoria) {
+    if(desborde->cantidad_trozos == desborde->capacidad_trozos)
+    {
+        size_t capacidad = desborde->capacidad_trozos ? desborde->capacidad_trozos * 2 : 4;
+        trozo_t** trozos = memoria_redimensionar(memoria, desborde->trozos,
+            sizeof(trozo_t*) * desborde->capacidad_trozos, sizeof(trozo_t*) * capacidad);
+        if(!trozos) return NULL;
+        desborde->trozos = trozos;
+        desborde->capacidad_trozos = capacidad;
+    }
 
-    if(!hash_iter->actual || hash_iter->posicion_actual == hash_iter->hash->largo)
-        return false;
-    return true;
-}
+    trozo_t* trozo = memoria_pedir(memoria, sizeof(trozo_t));
+    if(!trozo) return NULL;
+    trozo->cantidad = 0;
 
-/* Crea un iterador del Hash */
-hash_iter_t *hash_iter_crear(const hash_t *hash) {
-    if(!hash) return NULL;
+    memmove(&desborde->trozos[indice + 1], &desborde->trozos[indice], sizeof(trozo_t*) * (desborde->cantidad_trozos - indice));
+    desborde->trozos[indice] = trozo;
+    desborde->cantidad_trozos++;
+    return trozo;
+}
 
-	hash_iter_t *hash_iter = malloc(sizeof(hash_iter_t));
-	hash_iter->posicion_actual = 0;
-	hash_iter->actual = NULL;
-	hash_iter->hash = hash;
-	hash_iter->numero_lista_actual = 1;
-    hash_iter->items_recorridos = 1;
+/* Saca del desborde el trozo en la posicion indice y lo libera */
+static void desborde_sacar_trozo(desborde_t *desborde, size_t indice, const memoria_t *memoria) {
+    memoria_liberar(memoria, desborde->trozos[indice]);
+    desborde->cantidad_trozos--;
+    memmove(&desborde->trozos[indice], &desborde->trozos[indice + 1], sizeof(trozo_t*) * (desborde->cantidad_trozos - indice));
+}
 
-    if(!hash_iter) return NULL;
+/* Inserta en el desborde un nodo cuya clave no esta. Si el trozo que le toca
+ * esta lleno, la mitad de arriba pasa a un trozo nuevo a continuacion.
+ * Post: Devuelve false si no hubo memoria (y no cambia nada).
+ */
+static bool desborde_insertar(desborde_t *desborde, nodo_hash_t *nodo, const memoria_t *memoria) {
+    clave_hash_t clave = { clave_de_nodo(nodo), largo_de_nodo(nodo), nodo->codigo };
+    trozo_t* trozo;
+    size_t indice = 0;
 
-    if(hash_cantidad(hash) != 0)
+    if(!desborde->cantidad_trozos)
     {
-        if(!buscar_proxima_lista(hash_iter)) return NULL;
-
-        hash_iter->lista_iter = lista_iter_crear(hash_iter->actual);
+        if(!(trozo = desborde_agregar_trozo(desborde, 0, memoria))) return false;
+    }
+    else
+    {
+        size_t numero = desborde_trozo(desborde, &clave);
+        bool encontrada;
+        trozo = desborde->trozos[numero];
+        indice = trozo_indice(trozo, &clave, &encontrada);
 
-        if(!hash_iter->lista_iter)
+        if(trozo->cantidad == TROZO_DESBORDE)
         {
-            free(hash_iter);
-            return NULL;
+            trozo_t* arriba = desborde_agregar_trozo(desborde, numero + 1, memoria);
+            if(!arriba) return false;
+
+            size_t mitad = TROZO_DESBORDE / 2;
+            memcpy(arriba->nodos, trozo->nodos + mitad, sizeof(nodo_hash_t*) * (TROZO_DESBORDE - mitad));
+            arriba->cantidad = TROZO_DESBORDE - mitad;
+            trozo->cantidad = mitad;
+            if(indice > mitad)
+            {
+                trozo = arriba;
+                indice -= mitad;
+            }
         }
     }
-    else
-        hash_iter->lista_iter = NULL;
 
-    return hash_iter;
+    memmove(&trozo->nodos[indice + 1], &trozo->nodos[indice], sizeof(nodo_hash_t*) * (trozo->cantidad - indice));
+    trozo->nodos[indice] = nodo;
+    trozo->cantidad++;
+    desborde->cantidad++;
+    return true;
 }
 
-/* Comprueba si terminó la iteración */
-bool hash_iter_al_final(const hash_iter_t *hash_iter) {
-    if(!hash_iter) return NULL;
-    return hash_iter->items_recorridos > hash_iter->hash->tam;
+/* Saca del desborde el nodo con la clave y lo devuelve, o NULL si no esta.
+ * Un trozo que queda vacio se libera, y uno que queda con pocos nodos se
+ * junta con el siguiente si entran los dos en medio trozo.
+ */
+static nodo_hash_t* desborde_quitar(desborde_t *desborde, const clave_hash_t *clave, const memoria_t *memoria) {
+    if(!desborde->cantidad) return NULL;
+
+    size_t numero = desborde_trozo(desborde, clave);
+    trozo_t* trozo = desborde->trozos[numero];
+    bool encontrada;
+    size_t indice = trozo_indice(trozo, clave, &encontrada);
+    if(!encontrada) return NULL;
+
+    nodo_hash_t* nodo = trozo->nodos[indice];
+    trozo->cantidad--;
+    memmove(&trozo->nodos[indice], &trozo->nodos[indice + 1], sizeof(nodo_hash_t*) * (trozo->cantidad - indice));
+    desborde->cantidad--;
+
+    if(!trozo->cantidad)
+        desborde_sacar_trozo(desborde, numero, memoria);
+    else if(numero + 1 < desborde->cantidad_trozos
+        && trozo->cantidad + desborde->trozos[numero + 1]->cantidad <= TROZO_DESBORDE / 2)
+    {
+        trozo_t* siguiente = desborde->trozos[numero + 1];
+        memcpy(trozo->nodos + trozo->cantidad, siguiente->nodos, sizeof(nodo_hash_t*) * siguiente->cantidad);
+        trozo->cantidad += siguiente->cantidad;
+        desborde_sacar_trozo(desborde, numero + 1, memoria);
+    }
+    return nodo;
 }
 
-/* Avanza el iterador a la proxima posicion valida de ser posible */
-bool hash_iter_avanzar(hash_iter_t *hash_iter) {
-    if(!hash_iter) return false;
-
-    // Iterador al final del hash, nada mas para iterar.
-    if(hash_iter_al_final(hash_iter)) return false;
-
-    // 1 - No hay iterador de lista, SOLO SI EL HASH NO TIENE ELEMENTOS.
-    if(!hash_iter->lista_iter) return false;
+/* Devuelve el nodo del desborde en la posicion de un recorrido, que se
+ * guarda como numero de trozo * TROZO_DESBORDE + indice en el trozo.
+ */
+static nodo_hash_t* desborde_nodo(const desborde_t *desborde, size_t posicion) {
+    return desborde->trozos[posicion / TROZO_DESBORDE]->nodos[posicion % TROZO_DESBORDE];
+}
 
-    // Todas las acciones de aca en delante, incrementan en uno los items recorridos.
-    hash_iter->items_recorridos++;
+/* Devuelve la posicion de recorrido que sigue a la dada en el desborde */
+static size_t desborde_siguiente(const desborde_t *desborde, size_t posicion) {
+    size_t numero = posicion / TROZO_DESBORDE;
+    if(posicion % TROZO_DESBORDE + 1 < desborde->trozos[numero]->cantidad) return posicion + 1;
+    return (numero + 1) * TROZO_DESBORDE;
+}
 
-    // 2 - Iterador avanza en la lista, pero no esta al final
-    if(lista_iter_avanzar(hash_iter->lista_iter) && !lista_iter_al_final(hash_iter->lista_iter))
-        return true;
+/* Devuelve la posicion del vector viejo donde todavia puede estar el codigo,
+ * o largo_viejo si no hay migracion o esa posicion ya se migro.
+ */
+static size_t posicion_vieja(const hash_t *hash, uint32_t codigo) {
+    if(!hash->vector_viejo) return hash->largo_viejo;
+    size_t posicion = posicion_en_vector(hash, codigo, hash->largo_viejo);
+    return posicion < hash->migradas ? hash->largo_viejo : posicion;
+}
 
-    // 3 - Se termino la lista que estaba iterando, buscar la proxima de ser posible.
-    hash_iter->posicion_actual = hash_iter->posicion_actual + 1;
+/* Devuelve el indice de la clave en el arreglo de chicos, o tam si no esta */
+static size_t buscar_chico(const hash_t *hash, const clave_hash_t *clave) {
+    for(size_t i = 0; i < hash->tam; i++)
+        if(hash->codigos_chicos[i] == clave->codigo && es_clave_buscada(hash->chicos[i], clave))
+            return i;
+    return hash->tam;
+}
 
-    if(!buscar_proxima_lista(hash_iter))
-        return false; // No existe otra lista para iterar.
+/* Busca el nodo con la clave recorriendo la lista de su posicion, sin pedir
+ * memoria. Durante una migracion tambien mira el vector viejo.
+ * Devuelve NULL si la clave no esta.
+ */
+static nodo_hash_t* buscar_nodo(const hash_t *hash, const clave_hash_t *clave) {
+    if(!hash->vector)
+    {
+        size_t indice = buscar_chico(hash, clave);
+        return indice < hash->tam ? hash->chicos[indice] : NULL;
+    }
 
-    // Si se encontro otra lista, destruir el iterador actual y crear uno nuevo.
-    lista_iter_destruir(hash_iter->lista_iter);
-    hash_iter->lista_iter = lista_iter_crear(hash_iter->actual);
-    hash_iter->numero_lista_actual++;
+    size_t vieja = posicion_vieja(hash, clave->codigo);
+    if(vieja < hash->largo_viejo && hash->vector_viejo[vieja])
+    {
+        nodo_hash_t* nodo = lista_buscar(hash->vector_viejo[vieja], es_clave_buscada, clave);
+        if(nodo) return nodo;
+    }
 
-    return true;
+    lista_t* lista = hash->vector[posicion_en_vector(hash, clave->codigo, hash->largo)];
+    nodo_hash_t* nodo = lista ? lista_buscar(lista, es_clave_buscada, clave) : NULL;
+    return nodo ? nodo : desborde_buscar(&hash->desborde, clave);
 }
 
-/* Devuelve clave actual, esa clave no se puede modificar ni liberada */
-const char *hash_iter_ver_actual(const hash_iter_t *hash_iter) {
-    if(!hash_iter || hash_iter_al_final(hash_iter))
-        return NULL;
+/* Busca la ranura con la clave en el hash cerrado */
+static ranura_t* buscar_ranura(const hash_t *hash, const clave_hash_t *clave) {
+    return hash_cerrado_buscar(&hash->cerrado, clave->clave, clave->largo, clave->codigo);
+}
 
-    const nodo_hash_t* nodo = lista_iter_ver_actual(hash_iter->lista_iter);
-    if(!nodo) return NULL;
-    return nodo->clave;
+/* Determina si clave pertenece o no al hash.
+ * Pre: La estructura hash fue inicializada
+ */
+bool hash_pertenece(const hash_t *hash, const char *clave) {
+    if(!clave) return false;
+    return hash_pertenece_n(hash, clave, strlen(clave));
 }
 
-/* Destruye iterador */
-void hash_iter_destruir(hash_iter_t* hash_iter) {
-    if(!hash_iter) return;
-    lista_iter_destruir(hash_iter->lista_iter);
-    free(hash_iter);
+/* hash_pertenece con el largo de la clave */
+bool hash_pertenece_n(const hash_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return false;
+    return hash_pertenece_hasheada(hash, clave, largo, hash_codigo(hash, clave, largo));
 }
 
-/* Ajustar memoria necesaria para el vector del Hash */
-bool hash_redimensionar(hash_t* hash) {
+/* hash_pertenece con el codigo de la clave ya calculado */
+bool hash_pertenece_hasheada(const hash_t *hash, const char *clave, size_t largo, uint64_t codigo) {
+    if(!hash || !clave) return false;
 
-    // Esta variable evita la redimension cuando se estan guardando los nuevos elementos mientras se redimensiona
-    if(hash->redimensionando) return true;
+    clave_hash_t buscada = clave_hasheada(clave, largo, codigo);
+    if(es_cerrado(hash))
+        return buscar_ranura(hash, &buscada) != NULL;
 
-    size_t nuevo_largo = NULL;
-    double factor_carga = (double)hash->tam / (double)hash->largo;
+    return buscar_nodo(hash, &buscada) != NULL;
+}
 
-    if(factor_carga >= FACTOR_CARGA_MAXIMO)
-        nuevo_largo = hash->tam + (size_t) ( (double)hash->tam * AUMENTO_LIBRE );
+/* Crea el nodo con una copia de la clave, guardando su largo y su codigo */
+static nodo_hash_t* crear_nodo(hash_t *hash, const clave_hash_t *clave, void* dato) {
+    nodo_hash_t* nodo = bloques_pedir(&hash->nodos);
+    if(!nodo) return NULL;
 
-    else if(factor_carga < FACTOR_CARGA_MINIMO && hash->largo > LARGO_INICIAL)
-        nuevo_largo = hash->tam - (size_t) ( (double)hash->tam * REDUCCION_LIBRE );
+    if(clave->largo < CLAVE_CORTA)
+    {
+        memcpy(nodo->clave.corta, clave->clave, clave->largo);
+        nodo->clave.corta[clave->largo] = '\0';
+    }
+    else if(!(nodo->clave.larga.copia = copiar_clave(hash, clave)))
+    {
+        bloques_devolver(&hash->nodos, nodo);
+        return NULL;
+    }
+    nodo->largo = clave->largo < LARGO_AFUERA ? (uint32_t) clave->largo : LARGO_AFUERA;
+    if(nodo->largo == LARGO_AFUERA) nodo->clave.larga.largo = clave->largo;
+    nodo->codigo = clave->codigo;
+    nodo->dato = dato;
+    return nodo;
+}
 
-    if(!nuevo_largo) return true;
+/* Devuelve a las reservas del hash la clave y el nodo */
+static void liberar_nodo(hash_t *hash, nodo_hash_t *nodo) {
+    if(nodo->largo >= CLAVE_CORTA) liberar_clave(hash, nodo->clave.larga.copia, largo_de_nodo(nodo));
+    bloques_devolver(&hash->nodos, nodo);
+}
 
-    void* nuevo_vector = malloc(sizeof(void*) * nuevo_largo);
+/* Crea una lista vacia que usa la reserva de nodos del hash */
+static lista_t* crear_lista(hash_t *hash) {
+    return lista_crear_con_bloques(&hash->nodos_lista);
+}
 
-    if (!nuevo_vector)
-        return false;
+/* Pide el vector y pasa los nodos del arreglo de chicos a sus listas.
+ * Post: Si no hay memoria devuelve false y los nodos siguen en el arreglo.
+ */
+static bool pasar_a_vector(hash_t *hash) {
+    size_t largo = ajustar_largo(hash, hash->largo_minimo);
+    void** vector = memoria_pedir_ceros(hash->memoria, largo, sizeof(void*));
+    if(!vector) return false;
 
-    vector_limpiar(nuevo_vector, nuevo_largo);
+    bool pasados = true;
+    for(size_t i = 0; i < hash->tam && pasados; i++)
+    {
+        size_t posicion = posicion_en_vector(hash, hash->codigos_chicos[i], largo);
+        if(!vector[posicion]) vector[posicion] = crear_lista(hash);
+        pasados = vector[posicion] && lista_insertar_ultimo(vector[posicion], hash->chicos[i]);
+    }
 
-    // Idea (1) de como redimensionar un Hash
-    // Recorrer el VECTOR ACTUAL del HASH
-    // Si la POSICION es != NLL pedir CLAVE del PRIMER dato de la LISTA (Del primer, segundo, o ultimo; total la funcion hashear aplicado a cualquiera deberia ser el mismo resultado)
-    // Hashear esa CLAVE para ver la nueva POSICION dentro del VECTOR NUEVO
-    // Colorcar el puntero a esa LISTA en la POSICION correspondiente en VECTOR NUEVO
-    // Repetir VECTOR ACTUAL LARGO veces
-    // Apuntar el VECTOR ACTUAL del HASH al VECTOR NUEVO
+    if(!pasados)
+    {
+        // Las listas solo tienen punteros a los nodos, que siguen en el arreglo.
+        for(size_t i = 0; i < largo; i++)
+            if(vector[i]) lista_destruir(vector[i], NULL);
+        memoria_liberar(hash->memoria, vector);
+        return false;
+    }
 
-    lista_t* lista = lista_crear();
+    hash->vector = vector;
+    hash->largo = largo;
+    return true;
+}
 
-    for(int i = 0; i<hash->largo; i++){
-        if(hash->vector[i] != NULL){
-            lista_insertar_ultimo(lista,hash->vector[i]);
-        }
+/* Inserta un nodo ya creado al final de la lista de su posicion, usando el
+ * codigo guardado. Crea la lista si no existe. Si la lista ya esta llena y
+ * el desborde esta activado, lo inserta en el desborde. Sin vector lo agrega
+ * al arreglo de chicos, o pide el vector si ya esta lleno.
+ */
+static bool insertar_nodo(hash_t *hash, nodo_hash_t *nodo) {
+    if(!hash->vector && hash->tam < CANTIDAD_CHICA)
+    {
+        hash->chicos[hash->tam] = nodo;
+        hash->codigos_chicos[hash->tam] = nodo->codigo;
+        return true;
     }
+    if(!hash->vector && !pasar_a_vector(hash)) return false;
 
-    free(hash->vector);
-
-    hash->vector = nuevo_vector;
-    hash->largo = nuevo_largo;
-    hash->tam = 0;
-    hash->redimensionando = true;
+    size_t posicion = posicion_en_vector(hash, nodo->codigo, hash->largo);
+    lista_t* lista = hash->vector[posicion];
 
+    if(lista && hash->con_desborde && lista_largo(lista) >= LARGO_MAXIMO_LISTA)
+        return desborde_insertar(&hash->desborde, nodo, hash->memoria);
 
-    while(!lista_esta_vacia(lista))
+    if(!lista)
     {
-        lista_t* lista_hash = lista_borrar_primero(lista);
-        while(!lista_esta_vacia(lista_hash))
-        {
-            nodo_hash_t* nodo = lista_borrar_primero(lista_hash);
-            hash_guardar(hash,nodo->clave,nodo->dato);
-            free(nodo->clave);
-            free(nodo);
+        lista = crear_lista(hash);
+        if(!lista) return false;
+        hash->vector[posicion] = lista;
+    }
+    return lista_insertar_ultimo(lista, nodo);
+}
 
-        }
-        free(lista_hash);
+/* obtener_o_insertar para el motor de direccionamiento abierto: un solo
+ * sondeo, que si no encuentra la clave ya deja la ranura en su lugar.
+ */
+static void** obtener_o_insertar_cerrado(hash_t *hash, const clave_hash_t *clave, bool *insertado) {
+    ranura_t* ranura = hash_cerrado_buscar_o_insertar(&hash->cerrado, clave->clave, clave->largo, clave->codigo, insertado);
+    if(!ranura || !*insertado) return ranura ? &ranura->dato : NULL;
+
+    // La ranura nueva apunta a la clave del usuario hasta tener la copia.
+    char* clave_copiada = copiar_clave(hash, clave);
+    if(!clave_copiada)
+    {
+        hash_cerrado_quitar(&hash->cerrado, ranura);
+        *insertado = false;
+        return NULL;
     }
+    ranura->clave = clave_copiada;
 
-    hash->redimensionando = false;
-    free(lista);
-    return true;
+    hash->tam++;
+    return &ranura->dato;
+}
+
+/* hash_borrar para el motor de direccionamiento abierto */
+static void* borrar_cerrado(hash_t *hash, const clave_hash_t *clave) {
+    ranura_t* ranura = buscar_ranura(hash, clave);
+    if(!ranura) return NULL;
+
+    void* dato = ranura->dato;
+    char* clave_guardada = ranura->clave;
+
+    hash_cerrado_quitar(&hash->cerrado, ranura);
+    liberar_clave(hash, clave_guardada, clave->largo);
+
+    hash->tam--;
+    return dato;
+}
+
+/* Guarda un elemento en el hash, si la clave ya se encuentra en la
+ * estructura, la reemplaza. De no poder guardarlo devuelve false.
+ * Pre: La estructura hash fue inicializada
+ * Post: Se almacenó el par (clave, dato)
+ IMPORTANTE: (a) COPIAR CLAVE (para que no te la modifique el usuario) (b) Destruir dato si hay que actualizar
+ */
+bool hash_guardar(hash_t *hash, const char *clave, void *dato) {
+    if(!clave) return false;
+    return hash_guardar_n(hash, clave, strlen(clave), dato);
+}
+
+/* obtener_o_insertar para el hash abierto: recorre una sola vez la lista y,
+ * si la clave no esta, agrega el nodo al final. Solo al insertar se mira si
+ * hay que redimensionar: encontrar la clave no cuesta nada mas que buscarla
+ * y nunca falla por memoria.
+ */
+static void** obtener_o_insertar_abierto(hash_t *hash, const clave_hash_t *clave, bool *insertado) {
+    *insertado = false;
+    nodo_hash_t* nodo = buscar_nodo(hash, clave);
+    if(nodo) return &nodo->dato;
+
+    if(!hash_redimensionar(hash)) return NULL;
+    nodo = crear_nodo(hash, clave, NULL);
+    if(!nodo) return NULL;
+
+    if(!insertar_nodo(hash, nodo))
+    {
+        liberar_nodo(hash, nodo);
+        return NULL;
+    }
+
+    hash->tam++;
+    *insertado = true;
+    return &nodo->dato;
+}
+
+/* Devuelve donde esta el dato de la clave ya hasheada; si no estaba la
+ * guarda con dato NULL e insertado queda en true.
+ * Post: Devuelve NULL si no hubo memoria.
+ */
+static void** obtener_o_insertar(hash_t *hash, const clave_hash_t *clave, bool *insertado) {
+    if(es_cerrado(hash)) return obtener_o_insertar_cerrado(hash, clave, insertado);
+    return obtener_o_insertar_abierto(hash, clave, insertado);
+}
+
+/* hash_guardar con la clave ya hasheada */
+static bool guardar_hasheada(hash_t *hash, const clave_hash_t *buscada, void *dato) {
+    bool insertado;
+    void** lugar = obtener_o_insertar(hash, buscada, &insertado);
+    if(!lugar) return false;
+
+    if(!insertado && hash->destruir_dato) hash->destruir_dato(*lugar);
+    *lugar = dato;
+    return true;
+}
+
+/* hash_guardar con el largo de la clave */
+bool hash_guardar_n(hash_t *hash, const char *clave, size_t largo, void *dato) {
+    if(!hash || !clave) return false;
+    return hash_guardar_hasheada(hash, clave, largo, hash_codigo(hash, clave, largo), dato);
+}
+
+/* hash_guardar con el codigo de la clave ya calculado */
+bool hash_guardar_hasheada(hash_t *hash, const char *clave, size_t largo, uint64_t codigo, void *dato) {
+    if(!hash || !clave) return false;
+
+    clave_hash_t buscada = clave_hasheada(clave, largo, codigo);
+    return guardar_hasheada(hash, &buscada, dato);
+}
+
+/* Obtiene o inserta la clave con un solo hash y un solo sondeo */
+bool hash_obtener_o_insertar(hash_t *hash, const char *clave, void ***dato, bool *insertado) {
+    if(insertado) *insertado = false;
+    if(!hash || !clave || !dato) return false;
+
+    size_t largo = strlen(clave);
+    return hash_obtener_o_insertar_hasheada(hash, clave, largo, hash_codigo(hash, clave, largo), dato, insertado);
+}
+
+/* hash_obtener_o_insertar con el largo y el codigo de la clave */
+bool hash_obtener_o_insertar_hasheada(hash_t *hash, const char *clave, size_t largo, uint64_t codigo,
+                                      void ***dato, bool *insertado) {
+    if(insertado) *insertado = false;
+    if(!hash || !clave || !dato) return false;
+
+    bool nuevo;
+    clave_hash_t buscada = clave_hasheada(clave, largo, codigo);
+    *dato = obtener_o_insertar(hash, &buscada, &nuevo);
+    if(insertado) *insertado = nuevo;
+    return *dato != NULL;
+}
+
+/* Reemplaza el dato de la clave por lo que devuelve actualizar */
+bool hash_actualizar(hash_t *hash, const char *clave, hash_actualizar_t actualizar, void *extra) {
+    if(!actualizar) return false;
+
+    void** dato;
+    if(!hash_obtener_o_insertar(hash, clave, &dato, NULL)) return false;
+    *dato = actualizar(*dato, extra);
+    return true;
+}
+
+/* Saca de la lista de vector[posicion] el nodo con la clave y lo devuelve,
+ * o NULL si no esta. Si la lista queda vacia la destruye.
+ */
+static nodo_hash_t* borrar_de_posicion(void** vector, size_t posicion, const clave_hash_t *clave) {
+    lista_t* lista = vector[posicion];
+    if(!lista) return NULL;
+
+    nodo_hash_t* nodo = lista_borrar_buscado(lista, es_clave_buscada, clave);
+    if(nodo && lista_esta_vacia(lista))
+    {
+        lista_destruir(lista, NULL);
+        vector[posicion] = NULL;
+    }
+    return nodo;
+}
+
+/* Saca el nodo con la clave del arreglo de chicos, llenando el hueco con el
+ * ultimo. Devuelve NULL si no esta.
+ */
+static nodo_hash_t* borrar_chico(hash_t *hash, const clave_hash_t *clave) {
+    size_t indice = buscar_chico(hash, clave);
+    if(indice == hash->tam) return NULL;
+
+    nodo_hash_t* nodo = hash->chicos[indice];
+    hash->chicos[indice] = hash->chicos[hash->tam - 1];
+    hash->codigos_chicos[indice] = hash->codigos_chicos[hash->tam - 1];
+    return nodo;
+}
+
+/* Saca el nodo con la clave de donde este: vector viejo, vector o desborde.
+ * Devuelve NULL si no esta.
+ */
+static nodo_hash_t* borrar_de_vectores(hash_t *hash, const clave_hash_t *clave) {
+    nodo_hash_t* nodo = NULL;
+    size_t vieja = posicion_vieja(hash, clave->codigo);
+    if(vieja < hash->largo_viejo)
+        nodo = borrar_de_posicion(hash->vector_viejo, vieja, clave);
+    if(!nodo)
+        nodo = borrar_de_posicion(hash->vector, posicion_en_vector(hash, clave->codigo, hash->largo), clave);
+    if(!nodo)
+        nodo = desborde_quitar(&hash->desborde, clave, hash->memoria);
+    return nodo;
+}
+
+/* Borra un elemento del hash y devuelve el dato asociado.  Devuelve
+ * NULL si el dato no estaba.
+ * Pre: La estructura hash fue inicializada
+ * Post: El elemento fue borrado de la estructura y se lo devolvió,
+ * en el caso de que estuviera guardado.
+ IMPORTANTE: DSTRUIR DATO SI NO ES NULL
+ */
+void* hash_borrar(hash_t *hash, const char *clave) {
+    if(!clave) return NULL;
+    return hash_borrar_n(hash, clave, strlen(clave));
+}
+
+/* hash_borrar con el largo de la clave */
+void* hash_borrar_n(hash_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return NULL;
+    return hash_borrar_hasheada(hash, clave, largo, hash_codigo(hash, clave, largo));
+}
+
+/* hash_borrar con el codigo de la clave ya calculado */
+void* hash_borrar_hasheada(hash_t *hash, const char *clave, size_t largo, uint64_t codigo) {
+    if(!hash || !clave) return NULL;
+
+    clave_hash_t buscada = clave_hasheada(clave, largo, codigo);
+    if(es_cerrado(hash))
+        return borrar_cerrado(hash, &buscada);
+
+    nodo_hash_t* nodo = hash->vector ? borrar_de_vectores(hash, &buscada) : borrar_chico(hash, &buscada);
+    void* dato = NULL;
+    if(nodo)
+    {
+        dato = nodo->dato;
+        liberar_nodo(hash, nodo);
+        hash->tam--;
+    }
+
+    // Achicar (o avanzar la migracion) es solo una optimizacion: si no hay
+    // memoria la clave ya se borro igual y el vector queda como estaba.
+    hash_redimensionar(hash);
+
+    return dato;
+}
+
+/* Obtiene el valor de un elemento del hash, si la clave no se encuentra
+ * devuelve NULL.
+ * Pre: La estructura hash fue inicializada
+ */
+void* hash_obtener(const hash_t *hash, const char *clave) {
+    if(!clave) return NULL;
+    return hash_obtener_n(hash, clave, strlen(clave));
+}
+
+/* hash_obtener con el largo de la clave */
+void* hash_obtener_n(const hash_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return NULL;
+    return hash_obtener_hasheada(hash, clave, largo, hash_codigo(hash, clave, largo));
+}
+
+/* hash_obtener con el codigo de la clave ya calculado */
+void* hash_obtener_hasheada(const hash_t *hash, const char *clave, size_t largo, uint64_t codigo) {
+    if(!hash || !clave) return NULL;
+
+    clave_hash_t buscada = clave_hasheada(clave, largo, codigo);
+    if(es_cerrado(hash))
+    {
+        ranura_t* ranura = buscar_ranura(hash, &buscada);
+        return ranura ? ranura->dato : NULL;
+    }
+
+    nodo_hash_t* nodo = buscar_nodo(hash, &buscada);
+    return nodo ? nodo->dato : NULL;
+}
+
+/* Busca hasta LOTE claves anticipando en pasadas lo que cada busqueda va a
+ * leer (ver BUSQUEDA POR LOTES). Guarda en datos el dato de cada clave (NULL
+ * si no esta) y en encontradas si esta.
+ * Post: Devuelve cuantas claves se encontraron.
+ */
+static size_t buscar_tramo(const hash_t *hash, const char *const claves[], size_t cantidad, void *datos[], bool encontradas[]) {
+    clave_hash_t buscadas[LOTE];
+    lista_t* listas[LOTE];
+    bool anticipar = !es_cerrado(hash) && hash->vector && !hash->vector_viejo;
+
+    for(size_t i = 0; i < cantidad; i++)
+    {
+        listas[i] = NULL;
+        if(!claves[i]) continue;
+        buscadas[i] = hashear(hash, claves[i], strlen(claves[i]));
+        if(es_cerrado(hash))
+            hash_cerrado_anticipar(&hash->cerrado, buscadas[i].codigo);
+        else if(anticipar)
+            memoria_anticipar(&hash->vector[posicion_en_vector(hash, buscadas[i].codigo, hash->largo)]);
+    }
+
+    if(anticipar)
+    {
+        for(size_t i = 0; i < cantidad; i++)
+        {
+            if(!claves[i]) continue;
+            listas[i] = hash->vector[posicion_en_vector(hash, buscadas[i].codigo, hash->largo)];
+            memoria_anticipar(listas[i]);
+        }
+        for(size_t i = 0; i < cantidad; i++)
+            if(listas[i]) lista_anticipar(listas[i]);
+        for(size_t i = 0; i < cantidad; i++)
+            if(listas[i]) memoria_anticipar(lista_ver_primero(listas[i]));
+    }
+
+    size_t total = 0;
+    for(size_t i = 0; i < cantidad; i++)
+    {
+        datos[i] = NULL;
+        encontradas[i] = false;
+        if(!claves[i]) continue;
+
+        if(es_cerrado(hash))
+        {
+            ranura_t* ranura = buscar_ranura(hash, &buscadas[i]);
+            if(ranura)
+            {
+                datos[i] = ranura->dato;
+                encontradas[i] = true;
+            }
+        }
+        else
+        {
+            nodo_hash_t* nodo = buscar_nodo(hash, &buscadas[i]);
+            if(nodo)
+            {
+                datos[i] = nodo->dato;
+                encontradas[i] = true;
+            }
+        }
+        total += encontradas[i];
+    }
+    return total;
+}
+
+/* Obtiene los datos de cantidad claves, buscandolas de a LOTE */
+size_t hash_obtener_lote(const hash_t *hash, const char *const claves[], size_t cantidad, void *resultados[]) {
+    if(!hash || !claves || !resultados) return 0;
+
+    bool encontradas[LOTE];
+    size_t total = 0;
+    for(size_t i = 0; i < cantidad; i += LOTE)
+    {
+        size_t tramo = cantidad - i < LOTE ? cantidad - i : LOTE;
+        total += buscar_tramo(hash, claves + i, tramo, resultados + i, encontradas);
+    }
+    return total;
+}
+
+/* Determina si pertenecen cantidad claves, buscandolas de a LOTE */
+size_t hash_pertenece_lote(const hash_t *hash, const char *const claves[], size_t cantidad, bool resultados[]) {
+    if(!hash || !claves || !resultados) return 0;
+
+    void* datos[LOTE];
+    size_t total = 0;
+    for(size_t i = 0; i < cantidad; i += LOTE)
+    {
+        size_t tramo = cantidad - i < LOTE ? cantidad - i : LOTE;
+        total += buscar_tramo(hash, claves + i, tramo, datos, resultados + i);
+    }
+    return total;
+}
+
+/* Devuelve la cantidad de elementos del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+size_t hash_cantidad(const hash_t *hash) {
+	return hash ? hash->tam : 0;
+}
+
+/* Libera un nodo con su clave, llamando a destruir_dato con el dato */
+static void destruir_nodo(hash_t *hash, nodo_hash_t *nodo) {
+    if(hash->destruir_dato != NULL)
+        hash->destruir_dato(nodo->dato);
+
+    liberar_nodo(hash, nodo);
+}
+
+/* Libera las listas de un vector y el vector. Si recorrer es false no mira
+ * los nodos: quedan en las reservas, que se liberan enteras despues.
+ */
+static void destruir_vector(hash_t *hash, void** vector, size_t largo, bool recorrer) {
+    for(size_t i=0;i<largo;i++)
+    {
+        lista_t* lista = vector[i];
+        if(!lista) continue;
+
+        while(recorrer && !lista_esta_vacia(lista))
+            destruir_nodo(hash, lista_borrar_primero(lista));
+        memoria_liberar(hash->memoria, lista);
+    }
+    memoria_liberar(hash->memoria, vector);
+}
+
+/* Destruye la estructura liberando la memoria pedida y llamando a la función
+ * destruir para cada par (clave, dato).
+ * Pre: La estructura hash fue inicializada
+ * Post: La estructura hash fue destruida
+ */
+void hash_destruir(hash_t *hash) {
+    if(!hash) return;
+
+    hilos_destruir(hash->hilos);
+    if(es_cerrado(hash))
+    {
+        hash_cerrado_destruir(&hash->cerrado, hash->destruir_dato);
+        memoria_liberar(hash->memoria, hash);
+        return;
+    }
+
+    // Solo hace falta recorrer los nodos para destruir datos o claves largas.
+    bool recorrer = hash->destruir_dato || hash->claves_grandes;
+
+    for(size_t i = 0; recorrer && !hash->vector && i < hash->tam; i++)
+        destruir_nodo(hash, hash->chicos[i]);
+
+    destruir_vector(hash, hash->vector, hash->largo, recorrer);
+    if(hash->vector_viejo) destruir_vector(hash, hash->vector_viejo, hash->largo_viejo, recorrer);
+    for(size_t i = 0; i < hash->desborde.cantidad_trozos; i++)
+    {
+        trozo_t* trozo = hash->desborde.trozos[i];
+        for(size_t j = 0; recorrer && j < trozo->cantidad; j++)
+            destruir_nodo(hash, trozo->nodos[j]);
+        memoria_liberar(hash->memoria, trozo);
+    }
+    memoria_liberar(hash->memoria, hash->desborde.trozos);
+
+    bloques_liberar(&hash->nodos);
+    bloques_liberar(&hash->nodos_lista);
+    for(size_t i = 0; i < CLASES_CLAVE; i++)
+        bloques_liberar(&hash->claves[i]);
+    memoria_liberar(hash->memoria, hash);
+}
+
+/* Iterador del hash */
+
+/* Devuelve la lista de una posicion del recorrido. Durante una migracion las
+ * primeras largo_viejo posiciones son las del vector viejo.
+ */
+static lista_t* lista_en_posicion(const hash_t *hash, size_t posicion) {
+    if(posicion < hash->largo_viejo) return hash->vector_viejo[posicion];
+    return hash->vector[posicion - hash->largo_viejo];
+}
+
+/* Lleva el recorrido del hash abierto al primer nodo de la proxima lista
+ * desde su posicion inclusive. Si no quedan listas pasa al desborde.
+ */
+static void buscar_proxima_lista(hash_recorrido_t *recorrido) {
+    const hash_t* hash = recorrido->hash;
+    size_t posiciones = hash->largo_viejo + hash->largo;
+
+    while(recorrido->posicion < posiciones)
+    {
+        lista_t* lista = lista_en_posicion(hash, recorrido->posicion);
+        recorrido->nodo = lista ? lista_nodo_primero(lista) : NULL;
+        if(recorrido->nodo) return;
+        recorrido->posicion++;
+    }
+    recorrido->en_desborde = true;
+    recorrido->posicion = 0;
+}
+
+/* Inicializa el recorrido en la primer clave */
+void hash_recorrido_iniciar(hash_recorrido_t *recorrido, const hash_t *hash) {
+    if(!recorrido) return;
+
+    recorrido->hash = hash;
+    recorrido->nodo = NULL;
+    recorrido->posicion = 0;
+    recorrido->recorridos = 0;
+    recorrido->en_desborde = false;
+    if(!hash || !hash->tam) return;
+
+    if(es_cerrado(hash))
+        recorrido->posicion = hash_cerrado_proxima(&hash->cerrado, 0);
+    else if(hash->vector)
+        buscar_proxima_lista(recorrido);
+}
+
+/* Comprueba si terminó el recorrido */
+bool hash_recorrido_al_final(const hash_recorrido_t *recorrido) {
+    return !recorrido || !recorrido->hash || recorrido->recorridos >= recorrido->hash->tam;
+}
+
+/* Avanza el recorrido a la proxima clave de ser posible */
+bool hash_recorrido_avanzar(hash_recorrido_t *recorrido) {
+    if(hash_recorrido_al_final(recorrido)) return false;
+    const hash_t* hash = recorrido->hash;
+    recorrido->recorridos++;
+
+    // 0 - Hash cerrado: se pasa a la proxima ranura ocupada.
+    if(es_cerrado(hash))
+        recorrido->posicion = hash_cerrado_proxima(&hash->cerrado, recorrido->posicion + 1);
+
+    // 1 - Desborde: se pasa al siguiente nodo del trozo, o al proximo trozo.
+    else if(recorrido->en_desborde)
+        recorrido->posicion = desborde_siguiente(&hash->desborde, recorrido->posicion);
+
+    // 2 - Arreglo de chicos: se pasa al siguiente.
+    else if(!hash->vector)
+        recorrido->posicion++;
+
+    // 3 - Siguiente nodo de la lista, o primero de la proxima lista.
+    else if(!(recorrido->nodo = lista_nodo_siguiente(recorrido->nodo)))
+    {
+        recorrido->posicion++;
+        buscar_proxima_lista(recorrido);
+    }
+
+    return !hash_recorrido_al_final(recorrido);
+}
+
+/* Devuelve el nodo actual del recorrido del hash abierto */
+static const nodo_hash_t* nodo_actual(const hash_recorrido_t *recorrido) {
+    const hash_t* hash = recorrido->hash;
+    if(!hash->vector)
+        return hash->chicos[recorrido->posicion];
+    if(recorrido->en_desborde)
+        return desborde_nodo(&hash->desborde, recorrido->posicion);
+    return lista_nodo_dato(recorrido->nodo);
+}
+
+/* Devuelve clave actual, esa clave no se puede modificar ni liberar */
+const char *hash_recorrido_ver_actual(const hash_recorrido_t *recorrido) {
+    if(hash_recorrido_al_final(recorrido)) return NULL;
+    if(es_cerrado(recorrido->hash))
+        return recorrido->hash->cerrado.ranuras[recorrido->posicion].clave;
+    return clave_de_nodo(nodo_actual(recorrido));
+}
+
+/* Devuelve el largo de la clave actual, que puede tener '\0' en el medio */
+size_t hash_recorrido_ver_largo(const hash_recorrido_t *recorrido) {
+    if(hash_recorrido_al_final(recorrido)) return 0;
+    if(es_cerrado(recorrido->hash))
+        return recorrido->hash->cerrado.ranuras[recorrido->posicion].largo;
+    return largo_de_nodo(nodo_actual(recorrido));
+}
+
+/* Devuelve el dato de la clave actual */
+void *hash_recorrido_ver_dato(const hash_recorrido_t *recorrido) {
+    if(hash_recorrido_al_final(recorrido)) return NULL;
+    if(es_cerrado(recorrido->hash))
+        return recorrido->hash->cerrado.ranuras[recorrido->posicion].dato;
+    return nodo_actual(recorrido)->dato;
+}
+
+/* Crea un iterador del Hash. Solo pide memoria para si mismo. */
+hash_iter_t *hash_iter_crear(const hash_t *hash) {
+    if(!hash) return NULL;
+
+    hash_iter_t *hash_iter = memoria_pedir(hash->memoria, sizeof(hash_iter_t));
+    if(!hash_iter) return NULL;
+
+    hash_recorrido_iniciar(&hash_iter->recorrido, hash);
+    return hash_iter;
+}
+
+/* Comprueba si terminó la iteración */
+bool hash_iter_al_final(const hash_iter_t *hash_iter) {
+    return !hash_iter || hash_recorrido_al_final(&hash_iter->recorrido);
+}
+
+/* Avanza el iterador a la proxima posicion valida de ser posible */
+bool hash_iter_avanzar(hash_iter_t *hash_iter) {
+    return hash_iter && hash_recorrido_avanzar(&hash_iter->recorrido);
+}
+
+/* Devuelve clave actual, esa clave no se puede modificar ni liberada */
+const char *hash_iter_ver_actual(const hash_iter_t *hash_iter) {
+    return hash_iter ? hash_recorrido_ver_actual(&hash_iter->recorrido) : NULL;
+}
+
+/* Devuelve el largo de la clave actual, que puede tener '\0' en el medio */
+size_t hash_iter_ver_largo(const hash_iter_t *hash_iter) {
+    return hash_iter ? hash_recorrido_ver_largo(&hash_iter->recorrido) : 0;
+}
+
+/* Destruye iterador */
+void hash_iter_destruir(hash_iter_t* hash_iter) {
+    if(!hash_iter) return;
+    memoria_liberar(hash_iter->recorrido.hash->memoria, hash_iter);
+}
+
+/* Aplica visitar a los nodos de un vector hasta que devuelva false.
+ * Post: Devuelve false si se corto la iteracion.
+ */
+static bool iterar_vector(void** vector, size_t largo, hash_visitar_t visitar, void *extra) {
+    for(size_t i = 0; i < largo; i++)
+    {
+        if(!vector[i]) continue;
+        for(const lista_nodo_t* l = lista_nodo_primero(vector[i]); l; l = lista_nodo_siguiente(l))
+        {
+            nodo_hash_t* nodo = lista_nodo_dato(l);
+            if(!visitar(clave_de_nodo(nodo), largo_de_nodo(nodo), nodo->dato, extra)) return false;
+        }
+    }
+    return true;
+}
+
+/* Aplica visitar a un arreglo de nodos hasta que devuelva false.
+ * Post: Devuelve false si se corto la iteracion.
+ */
+static bool iterar_nodos(nodo_hash_t** nodos, size_t cantidad, hash_visitar_t visitar, void *extra) {
+    for(size_t i = 0; i < cantidad; i++)
+        if(!visitar(clave_de_nodo(nodos[i]), largo_de_nodo(nodos[i]), nodos[i]->dato, extra)) return false;
+    return true;
+}
+
+/* Devuelve el primero de los total elementos que le tocan a una de partes
+ * partes iguales: la parte termina donde empieza la siguiente.
+ */
+static size_t inicio_de(size_t total, size_t parte, size_t partes) {
+    return total * parte / partes;
+}
+
+/* Itera una parte del almacenamiento: su rango de ranuras, o de chicos, o de
+ * posiciones de los dos vectores (el viejo primero, como lista_en_posicion)
+ * y su rango de trozos del desborde.
+ */
+void hash_iterar_parte(const hash_t *hash, size_t parte, size_t partes, hash_visitar_t visitar, void *extra) {
+    if(!hash || !visitar || parte >= partes) return;
+
+    if(es_cerrado(hash))
+    {
+        const hash_cerrado_t* cerrado = &hash->cerrado;
+        for(size_t i = inicio_de(cerrado->capacidad, parte, partes); i < inicio_de(cerrado->capacidad, parte + 1, partes); i++)
+        {
+            const ranura_t* ranura = &cerrado->ranuras[i];
+            if(ranura->clave && !visitar(ranura->clave, ranura->largo, ranura->dato, extra)) return;
+        }
+        return;
+    }
+
+    if(!hash->vector)
+    {
+        size_t desde = inicio_de(hash->tam, parte, partes);
+        iterar_nodos((nodo_hash_t**) hash->chicos + desde, inicio_de(hash->tam, parte + 1, partes) - desde, visitar, extra);
+        return;
+    }
+
+    size_t viejas = hash->largo_viejo;
+    size_t desde = inicio_de(viejas + hash->largo, parte, partes);
+    size_t hasta = inicio_de(viejas + hash->largo, parte + 1, partes);
+    if(desde < viejas && !iterar_vector(hash->vector_viejo + desde, (hasta < viejas ? hasta : viejas) - desde, visitar, extra)) return;
+    if(hasta > viejas)
+    {
+        size_t primera = desde > viejas ? desde - viejas : 0;
+        if(!iterar_vector(hash->vector + primera, hasta - viejas - primera, visitar, extra)) return;
+    }
+
+    desde = inicio_de(hash->desborde.cantidad_trozos, parte, partes);
+    hasta = inicio_de(hash->desborde.cantidad_trozos, parte + 1, partes);
+    for(size_t i = desde; i < hasta; i++)
+    {
+        const trozo_t* trozo = hash->desborde.trozos[i];
+        if(!iterar_nodos((nodo_hash_t**) trozo->nodos, trozo->cantidad, visitar, extra)) return;
+    }
+}
+
+/* Itera el hash recorriendo el almacenamiento directamente: una sola parte */
+void hash_iterar(const hash_t *hash, hash_visitar_t visitar, void *extra) {
+    hash_iterar_parte(hash, 0, 1, visitar, extra);
+}
+
+/* Iteracion repartida entre hilos. cortada avisa a todos que visitar devolvio
+ * false en alguno.
+ */
+typedef struct iteracion_paralela {
+    const hash_t* hash;
+    hash_visitar_t visitar;
+    void* extra;
+    size_t partes;
+    bool cortada;
+} iteracion_paralela_t;
+
+static bool visitar_en_paralelo(const char *clave, size_t largo, void *dato, void *extra) {
+    iteracion_paralela_t* iteracion = extra;
+    if(__atomic_load_n(&iteracion->cortada, __ATOMIC_RELAXED)) return false;
+    if(iteracion->visitar(clave, largo, dato, iteracion->extra)) return true;
+
+    __atomic_store_n(&iteracion->cortada, true, __ATOMIC_RELAXED);
+    return false;
+}
+
+static void iterar_en_paralelo(void *extra, size_t parte) {
+    iteracion_paralela_t* iteracion = extra;
+    hash_iterar_parte(iteracion->hash, parte, iteracion->partes, visitar_en_paralelo, iteracion);
+}
+
+/* Itera el hash repartiendo las partes entre hilos creados para la llamada */
+void hash_iterar_paralelo(const hash_t *hash, hash_visitar_t visitar, void *extra, size_t hilos) {
+    if(!hash || !visitar) return;
+
+    hilos_t* trabajadores = hilos > 1 && hash->tam >= MINIMO_PARALELO ? hilos_crear(hilos) : NULL;
+    iteracion_paralela_t iteracion = { hash, visitar, extra, hilos_cantidad(trabajadores) * PARTES_POR_HILO, false };
+    hilos_ejecutar(trabajadores, iterar_en_paralelo, &iteracion, iteracion.partes);
+    hilos_destruir(trabajadores);
+}
+
+/* Devuelve los hilos del hash para repartir un trabajo de cantidad
+ * elementos, creandolos la primera vez, o NULL si se hace en un solo hilo.
+ */
+static hilos_t* hilos_para(hash_t *hash, size_t cantidad) {
+    if(hash->opciones.hilos < 2 || cantidad < MINIMO_PARALELO) return NULL;
+    if(!hash->hilos) hash->hilos = hilos_crear(hash->opciones.hilos);
+    return hash->hilos;
+}
+
+/* Listas vacias para reutilizar al reubicar los nodos */
+typedef struct reserva {
+    lista_t** listas;
+    size_t cantidad;
+    size_t capacidad;
+    hash_t* hash;                           /* Para crear listas con su reserva de nodos */
+} reserva_t;
+
+/* Guarda una lista vacia en la reserva, o la destruye si no hay lugar */
+static void reserva_guardar(reserva_t* reserva, lista_t* lista) {
+    if(reserva->cantidad < reserva->capacidad)
+        reserva->listas[reserva->cantidad++] = lista;
+    else
+        lista_destruir(lista, NULL);
+}
+
+/* Saca una lista vacia de la reserva, o crea una si no quedan */
+static lista_t* reserva_sacar(reserva_t* reserva) {
+    return reserva->cantidad ? reserva->listas[--reserva->cantidad] : crear_lista(reserva->hash);
+}
+
+/* Reenlaza cada nodo de la lista nodos al final de la lista de su posicion en
+ * el vector, sin copiar claves ni rehashear.
+ * Post: Devuelve false si hizo falta crear una lista y no hubo memoria; los
+ * nodos que faltaban mover quedan en nodos.
+ */
+static bool reenlazar_nodos(const hash_t* hash, lista_t* nodos, void** vector, size_t largo, reserva_t* reserva) {
+    while(!lista_esta_vacia(nodos))
+    {
+        nodo_hash_t* nodo = lista_ver_primero(nodos);
+        size_t posicion = posicion_en_vector(hash, nodo->codigo, largo);
+
+        if(!vector[posicion])
+        {
+            vector[posicion] = reserva_sacar(reserva);
+            if(!vector[posicion]) return false;
+        }
+        lista_mover_primero(nodos, vector[posicion]);
+    }
+    return true;
+}
+
+/* Junta en la lista nodos los nodos de todas las listas del vector, que
+ * quedan vacias en la reserva.
+ */
+static void juntar_nodos(lista_t* nodos, void** vector, size_t largo, reserva_t* reserva) {
+    for(size_t i = 0; i < largo; i++)
+    {
+        lista_t* lista = vector[i];
+        if(!lista || lista == nodos) continue;
+
+        lista_concatenar(nodos, lista);
+        reserva_guardar(reserva, lista);
+        vector[i] = NULL;
+    }
+}
+
+/* Reubicacion del vector repartida entre hilos. Las partes de origen son
+ * rangos del vector viejo y las de destino rangos de ancho posiciones del
+ * nuevo: cada hilo solo toca las listas de su rango, asi que no hay cerrojos.
+ */
+typedef struct reubicacion {
+    hash_t* hash;
+    void** nuevo_vector;
+    size_t nuevo_largo;
+    size_t partes;
+    size_t ancho;
+    lista_t** intermedias;                  /* [origen * partes + destino], en el orden del vector viejo */
+    size_t* ocupadas;                       /* Posiciones nuevas de cada destino; despues, su primera lista */
+    lista_t** listas;                       /* Listas vacias para el vector nuevo, por destino */
+} reubicacion_t;
+
+/* Marca en el vector nuevo las posiciones que van a tener lista */
+static char posicion_ocupada;
+
+/* Devuelve la parte de destino de un nodo */
+static size_t destino_de(const reubicacion_t* reubicacion, const nodo_hash_t* nodo) {
+    return posicion_en_vector(reubicacion->hash, nodo->codigo, reubicacion->nuevo_largo) / reubicacion->ancho;
+}
+
+/* Reparte los nodos de una parte del vector viejo en sus listas intermedias,
+ * una por parte de destino. Las listas viejas quedan vacias en su lugar.
+ */
+static void separar_parte(void* extra, size_t origen) {
+    reubicacion_t* reubicacion = extra;
+    void** vector = reubicacion->hash->vector;
+    lista_t** intermedias = &reubicacion->intermedias[origen * reubicacion->partes];
+    size_t largo = reubicacion->hash->largo;
+
+    for(size_t i = inicio_de(largo, origen, reubicacion->partes); i < inicio_de(largo, origen + 1, reubicacion->partes); i++)
+    {
+        lista_t* lista = vector[i];
+        while(lista && !lista_esta_vacia(lista))
+            lista_mover_primero(lista, intermedias[destino_de(reubicacion, lista_ver_primero(lista))]);
+    }
+}
+
+/* Marca las posiciones nuevas de una parte de destino y cuenta cuantas son */
+static void contar_destino(void* extra, size_t destino) {
+    reubicacion_t* reubicacion = extra;
+    size_t ocupadas = 0;
+
+    for(size_t origen = 0; origen < reubicacion->partes; origen++)
+    {
+        lista_t* intermedia = reubicacion->intermedias[origen * reubicacion->partes + destino];
+        for(const lista_nodo_t* nodo = lista_nodo_primero(intermedia); nodo; nodo = lista_nodo_siguiente(nodo))
+        {
+            const nodo_hash_t* nodo_hash = lista_nodo_dato(nodo);
+            void** lugar = &reubicacion->nuevo_vector[posicion_en_vector(reubicacion->hash, nodo_hash->codigo, reubicacion->nuevo_largo)];
+            if(*lugar) continue;
+            *lugar = &posicion_ocupada;
+            ocupadas++;
+        }
+    }
+    reubicacion->ocupadas[destino] = ocupadas;
+}
+
+/* Reenlaza los nodos de una parte de destino en el vector nuevo, tomando
+ * las listas de su tramo. Recorre las intermedias en el orden del vector
+ * viejo, asi cada lista queda igual que reenlazando de a uno.
+ */
+static void enlazar_destino(void* extra, size_t destino) {
+    reubicacion_t* reubicacion = extra;
+    lista_t** siguiente = &reubicacion->listas[reubicacion->ocupadas[destino]];
+
+    for(size_t origen = 0; origen < reubicacion->partes; origen++)
+    {
+        lista_t* intermedia = reubicacion->intermedias[origen * reubicacion->partes + destino];
+        while(!lista_esta_vacia(intermedia))
+        {
+            const nodo_hash_t* nodo = lista_ver_primero(intermedia);
+            void** lugar = &reubicacion->nuevo_vector[posicion_en_vector(reubicacion->hash, nodo->codigo, reubicacion->nuevo_largo)];
+            if(*lugar == &posicion_ocupada) *lugar = *siguiente++;
+            lista_mover_primero(intermedia, *lugar);
+        }
+    }
+}
+
+/* Destruye las listas intermedias, que ya estan vacias */
+static void destruir_intermedias(reubicacion_t* reubicacion, size_t cantidad) {
+    for(size_t i = 0; i < cantidad; i++)
+        lista_destruir(reubicacion->intermedias[i], NULL);
+    memoria_liberar(reubicacion->hash->memoria, reubicacion->intermedias);
+}
+
+/* Junta las listas vacias del vector viejo y crea las que falten para tener
+ * necesarias, y destruye las que sobran.
+ * Post: Devuelve false, sin destruir ninguna lista del vector viejo, si no
+ * hubo memoria.
+ */
+static bool juntar_listas(reubicacion_t* reubicacion, size_t necesarias) {
+    hash_t* hash = reubicacion->hash;
+    reubicacion->listas = memoria_pedir(hash->memoria, sizeof(lista_t*) * (necesarias ? necesarias : 1));
+    if(!reubicacion->listas) return false;
+
+    size_t juntadas = 0;
+    for(size_t i = 0; i < hash->largo && juntadas < necesarias; i++)
+        if(hash->vector[i]) reubicacion->listas[juntadas++] = hash->vector[i];
+
+    size_t viejas = juntadas;
+    while(juntadas < necesarias && (reubicacion->listas[juntadas] = crear_lista(hash)))
+        juntadas++;
+    if(juntadas < necesarias)
+    {
+        while(juntadas > viejas) lista_destruir(reubicacion->listas[--juntadas], NULL);
+        memoria_liberar(hash->memoria, reubicacion->listas);
+        return false;
+    }
+
+    // Las que no se usan son las ultimas del vector viejo.
+    for(size_t i = 0; i < hash->largo; i++)
+    {
+        if(!hash->vector[i]) continue;
+        if(viejas) viejas--;
+        else lista_destruir(hash->vector[i], NULL);
+        hash->vector[i] = NULL;
+    }
+    return true;
+}
+
+/* Pasa todos los nodos al vector nuevo (limpio) repartiendo el trabajo entre
+ * los hilos del hash: cada hilo separa los nodos de un rango del vector viejo
+ * por rango de destino, y despues cada hilo reenlaza los de un rango del
+ * vector nuevo. Las listas se piden antes, en un solo hilo, porque las
+ * reservas son de todo el hash. El resultado es el mismo que en un hilo.
+ * Post: Devuelve false si no hay hilos o no hubo memoria, con los nodos en el
+ * vector viejo y el nuevo limpio.
+ */
+static bool reubicar_en_paralelo(hash_t* hash, void** nuevo_vector, size_t nuevo_largo) {
+    hilos_t* hilos = hilos_para(hash, hash->tam);
+    if(!hilos) return false;
+
+    size_t partes = hilos_cantidad(hilos) * PARTES_POR_HILO;
+    reubicacion_t reubicacion = { hash, nuevo_vector, nuevo_largo, partes, nuevo_largo / partes + 1, NULL, NULL, NULL };
+    reubicacion.intermedias = memoria_pedir(hash->memoria, sizeof(lista_t*) * partes * partes);
+    reubicacion.ocupadas = memoria_pedir(hash->memoria, sizeof(size_t) * partes);
+    size_t creadas = 0;
+    while(reubicacion.intermedias && creadas < partes * partes && (reubicacion.intermedias[creadas] = crear_lista(hash)))
+        creadas++;
+
+    if(!reubicacion.ocupadas || creadas < partes * partes)
+    {
+        if(reubicacion.intermedias) destruir_intermedias(&reubicacion, creadas);
+        memoria_liberar(hash->memoria, reubicacion.ocupadas);
+        return false;
+    }
+
+    // 1 - Separa los nodos por destino y cuenta las listas que hacen falta.
+    hilos_ejecutar(hilos, separar_parte, &reubicacion, partes);
+    hilos_ejecutar(hilos, contar_destino, &reubicacion, partes);
+    size_t necesarias = 0;
+    for(size_t destino = 0; destino < partes; destino++)
+    {
+        size_t ocupadas = reubicacion.ocupadas[destino];
+        reubicacion.ocupadas[destino] = necesarias;
+        necesarias += ocupadas;
+    }
+
+    // 2 - Reenlaza cada rango del vector nuevo con sus listas.
+    bool reubicados = juntar_listas(&reubicacion, necesarias);
+    if(reubicados)
+    {
+        hilos_ejecutar(hilos, enlazar_destino, &reubicacion, partes);
+        memoria_liberar(hash->memoria, reubicacion.listas);
+    }
+    else
+    {
+        // Las listas viejas siguen en su lugar: vuelven sin pedir memoria.
+        vector_limpiar(nuevo_vector, nuevo_largo);
+        reserva_t reserva = { NULL, 0, 0, hash };
+        for(size_t i = 0; i < partes * partes; i++)
+            reenlazar_nodos(hash, reubicacion.intermedias[i], hash->vector, hash->largo, &reserva);
+    }
+
+    destruir_intermedias(&reubicacion, partes * partes);
+    memoria_liberar(hash->memoria, reubicacion.ocupadas);
+    return reubicados;
+}
+
+/* Pasa todos los nodos al vector nuevo (limpio) en un solo hilo: los junta
+ * en una lista y los reenlaza de a uno.
+ * Post: Si no hay memoria devuelve false con los nodos en el vector viejo.
+ */
+static bool reubicar_en_un_hilo(hash_t* hash, void** nuevo_vector, size_t nuevo_largo) {
+    size_t listas_viejas = 0;
+    for(size_t i = 0; i < hash->largo; i++)
+        if(hash->vector[i]) listas_viejas++;
+
+    // Con una lista de repuesto siempre alcanzan las que hay para volver atras.
+    reserva_t reserva = { memoria_pedir(hash->memoria, sizeof(lista_t*) * (listas_viejas + 1)), 0, listas_viejas + 1, hash };
+    lista_t* repuesto = crear_lista(hash);
+
+    if(!reserva.listas || !repuesto)
+    {
+        memoria_liberar(hash->memoria, reserva.listas);
+        if(repuesto) lista_destruir(repuesto, NULL);
+        return false;
+    }
+    reserva_guardar(&reserva, repuesto);
+
+    // 1 - Junta todos los nodos en una sola lista (la ultima de la reserva).
+    lista_t* nodos = reserva_sacar(&reserva);
+    juntar_nodos(nodos, hash->vector, hash->largo, &reserva);
+
+    // 2 - Reenlaza cada nodo en su posicion del vector nuevo.
+    bool reubicados = reenlazar_nodos(hash, nodos, nuevo_vector, nuevo_largo, &reserva);
+    if(!reubicados)
+    {
+        // Vuelve todo al vector viejo. Hay tantas listas como posiciones
+        // ocupadas tenia, asi que esta vez no se pide memoria.
+        juntar_nodos(nodos, nuevo_vector, nuevo_largo, &reserva);
+        reenlazar_nodos(hash, nodos, hash->vector, hash->largo, &reserva);
+    }
+
+    // 3 - Libera las listas que sobraron.
+    while(reserva.cantidad) lista_destruir(reserva.listas[--reserva.cantidad], NULL);
+    lista_destruir(nodos, NULL);
+    memoria_liberar(hash->memoria, reserva.listas);
+    return reubicados;
+}
+
+/* Pasa todos los nodos a un vector nuevo de nuevo_largo posiciones. Los nodos
+ * se reenlazan (no se copia ninguna clave, no se rehashea y no se pide memoria
+ * por elemento) y se reutilizan las listas del vector viejo. Con hilos cada
+ * uno reenlaza un rango del vector nuevo.
+ * Post: Si no hay memoria devuelve false y el hash queda con el largo que tenia.
+ */
+static bool reubicar_nodos(hash_t* hash, size_t nuevo_largo) {
+    void** nuevo_vector = memoria_pedir(hash->memoria, sizeof(void*) * nuevo_largo);
+    if(!nuevo_vector) return false;
+    vector_limpiar(nuevo_vector, nuevo_largo);
+
+    if(!reubicar_en_paralelo(hash, nuevo_vector, nuevo_largo) && !reubicar_en_un_hilo(hash, nuevo_vector, nuevo_largo))
+    {
+        memoria_liberar(hash->memoria, nuevo_vector);
+        return false;
+    }
+
+    memoria_liberar(hash->memoria, hash->vector);
+    hash->vector = nuevo_vector;
+    hash->largo = nuevo_largo;
+    return true;
+}
+
+/* Migra hasta 'cantidad' posiciones del vector viejo al nuevo, reenlazando
+ * los nodos. Al terminar libera el vector viejo.
+ * Post: Si no hay memoria para una lista deja la posicion a medio migrar (sus
+ * nodos se siguen encontrando) y se reintenta en la proxima operacion.
+ */
+static void migrar_posiciones(hash_t* hash, size_t cantidad) {
+    for(size_t i = 0; i < cantidad && hash->migradas < hash->largo_viejo; i++)
+    {
+        lista_t* lista = hash->vector_viejo[hash->migradas];
+        if(lista)
+        {
+            while(!lista_esta_vacia(lista))
+            {
+                nodo_hash_t* nodo = lista_ver_primero(lista);
+                size_t posicion = posicion_en_vector(hash, nodo->codigo, hash->largo);
+
+                if(!hash->vector[posicion])
+                {
+                    hash->vector[posicion] = crear_lista(hash);
+                    if(!hash->vector[posicion]) return;
+                }
+                lista_mover_primero(lista, hash->vector[posicion]);
+            }
+            lista_destruir(lista, NULL);
+            hash->vector_viejo[hash->migradas] = NULL;
+        }
+        hash->migradas++;
+    }
+
+    if(hash->migradas < hash->largo_viejo) return;
+
+    memoria_liberar(hash->memoria, hash->vector_viejo);
+    hash->vector_viejo = NULL;
+    hash->largo_viejo = 0;
+    hash->migradas = 0;
+}
+
+/* Empieza una migracion incremental hacia un vector de nuevo_largo posiciones.
+ * Post: Si no hay memoria devuelve false y el hash queda como estaba.
+ */
+static bool empezar_migracion(hash_t* hash, size_t nuevo_largo) {
+    // Con malloc, calloc no recorre el vector para limpiarlo: en vectores
+    // grandes las paginas llegan en cero y se tocan recien al migrar.
+    void** nuevo_vector = memoria_pedir_ceros(hash->memoria, nuevo_largo, sizeof(void*));
+    if(!nuevo_vector) return false;
+
+    hash->vector_viejo = hash->vector;
+    hash->largo_viejo = hash->largo;
+    hash->migradas = 0;
+    hash->vector = nuevo_vector;
+    hash->largo = nuevo_largo;
+
+    migrar_posiciones(hash, MIGRACION_POR_OPERACION);
+    return true;
+}
+
+/* Cambia la politica de largos del hash abierto. Pide un vector nuevo con el
+ * largo inicial ajustado a la politica.
+ */
+bool hash_politica_largo(hash_t *hash, hash_largo_t politica) {
+    if(!hash || es_cerrado(hash) || hash->tam || hash->vector_viejo) return false;
+
+    // Vacio no tiene listas: vuelve a no tener vector y el proximo se pide
+    // con el largo de la politica nueva.
+    hash->politica = politica;
+    memoria_liberar(hash->memoria, hash->vector);
+    hash->vector = NULL;
+    hash->largo = 0;
+    return true;
+}
+
+/* Cambia la semilla de la funcion de hash, solo con el hash vacio */
+bool hash_elegir_semilla(hash_t *hash, uint64_t semilla) {
+    if(!hash || hash->tam || hash->vector_viejo) return false;
+    hash->semilla = semilla;
+    return true;
+}
+
+/* Activa o desactiva el desborde ordenado del hash abierto */
+bool hash_desborde_ordenado(hash_t *hash, bool activar) {
+    if(!hash || es_cerrado(hash)) return false;
+    hash->con_desborde = activar;
+    return true;
+}
+
+/* Cambia la funcion de hash, solo con el hash vacio */
+bool hash_elegir_funcion(hash_t *hash, hash_funcion_t funcion) {
+    if(!hash || !funcion || hash->tam || hash->vector_viejo) return false;
+    hash->funcion = funcion;
+    return true;
+}
+
+/* Completa las estadisticas de las listas del hash abierto */
+bool hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas) {
+    if(!hash || !estadisticas || es_cerrado(hash)) return false;
+
+    estadisticas->largo = hash->largo_viejo + hash->largo;
+    estadisticas->ocupadas = 0;
+    estadisticas->lista_mas_larga = 0;
+    estadisticas->desbordadas = hash->desborde.cantidad;
+    estadisticas->memoria = sizeof(hash_t) + hash->desborde.capacidad_trozos * sizeof(trozo_t*)
+        + hash->desborde.cantidad_trozos * sizeof(trozo_t)
+        + estadisticas->largo * sizeof(void*) + hash->claves_grandes
+        + bloques_memoria(&hash->nodos) + bloques_memoria(&hash->nodos_lista);
+    for(size_t i = 0; i < CLASES_CLAVE; i++)
+        estadisticas->memoria += bloques_memoria(&hash->claves[i]);
+
+    for(size_t i = 0; i < estadisticas->largo; i++)
+    {
+        lista_t* lista = lista_en_posicion(hash, i);
+        if(!lista) continue;
+
+        estadisticas->ocupadas++;
+        estadisticas->memoria += lista_tam();
+        size_t largo = lista_largo(lista);
+        if(largo > estadisticas->lista_mas_larga) estadisticas->lista_mas_larga = largo;
+    }
+    return true;
+}
+
+/* Deja lugar para cantidad claves sin redimensionar y no deja que el vector
+ * se achique por debajo de eso. En el hash abierto el vector queda de un
+ * largo por clave; si todavia no hay vector solo se anota el largo.
+ */
+bool hash_reservar(hash_t *hash, size_t cantidad) {
+    if(!hash) return false;
+    if(es_cerrado(hash)) return hash_cerrado_reservar(&hash->cerrado, cantidad);
+
+    size_t minimo = cantidad > hash->opciones.largo_minimo ? cantidad : hash->opciones.largo_minimo;
+    size_t largo = ajustar_largo(hash, minimo);
+    if(hash->vector && largo > hash->largo)
+    {
+        // Termina la migracion en curso para reubicar todo de una vez.
+        if(hash->vector_viejo) migrar_posiciones(hash, hash->largo_viejo);
+        if(hash->vector_viejo || !reubicar_nodos(hash, largo)) return false;
+    }
+
+    hash->largo_minimo = minimo;
+    return true;
+}
+
+/* Activa o desactiva la redimension incremental del hash abierto */
+bool hash_redimension_incremental(hash_t *hash, bool incremental) {
+    if(!hash || es_cerrado(hash)) return false;
+    hash->opciones.incremental = incremental;
+    return true;
+}
+
+/* Largo al que se lleva el vector al redimensionar: deja la carga en
+ * factor_carga_maximo / crecimiento, sin bajar de largo_minimo.
+ */
+static size_t largo_objetivo(const hash_t *hash) {
+    double objetivo = hash->opciones.factor_carga_maximo / hash->opciones.crecimiento;
+    size_t largo = (size_t)((double)hash->tam / objetivo) + 1;
+    if(largo < hash->largo_minimo) largo = hash->largo_minimo;
+    return ajustar_largo(hash, largo);
+}
+
+/* Ajustar memoria necesaria para el vector del Hash.
+ * Si hay una migracion en curso solo avanza con ella: no empieza otra
+ * redimension hasta terminarla.
+ */
+bool hash_redimensionar(hash_t* hash) {
+    if(!hash->vector) return true;
+
+    if(hash->vector_viejo)
+    {
+        migrar_posiciones(hash, MIGRACION_POR_OPERACION);
+        return true;
+    }
+
+    const hash_opciones_t* opciones = &hash->opciones;
+    double largo = (double)hash->largo;
+    bool crecer = (double)hash->tam >= largo * opciones->factor_carga_maximo;
+    bool achicar = opciones->achicar && (double)hash->tam < largo * opciones->factor_carga_minimo;
+    if(!crecer && !achicar) return true;
+
+    size_t nuevo_largo = largo_objetivo(hash);
+    if(nuevo_largo == hash->largo) return true;
+
+    if(opciones->incremental) return empezar_migracion(hash, nuevo_largo);
+    return reubicar_nodos(hash, nuevo_largo);
+}
+
+/* Achica el vector (o las ranuras) al largo objetivo */
+bool hash_compactar(hash_t *hash) {
+    if(!hash) return false;
+    if(es_cerrado(hash)) return hash_cerrado_compactar(&hash->cerrado);
+    if(!hash->vector) return true;
+
+    // Termina la migracion en curso para reubicar todo de una vez.
+    if(hash->vector_viejo) migrar_posiciones(hash, hash->largo_viejo);
+    if(hash->vector_viejo) return false;
+
+    size_t nuevo_largo = largo_objetivo(hash);
+    if(nuevo_largo >= hash->largo) return true;
+    return reubicar_nodos(hash, nuevo_largo);
+}
+
+/* Que falta hacer con un par al guardar por rangos */
+typedef enum {
+    PAR_NUEVO,              /* Va al final de la lista de su posicion, o a su rango de ranuras */
+    PAR_NUEVO_SIN_LISTA,    /* Como PAR_NUEVO, pero su posicion todavia no tiene lista */
+    PAR_DESBORDE,           /* Va al desborde */
+    PAR_REPETIDO,           /* Repite la clave de un par nuevo anterior */
+    PAR_REEMPLAZADO,        /* Ya esta guardado; su dato es el que reemplazo */
+    PAR_DIFERIDO,           /* No entro en su rango: es la ranura que falta colocar */
+    PAR_PENDIENTE           /* Se guarda al final, de a uno */
+} par_estado_t;
+
+/* Par de hash_guardar_lote ya hasheado, con la posicion que le toca */
+typedef struct par_lote {
+    clave_hash_t clave;
+    void* dato;
+    size_t posicion;
+    par_estado_t estado;                    /* Lo que sigue, solo al guardar por rangos */
+    void* guardado;                         /* Nodo o copia de la clave; en el repetido, el par anterior */
+    lista_t* lista;                         /* Lista nueva del PAR_NUEVO_SIN_LISTA */
+} par_lote_t;
+
+/* Agranda el hash una sola vez para que entren cantidad claves mas, sin
+ * cambiar el largo minimo (no es una reserva).
+ * Post: Devuelve false si no hubo memoria, y el hash queda como estaba.
+ */
+static bool agrandar_para(hash_t *hash, size_t cantidad) {
+    size_t total = hash->tam + cantidad;
+    if(es_cerrado(hash)) return hash_cerrado_agrandar(&hash->cerrado, total);
+    if(total <= CANTIDAD_CHICA) return true;
+    if(!hash->vector && !pasar_a_vector(hash)) return false;
+
+    // Una posicion por clave, como hash_reservar.
+    size_t largo = ajustar_largo(hash, total > hash->largo_minimo ? total : hash->largo_minimo);
+    if(largo <= hash->largo) return true;
+
+    // Termina la migracion en curso para reubicar todo de una vez.
+    if(hash->vector_viejo) migrar_posiciones(hash, hash->largo_viejo);
+    return !hash->vector_viejo && reubicar_nodos(hash, largo);
+}
+
+/* Devuelve la posicion donde se va a guardar la clave, o 0 si el hash
+ * abierto todavia no tiene vector.
+ */
+static size_t posicion_de_carga(const hash_t *hash, uint32_t codigo) {
+    if(es_cerrado(hash)) return hash_cerrado_posicion(&hash->cerrado, codigo);
+    return hash->vector ? posicion_en_vector(hash, codigo, hash->largo) : 0;
+}
+
+/* Ordena los pares por posicion de a BITS_RADIX bits, usando auxiliar (del
+ * mismo largo) como destino intermedio. Es estable.
+ */
+static void ordenar_por_posicion(par_lote_t *pares, par_lote_t *auxiliar, size_t cantidad) {
+    size_t maxima = 0;
+    for(size_t i = 0; i < cantidad; i++)
+        if(pares[i].posicion > maxima) maxima = pares[i].posicion;
+
+    par_lote_t* origen = pares;
+    par_lote_t* destino = auxiliar;
+    for(unsigned corrimiento = 0; corrimiento < sizeof(size_t) * 8 && (maxima >> corrimiento); corrimiento += BITS_RADIX)
+    {
+        size_t cuentas[1 << BITS_RADIX] = { 0 };
+        size_t mascara = ((size_t) 1 << BITS_RADIX) - 1;
+
+        for(size_t i = 0; i < cantidad; i++)
+            cuentas[(origen[i].posicion >> corrimiento) & mascara]++;
+        size_t acumulado = 0;
+        for(size_t d = 0; d <= mascara; d++)
+        {
+            size_t cuenta = cuentas[d];
+            cuentas[d] = acumulado;
+            acumulado += cuenta;
+        }
+        for(size_t i = 0; i < cantidad; i++)
+            destino[cuentas[(origen[i].posicion >> corrimiento) & mascara]++] = origen[i];
+
+        par_lote_t* aux = origen;
+        origen = destino;
+        destino = aux;
+    }
+    if(origen != pares) memcpy(pares, origen, sizeof(par_lote_t) * cantidad);
+}
+
+/* Tramo de pares que se ordena en paralelo. Los pares se dividen en partes
+ * (por orden de llegada) y las posiciones en grupos de ancho posiciones.
+ */
+typedef struct carga_paralela {
+    const hash_t* hash;
+    const char* const* claves;
+    void* const* datos;
+    size_t cantidad;
+    par_lote_t* pares;                      /* pares[i] es claves[i]; clave NULL si no hay */
+    par_lote_t* auxiliar;                   /* Los pares validos repartidos por grupo */
+    size_t partes;
+    size_t grupos;
+    size_t ancho;
+    size_t* maximas;                        /* Mayor posicion de cada parte */
+    size_t* cuentas;                        /* [parte * grupos + grupo]: pares, despues donde van */
+    size_t* inicios;                        /* Primer par de cada grupo en auxiliar, y el final */
+} carga_paralela_t;
+
+/* Devuelve el primer par de una parte: la parte termina donde empieza la
+ * siguiente.
+ */
+static size_t inicio_de_tramo(const carga_paralela_t* carga, size_t parte) {
+    return inicio_de(carga->cantidad, parte, carga->partes);
+}
+
+/* Hashea los pares de una parte y anota su mayor posicion */
+static void hashear_parte(void* extra, size_t parte) {
+    carga_paralela_t* carga = extra;
+    size_t maxima = 0;
+    for(size_t i = inicio_de_tramo(carga, parte); i < inicio_de_tramo(carga, parte + 1); i++)
+    {
+        par_lote_t* par = &carga->pares[i];
+        par->clave.clave = NULL;
+        if(!carga->claves[i]) continue;
+
+        par->clave = hashear(carga->hash, carga->claves[i], strlen(carga->claves[i]));
+        par->dato = carga->datos ? carga->datos[i] : NULL;
+        par->posicion = posicion_de_carga(carga->hash, par->clave.codigo);
+        if(par->posicion > maxima) maxima = par->posicion;
+    }
+    carga->maximas[parte] = maxima;
+}
+
+/* Cuenta los pares validos de una parte que caen en cada grupo */
+static void contar_tramo(void* extra, size_t parte) {
+    carga_paralela_t* carga = extra;
+    size_t* cuentas = &carga->cuentas[parte * carga->grupos];
+    for(size_t grupo = 0; grupo < carga->grupos; grupo++)
+        cuentas[grupo] = 0;
+    for(size_t i = inicio_de_tramo(carga, parte); i < inicio_de_tramo(carga, parte + 1); i++)
+        if(carga->pares[i].clave.clave) cuentas[carga->pares[i].posicion / carga->ancho]++;
+}
+
+/* Copia los pares validos de una parte a su lugar dentro de cada grupo */
+static void repartir_tramo(void* extra, size_t parte) {
+    carga_paralela_t* carga = extra;
+    size_t* destinos = &carga->cuentas[parte * carga->grupos];
+    for(size_t i = inicio_de_tramo(carga, parte); i < inicio_de_tramo(carga, parte + 1); i++)
+        if(carga->pares[i].clave.clave)
+            carga->auxiliar[destinos[carga->pares[i].posicion / carga->ancho]++] = carga->pares[i];
+}
+
+/* Ordena por posicion los pares de un grupo, dejandolos en auxiliar */
+static void ordenar_grupo(void* extra, size_t grupo) {
+    carga_paralela_t* carga = extra;
+    size_t inicio = carga->inicios[grupo];
+    ordenar_por_posicion(carga->auxiliar + inicio, carga->pares + inicio, carga->inicios[grupo + 1] - inicio);
+}
+
+/* Hashea y ordena por posicion un tramo de pares repartiendo el trabajo
+ * entre los hilos del hash. Deja en auxiliar los pares validos (sin las
+ * claves NULL) en el mismo orden que ordenar_por_posicion, y su cantidad en
+ * validos.
+ * Post: Devuelve false, sin tocar nada, si no hay hilos o no hubo memoria.
+ */
+static bool ordenar_en_paralelo(hash_t *hash, const char *const claves[], void *const datos[], size_t cantidad,
+                                par_lote_t *pares, par_lote_t *auxiliar, size_t *validos) {
+    hilos_t* hilos = hilos_para(hash, cantidad);
+    if(!hilos) return false;
+
+    size_t partes = hilos_cantidad(hilos) * PARTES_POR_HILO;
+    size_t* cuentas = memoria_pedir(hash->memoria, sizeof(size_t) * (partes * partes + 2 * partes + 1));
+    if(!cuentas) return false;
+
+    carga_paralela_t carga = { hash, claves, datos, cantidad, pares, auxiliar, partes, partes, 1,
+                               cuentas + partes * partes, cuentas, cuentas + partes * partes + partes };
+
+    // 1 - Hashea y busca la mayor posicion, para repartirlas en grupos.
+    hilos_ejecutar(hilos, hashear_parte, &carga, partes);
+    size_t maxima = 0;
+    for(size_t parte = 0; parte < partes; parte++)
+        if(carga.maximas[parte] > maxima) maxima = carga.maximas[parte];
+    carga.ancho = maxima / carga.grupos + 1;
+
+    // 2 - Cuenta y reparte por grupo. Dentro de un grupo van primero los
+    //     pares de la primera parte, asi se mantiene el orden recibido.
+    hilos_ejecutar(hilos, contar_tramo, &carga, partes);
+    size_t total = 0;
+    for(size_t grupo = 0; grupo < carga.grupos; grupo++)
+    {
+        carga.inicios[grupo] = total;
+        for(size_t parte = 0; parte < partes; parte++)
+        {
+            size_t* cuenta = &carga.cuentas[parte * carga.grupos + grupo];
+            size_t pares_en_parte = *cuenta;
+            *cuenta = total;
+            total += pares_en_parte;
+        }
+    }
+    carga.inicios[carga.grupos] = total;
+    hilos_ejecutar(hilos, repartir_tramo, &carga, partes);
+
+    // 3 - Ordena cada grupo. Los grupos ya estan ordenados entre si.
+    hilos_ejecutar(hilos, ordenar_grupo, &carga, carga.grupos);
+
+    memoria_liberar(hash->memoria, cuentas);
+    *validos = total;
+    return true;
+}
+
+/* Guardado por rangos: los pares ya ordenados se reparten en RANGOS_GUARDADO
+ * rangos de posiciones del hash que no se pisan. Los hilos buscan las claves
+ * y despues cada uno enlaza (o coloca) los pares nuevos de su rango, sin
+ * cerrojos; los nodos, las listas y las copias de las claves se piden en el
+ * medio, en un solo hilo, porque las reservas son de todo el hash.
+ */
+typedef struct guardado_rangos {
+    hash_t* hash;
+    par_lote_t* pares;
+    size_t ancho;                           /* Posiciones de cada rango */
+    size_t nuevos;                          /* Cerrado: claves nuevas preparadas */
+    size_t inicios[RANGOS_GUARDADO + 1];    /* Primer par de cada rango, y el final */
+    lista_t* nodos[RANGOS_GUARDADO];        /* Abierto: nodos nuevos de cada rango, en orden */
+    size_t lapidas[RANGOS_GUARDADO];        /* Cerrado: lapidas reutilizadas en cada rango */
+} guardado_rangos_t;
+
+/* Devuelve el primer par ordenado con posicion mayor o igual a la pedida */
+static size_t primer_par(const par_lote_t *pares, size_t cantidad, size_t posicion) {
+    size_t desde = 0, hasta = cantidad;
+    while(desde < hasta)
+    {
+        size_t medio = desde + (hasta - desde) / 2;
+        if(pares[medio].posicion < posicion) desde = medio + 1;
+        else hasta = medio;
+    }
+    return desde;
+}
+
+/* Devuelve si dos claves hasheadas son iguales */
+static bool misma_clave(const clave_hash_t *clave1, const clave_hash_t *clave2) {
+    return clave1->codigo == clave2->codigo && clave1->largo == clave2->largo && memcmp(clave1->clave, clave2->clave, clave1->largo) == 0;
+}
+
+/* Clasifica el par i, cuya clave no esta en el hash, mirando los pares
+ * anteriores de su posicion (estan justo antes). Con mas de VECINOS_LOTE
+ * queda pendiente, y tambien todos los que siguen en esa posicion.
+ */
+static par_estado_t estado_de_nuevo(const guardado_rangos_t *guardado, size_t i, size_t inicio) {
+    const hash_t* hash = guardado->hash;
+    par_lote_t* par = &guardado->pares[i];
+    size_t en_lista = 0, vecinos = 0;
+
+    for(size_t j = i; j > inicio && guardado->pares[j - 1].posicion == par->posicion; j--)
+    {
+        par_lote_t* vecino = &guardado->pares[j - 1];
+        if(++vecinos > VECINOS_LOTE || vecino->estado == PAR_PENDIENTE) return PAR_PENDIENTE;
+        if(vecino->estado == PAR_REEMPLAZADO || vecino->estado == PAR_REPETIDO) continue;
+        if(misma_clave(&vecino->clave, &par->clave))
+        {
+            par->guardado = vecino;
+            return PAR_REPETIDO;
+        }
+        if(vecino->estado != PAR_DESBORDE) en_lista++;
+    }
+    if(es_cerrado(hash)) return PAR_NUEVO;
+
+    // Lo mismo que decide insertar_nodo cuando le llegue el turno.
+    lista_t* lista = hash->vector[par->posicion];
+    if(lista) en_lista += lista_largo(lista);
+    if(hash->con_desborde && en_lista >= LARGO_MAXIMO_LISTA) return PAR_DESBORDE;
+    return en_lista || lista ? PAR_NUEVO : PAR_NUEVO_SIN_LISTA;
+}
+
+/* Busca las claves de los pares de un rango. Las que ya estan se guardan
+ * ahi mismo (solo cambia el dato de su nodo o ranura); las demas se
+ * clasifican. No pide memoria.
+ */
+static void buscar_rango(void* extra, size_t rango) {
+    guardado_rangos_t* guardado = extra;
+    hash_t* hash = guardado->hash;
+    size_t inicio = guardado->inicios[rango];
+
+    for(size_t i = inicio; i < guardado->inicios[rango + 1]; i++)
+    {
+        par_lote_t* par = &guardado->pares[i];
+        void** lugar = NULL;
+        if(es_cerrado(hash))
+        {
+            ranura_t* ranura = buscar_ranura(hash, &par->clave);
+            if(ranura) lugar = &ranura->dato;
+        }
+        else
+        {
+            nodo_hash_t* nodo = buscar_nodo(hash, &par->clave);
+            if(nodo) lugar = &nodo->dato;
+        }
+
+        if(!lugar)
+        {
+            par->estado = estado_de_nuevo(guardado, i, inicio);
+            continue;
+        }
+        void* anterior = *lugar;
+        *lugar = par->dato;
+        par->dato = anterior;
+        par->estado = PAR_REEMPLAZADO;
+    }
+}
+
+/* Pide lo que necesita un par nuevo: la copia de la clave en el cerrado; el
+ * nodo (y la lista si su posicion no tiene) en el abierto, que queda en los
+ * nodos del rango o, si va al desborde, ya guardado.
+ * Post: Devuelve false si no hubo memoria, sin pedir nada.
+ */
+static bool preparar_nuevo(guardado_rangos_t *guardado, par_lote_t *par, size_t rango) {
+    hash_t* hash = guardado->hash;
+    if(es_cerrado(hash))
+    {
+        if(!(par->guardado = copiar_clave(hash, &par->clave))) return false;
+        guardado->nuevos++;
+        hash->tam++;
+        return true;
+    }
+
+    par->lista = NULL;
+    if(par->estado == PAR_NUEVO_SIN_LISTA && !(par->lista = crear_lista(hash))) return false;
+    nodo_hash_t* nodo = crear_nodo(hash, &par->clave, par->dato);
+    bool guardados = nodo && (par->estado == PAR_DESBORDE ? desborde_insertar(&hash->desborde, nodo, hash->memoria)
+                                                         : lista_insertar_ultimo(guardado->nodos[rango], nodo));
+    if(!guardados)
+    {
+        if(nodo) liberar_nodo(hash, nodo);
+        if(par->lista) lista_destruir(par->lista, NULL);
+        return false;
+    }
+    par->guardado = nodo;
+    hash->tam++;
+    return true;
+}
+
+/* Recorre los pares en orden pidiendo lo de los nuevos, pasando el dato de
+ * los repetidos al par anterior y destruyendo los datos reemplazados. Desde
+ * que falta memoria los que faltan guardar quedan pendientes.
+ */
+static void preparar_pares(guardado_rangos_t *guardado) {
+    hash_t* hash = guardado->hash;
+    bool sin_memoria = false;
+
+    for(size_t rango = 0; rango < RANGOS_GUARDADO; rango++)
+    {
+        for(size_t i = guardado->inicios[rango]; i < guardado->inicios[rango + 1]; i++)
+        {
+            par_lote_t* par = &guardado->pares[i];
+            if(par->estado == PAR_REPETIDO && !sin_memoria)
+            {
+                par_lote_t* anterior = par->guardado;
+                void** lugar = es_cerrado(hash) ? &anterior->dato : &((nodo_hash_t*) anterior->guardado)->dato;
+                void* reemplazado = *lugar;
+                *lugar = par->dato;
+                par->dato = reemplazado;
+                par->estado = PAR_REEMPLAZADO;
+            }
+
+            if(par->estado == PAR_REEMPLAZADO)
+            {
+                if(hash->destruir_dato) hash->destruir_dato(par->dato);
+                continue;
+            }
+            if(par->estado == PAR_PENDIENTE) continue;
+
+            sin_memoria = sin_memoria || !preparar_nuevo(guardado, par, rango);
+            if(sin_memoria) par->estado = PAR_PENDIENTE;
+        }
+    }
+}
+
+/* Pasa los nodos nuevos de un rango del abierto a sus listas */
+static void enlazar_rango(void* extra, size_t rango) {
+    guardado_rangos_t* guardado = extra;
+    void** vector = guardado->hash->vector;
+
+    for(size_t i = guardado->inicios[rango]; i < guardado->inicios[rango + 1]; i++)
+    {
+        par_lote_t* par = &guardado->pares[i];
+        if(par->estado != PAR_NUEVO && par->estado != PAR_NUEVO_SIN_LISTA) continue;
+
+        if(par->estado == PAR_NUEVO_SIN_LISTA) vector[par->posicion] = par->lista;
+        lista_mover_primero(guardado->nodos[rango], vector[par->posicion]);
+    }
+}
+
+/* Coloca las ranuras nuevas de un rango del cerrado. Las que no entran antes
+ * del fin del rango quedan diferidas en su par.
+ */
+static void colocar_rango(void* extra, size_t rango) {
+    guardado_rangos_t* guardado = extra;
+    hash_cerrado_t* cerrado = &guardado->hash->cerrado;
+    size_t fin = (rango + 1) * guardado->ancho;
+    size_t lapidas = 0;
+
+    for(size_t i = guardado->inicios[rango]; i < guardado->inicios[rango + 1]; i++)
+    {
+        par_lote_t* par = &guardado->pares[i];
+        if(par->estado != PAR_NUEVO) continue;
+
+        ranura_t nueva = { par->guardado, par->dato, par->clave.largo, par->clave.codigo };
+        if(hash_cerrado_colocar_en_rango(cerrado, &nueva, fin, &lapidas)) continue;
+
+        par->estado = PAR_DIFERIDO;
+        par->guardado = nueva.clave;
+        par->dato = nueva.dato;
+        par->clave.largo = nueva.largo;
+        par->clave.codigo = nueva.codigo;
+    }
+    guardado->lapidas[rango] = lapidas;
+}
+
+/* Guarda los pares ordenados por rangos de posiciones, repartiendo los rangos
+ * entre los hilos del hash. En el abierto queda igual que guardandolos de a
+ * uno; en el cerrado las ranuras que se corren de su rango se colocan al
+ * final, asi que se usa con y sin hilos para que el resultado sea el mismo.
+ * Post: Devuelve false, sin guardar nada, si no corresponde o no hubo
+ * memoria; si no, en todos queda si se guardaron todos.
+ */
+static bool guardar_por_rangos(hash_t *hash, par_lote_t *pares, size_t validos, bool *todos) {
+    if(validos < MINIMO_PARALELO) return false;
+    if(es_cerrado(hash) ? !hash_cerrado_hay_lugar(&hash->cerrado, validos)
+                        : !hash->vector || hash->vector_viejo || !hilos_para(hash, validos)) return false;
+
+    guardado_rangos_t guardado = { hash, pares, 0, 0, { 0 }, { NULL }, { 0 } };
+    size_t largo = es_cerrado(hash) ? hash->cerrado.capacidad : hash->largo;
+    guardado.ancho = es_cerrado(hash) ? largo / RANGOS_GUARDADO : largo / RANGOS_GUARDADO + 1;
+
+    size_t creadas = 0;
+    while(!es_cerrado(hash) && creadas < RANGOS_GUARDADO && (guardado.nodos[creadas] = crear_lista(hash)))
+        creadas++;
+    if(!es_cerrado(hash) && creadas < RANGOS_GUARDADO)
+    {
+        while(creadas) lista_destruir(guardado.nodos[--creadas], NULL);
+        return false;
+    }
+
+    for(size_t rango = 0; rango < RANGOS_GUARDADO; rango++)
+        guardado.inicios[rango] = primer_par(pares, validos, rango * guardado.ancho);
+    guardado.inicios[RANGOS_GUARDADO] = validos;
+
+    // 1 - Busca en paralelo; 2 - pide la memoria en orden; 3 - guarda en paralelo.
+    hilos_t* hilos = hilos_para(hash, validos);
+    hilos_ejecutar(hilos, buscar_rango, &guardado, RANGOS_GUARDADO);
+    preparar_pares(&guardado);
+    hilos_ejecutar(hilos, es_cerrado(hash) ? colocar_rango : enlazar_rango, &guardado, RANGOS_GUARDADO);
+
+    // 4 - En orden, las ranuras diferidas y los pares pendientes.
+    if(es_cerrado(hash))
+    {
+        size_t lapidas = 0;
+        for(size_t rango = 0; rango < RANGOS_GUARDADO; rango++)
+            lapidas += guardado.lapidas[rango];
+        hash_cerrado_contar_colocadas(&hash->cerrado, guardado.nuevos, lapidas);
+
+        for(size_t i = 0; i < validos; i++)
+        {
+            if(pares[i].estado != PAR_DIFERIDO) continue;
+            ranura_t diferida = { pares[i].guardado, pares[i].dato, pares[i].clave.largo, pares[i].clave.codigo };
+            hash_cerrado_colocar(&hash->cerrado, diferida);
+        }
+    }
+    for(size_t i = 0; i < validos; i++)
+        if(pares[i].estado == PAR_PENDIENTE) *todos &= guardar_hasheada(hash, &pares[i].clave, pares[i].dato);
+
+    for(size_t rango = 0; rango < creadas; rango++)
+        lista_destruir(guardado.nodos[rango], NULL);
+    return true;
+}
+
+/* Guarda un tramo de pares: los hashea, los ordena por posicion si hay
+ * donde (pares no es NULL) y los guarda en ese orden. Sin memoria para
+ * ordenar los guarda en el orden recibido.
+ * Post: Devuelve false si alguna clave es NULL o no hubo memoria para
+ * guardarla; sigue con las demas.
+ */
+static bool guardar_tramo(hash_t *hash, const char *const claves[], void *const datos[], size_t cantidad, par_lote_t *pares, par_lote_t *auxiliar) {
+    bool todos = true;
+
+    if(!pares)
+    {
+        for(size_t i = 0; i < cantidad; i++)
+            todos &= claves[i] && hash_guardar(hash, claves[i], datos ? datos[i] : NULL);
+        return todos;
+    }
+
+    size_t validos = 0;
+    par_lote_t* ordenados = auxiliar;
+    if(!ordenar_en_paralelo(hash, claves, datos, cantidad, pares, auxiliar, &validos))
+    {
+        ordenados = pares;
+        for(size_t i = 0; i < cantidad; i++)
+        {
+            if(!claves[i]) continue;
+            par_lote_t* par = &pares[validos++];
+            par->clave = hashear(hash, claves[i], strlen(claves[i]));
+            par->dato = datos ? datos[i] : NULL;
+            par->posicion = posicion_de_carga(hash, par->clave.codigo);
+        }
+        ordenar_por_posicion(pares, auxiliar, validos);
+    }
+
+    todos = validos == cantidad;
+    if(guardar_por_rangos(hash, ordenados, validos, &todos)) return todos;
+    for(size_t i = 0; i < validos; i++)
+        todos &= guardar_hasheada(hash, &ordenados[i].clave, ordenados[i].dato);
+    return todos;
+}
+
+/* Guarda cantidad pares agrandando el hash una sola vez */
+bool hash_guardar_lote(hash_t *hash, const char *const claves[], void *const datos[], size_t cantidad) {
+    if(!hash || (!claves && cantidad)) return false;
+    if(!cantidad) return true;
+    if(!agrandar_para(hash, cantidad)) return false;
+
+    // Mientras dura el lote el vector recien agrandado no se achica.
+    size_t largo_minimo = hash->largo_minimo;
+    if(!es_cerrado(hash) && hash->largo > largo_minimo) hash->largo_minimo = hash->largo;
+
+    size_t tramo = cantidad < TRAMO_CARGA ? cantidad : TRAMO_CARGA;
+    par_lote_t* pares = memoria_pedir(hash->memoria, 2 * tramo * sizeof(par_lote_t));
+
+    bool todos = true;
+    for(size_t i = 0; i < cantidad; i += tramo)
+    {
+        size_t largo = cantidad - i < tramo ? cantidad - i : tramo;
+        todos &= guardar_tramo(hash, claves + i, datos ? datos + i : NULL, largo, pares, pares ? pares + tramo : NULL);
+    }
+
+    memoria_liberar(hash->memoria, pares);
+    hash->largo_minimo = largo_minimo;
+    return todos;
+}
+
+/* Crea el Hash con las opciones recibidas y le carga los pares */
+hash_t *hash_crear_con_lote(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones,
+                            const char *const claves[], void *const datos[], size_t cantidad) {
+    hash_t* hash = hash_crear_con_opciones(destruir_dato, opciones);
+    if(!hash) return NULL;
+
+    if(!hash_guardar_lote(hash, claves, datos, cantidad))
+    {
+        // Los datos siguen siendo del usuario.
+        hash->destruir_dato = NULL;
+        hash_destruir(hash);
+        return NULL;
+    }
+    return hash;
 }
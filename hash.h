@@ -3,6 +3,9 @@
 
 #include <stdbool.h>
 #include <stddef.h>
+#include <stdint.h>
+
+#include "memoria.h"
 
 // Los structs deben llamarse "hash" y "hash_iter".
 struct hash;
@@ -14,9 +17,163 @@ typedef struct hash_iter hash_iter_t;
 // tipo de función para destruir dato
 typedef void (*hash_destruir_dato_t)(void *);
 
+// Motores de almacenamiento disponibles
+typedef enum {
+    HASH_ABIERTO,               // Una lista por posicion del vector (por defecto)
+    HASH_CERRADO_LINEAL,        // Ranuras contiguas con sondeo lineal
+    HASH_CERRADO_ROBIN_HOOD,    // Ranuras contiguas con sondeo Robin Hood
+    HASH_CERRADO_GRUPOS         // Ranuras contiguas con bytes de control comparados con SIMD
+} hash_tipo_t;
+
+// Funcion para hash_actualizar: recibe el dato guardado (NULL si la clave es
+// nueva) y devuelve el que lo reemplaza
+typedef void *(*hash_actualizar_t)(void *dato, void *extra);
+
+// Funcion de hash: devuelve el hash de los 'largo' bytes de clave
+typedef uint64_t (*hash_funcion_t)(const void *clave, size_t largo, uint64_t semilla);
+
+// Allocator para hash_crear_con_allocator: pedir es como malloc y liberar
+// como free, los dos reciben contexto como primer parametro.
+typedef memoria_t hash_allocator_t;
+
+// Opciones para hash_crear_con_opciones. Se completan con
+// hash_opciones_por_defecto (valores entre parentesis) y se cambia lo que
+// haga falta.
+// Redimension del hash abierto: crece cuando la carga (claves por posicion)
+// llega a factor_carga_maximo y se achica cuando baja de factor_carga_minimo.
+// Despues de redimensionar la carga queda en factor_carga_maximo / crecimiento,
+// que debe ser mayor que factor_carga_minimo: asi hacen falta muchas
+// operaciones para volver a redimensionar. El hash cerrado tiene sus propios
+// factores de carga; de estos solo usa achicar.
+// Con hilos mayor que 1 la carga por lotes y la redimension que reubica todo
+// el vector se reparten entre esos hilos (que se crean con malloc la primera
+// vez que hacen falta); el resultado es el mismo que con uno solo. La
+// funcion de hash se llama desde todos a la vez.
+typedef struct hash_opciones {
+    hash_tipo_t tipo;                   // Motor de almacenamiento (HASH_ABIERTO)
+    size_t capacidad;                   // Claves que entran sin redimensionar, ver hash_reservar (0)
+    const hash_allocator_t* allocator;  // De donde sale la memoria (NULL, malloc)
+    bool incremental;                   // Redimension incremental (false)
+    double factor_carga_maximo;         // Mayor que 0 (2.5)
+    double factor_carga_minimo;         // Menor que maximo / crecimiento (0.25)
+    double crecimiento;                 // Mayor que 1 (4)
+    size_t largo_minimo;                // Posiciones minimas del vector, mayor que 0 (773)
+    bool achicar;                       // Se achica solo al borrar (true); si no, con hash_compactar
+    size_t hilos;                       // Hilos para cargar lotes y reubicar, mayor que 0 (1)
+} hash_opciones_t;
+
+// Politicas para el largo del vector del hash abierto
+typedef enum {
+    HASH_LARGO_MODULO,          // Largo cualquiera, posicion con el resto de la division (por defecto)
+    HASH_LARGO_POTENCIA_DE_2,   // Largo potencia de 2, posicion con una mascara sobre el codigo mezclado
+    HASH_LARGO_MULTIPLICATIVO   // Largo cualquiera, posicion con multiplicacion y corrimiento
+} hash_largo_t;
+
+// Estadisticas de como se reparten las claves en el hash abierto y cuanta memoria usa
+typedef struct hash_estadisticas {
+    size_t largo;               // Posiciones del vector (de los dos, durante una migracion)
+    size_t ocupadas;            // Posiciones con al menos una clave
+    size_t lista_mas_larga;     // Claves en la posicion mas cargada
+    size_t desbordadas;         // Claves en el desborde ordenado
+    size_t memoria;             // Bytes pedidos por el hash (sin contar los datos)
+} hash_estadisticas_t;
+
 /* Crea el hash */
 hash_t *hash_crear(hash_destruir_dato_t destruir_dato);
 
+/* Crea el hash usando el motor de almacenamiento indicado. Los tipos
+ * HASH_CERRADO_* guardan claves, codigos y datos en un arreglo contiguo.
+ */
+hash_t *hash_crear_tipo(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo);
+
+/* Crea el hash pidiendo al allocator toda su memoria: la estructura, los
+ * vectores, las listas y sus nodos, las claves y los iteradores. Con NULL
+ * usa malloc y free. El allocator se copia; contexto debe seguir valido
+ * hasta destruir el hash.
+ * Post: Devuelve NULL si no hubo memoria o si falta pedir o liberar.
+ */
+hash_t *hash_crear_con_allocator(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, const hash_allocator_t *allocator);
+
+/* Completa opciones con los valores por defecto */
+void hash_opciones_por_defecto(hash_opciones_t *opciones);
+
+/* Crea el hash con las opciones indicadas (NULL para las por defecto). El
+ * resto de los hash_crear* son atajos para esta.
+ * Post: Devuelve NULL si no hubo memoria o si las opciones no son validas.
+ */
+hash_t *hash_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones);
+
+/* Achica el hash hasta el tamaño que le daria una redimension automatica,
+ * sin bajar del largo minimo ni de lo reservado. Sirve sobre todo con
+ * achicar en false.
+ * Post: Devuelve false si no hubo memoria, y el hash queda como estaba.
+ */
+bool hash_compactar(hash_t *hash);
+
+/* Crea el hash del tipo indicado con lugar para capacidad claves (ver
+ * hash_reservar).
+ * Post: Devuelve NULL si no hubo memoria.
+ */
+hash_t *hash_crear_con_capacidad(hash_destruir_dato_t destruir_dato, hash_tipo_t tipo, size_t capacidad);
+
+/* Prepara el hash para guardar cantidad claves sin redimensionar: agranda el
+ * vector (o las ranuras) una sola vez si hace falta. Ademas, al borrar no se
+ * achica por debajo de ese tamaño; la ultima reserva reemplaza a las
+ * anteriores.
+ * Post: Devuelve false si no hubo memoria, y el hash queda como estaba.
+ */
+bool hash_reservar(hash_t *hash, size_t cantidad);
+
+/* Activa o desactiva la redimension incremental (solo HASH_ABIERTO). Con ella
+ * el hash no reubica todos los elementos en una sola operacion: mantiene el
+ * vector viejo y el nuevo a la vez y migra unas pocas posiciones en cada
+ * guardar o borrar, asi ninguna operacion tarda mucho mas que las demas.
+ * Post: Devuelve false si el tipo de hash no la admite.
+ */
+bool hash_redimension_incremental(hash_t *hash, bool incremental);
+
+/* Elige la politica de largos del vector (solo HASH_ABIERTO). La del resto
+ * necesita una division por operacion; la de potencias de 2 la reemplaza por
+ * una mascara y la multiplicativa por una multiplicacion.
+ * Pre: El hash esta vacio.
+ * Post: Devuelve false si el hash no esta vacio, no es HASH_ABIERTO o no hubo
+ * memoria; en ese caso conserva la politica que tenia.
+ */
+bool hash_politica_largo(hash_t *hash, hash_largo_t politica);
+
+/* Funciones de hash incluidas. La rapida (por defecto) es de 64 bits, lee de
+ * a 8 bytes y usa SIMD para las claves largas; lookup3 queda por
+ * compatibilidad con versiones anteriores.
+ */
+uint64_t hash_funcion_rapida(const void *clave, size_t largo, uint64_t semilla);
+uint64_t hash_funcion_lookup3(const void *clave, size_t largo, uint64_t semilla);
+
+/* Cambia la funcion de hash (cualquier tipo de hash).
+ * Pre: El hash esta vacio.
+ * Post: Devuelve false si el hash no esta vacio o funcion es NULL.
+ */
+bool hash_elegir_funcion(hash_t *hash, hash_funcion_t funcion);
+
+/* Cambia la semilla de la funcion de hash. Cada hash nace con una semilla al
+ * azar; fijarla solo sirve para poder repetir un resultado.
+ * Pre: El hash esta vacio.
+ * Post: Devuelve false si el hash no esta vacio.
+ */
+bool hash_elegir_semilla(hash_t *hash, uint64_t semilla);
+
+/* Activa o desactiva el desborde ordenado (solo HASH_ABIERTO, activado por
+ * defecto). Con el, cuando la lista de una posicion se llena las claves
+ * nuevas van a un arreglo ordenado donde se buscan con busqueda binaria, asi
+ * muchas claves con el mismo codigo no hacen lineal cada operacion.
+ * Post: Devuelve false si el tipo de hash no lo admite.
+ */
+bool hash_desborde_ordenado(hash_t *hash, bool activar);
+
+/* Completa estadisticas con el reparto de las claves (solo HASH_ABIERTO).
+ * Post: Devuelve false si el tipo de hash no las tiene.
+ */
+bool hash_estadisticas(const hash_t *hash, hash_estadisticas_t *estadisticas);
+
 /* Guarda un elemento en el hash, si la clave ya se encuentra en la
  * estructura, la reemplaza. De no poder guardarlo devuelve false.
  * Pre: La estructura hash fue inicializada
@@ -43,6 +200,80 @@ void *hash_obtener(const hash_t *hash, const char *clave);
  */
 bool hash_pertenece(const hash_t *hash, const char *clave);
 
+/* Busca la clave y, si no esta, la guarda con dato NULL; con un solo calculo
+ * del hash y un solo recorrido. Deja en dato la direccion donde el hash
+ * guarda el dato de la clave, para leerlo o cambiarlo sin volver a buscar, y
+ * en insertado (si no es NULL) si la clave es nueva. En el hash abierto la
+ * direccion vale hasta que se borre la clave; en el cerrado, solo hasta la
+ * proxima vez que se guarde o borre una clave.
+ * Post: Devuelve false si no hubo memoria.
+ */
+bool hash_obtener_o_insertar(hash_t *hash, const char *clave, void ***dato, bool *insertado);
+
+/* Reemplaza el dato de la clave por actualizar(dato, extra), guardando la
+ * clave si no estaba (actualizar recibe NULL). Hace una sola busqueda. No
+ * llama a destruir_dato con el dato anterior: eso queda para actualizar.
+ * Post: Devuelve false si no hubo memoria.
+ */
+bool hash_actualizar(hash_t *hash, const char *clave, hash_actualizar_t actualizar, void *extra);
+
+/* Versiones de guardar, borrar, obtener y pertenece que reciben el largo de
+ * la clave. No recorren la clave buscando el '\0', por lo que no hace falta
+ * que termine en '\0' y puede tener '\0' en el medio: "a\0b" (largo 3) y
+ * "a" (largo 1) son claves distintas. La clave de hash_guardar("a", ...) es
+ * la misma que la de hash_guardar_n("a", 1, ...).
+ */
+bool hash_guardar_n(hash_t *hash, const char *clave, size_t largo, void *dato);
+void *hash_borrar_n(hash_t *hash, const char *clave, size_t largo);
+void *hash_obtener_n(const hash_t *hash, const char *clave, size_t largo);
+bool hash_pertenece_n(const hash_t *hash, const char *clave, size_t largo);
+
+/* Devuelve el codigo de la clave con la funcion y la semilla del hash, el
+ * que calculan internamente las operaciones de arriba.
+ */
+uint64_t hash_codigo(const hash_t *hash, const char *clave, size_t largo);
+
+/* Versiones que reciben ademas el codigo de la clave, para quien ya lo
+ * calculo (por ejemplo para elegir entre varios hash) y no quiere que se
+ * vuelva a calcular. El codigo tiene que ser el de hash_codigo con este
+ * hash: con otro la clave no se encuentra.
+ */
+bool hash_guardar_hasheada(hash_t *hash, const char *clave, size_t largo, uint64_t codigo, void *dato);
+void *hash_borrar_hasheada(hash_t *hash, const char *clave, size_t largo, uint64_t codigo);
+void *hash_obtener_hasheada(const hash_t *hash, const char *clave, size_t largo, uint64_t codigo);
+bool hash_pertenece_hasheada(const hash_t *hash, const char *clave, size_t largo, uint64_t codigo);
+bool hash_obtener_o_insertar_hasheada(hash_t *hash, const char *clave, size_t largo, uint64_t codigo,
+                                      void ***dato, bool *insertado);
+
+/* Guarda cantidad pares (claves[i], datos[i]) como hash_guardar, pero
+ * agranda el hash una sola vez para todos y los guarda ordenados por
+ * posicion. Las claves repetidas (en el lote o ya guardadas) se reemplazan
+ * como en hash_guardar, llamando a destruir_dato, y queda la ultima del
+ * lote. Con datos NULL todos los datos son NULL.
+ * Post: Devuelve false si alguna clave es NULL o no hubo memoria; en ese
+ * caso parte de los pares puede haber quedado guardada.
+ */
+bool hash_guardar_lote(hash_t *hash, const char *const claves[], void *const datos[], size_t cantidad);
+
+/* Crea el hash con las opciones indicadas (NULL para las por defecto) y le
+ * carga los pares con hash_guardar_lote.
+ * Post: Devuelve NULL si no hubo memoria o alguna clave es NULL; los datos
+ * siguen siendo del usuario (salvo los reemplazados por claves repetidas).
+ */
+hash_t *hash_crear_con_lote(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones,
+                            const char *const claves[], void *const datos[], size_t cantidad);
+
+/* Versiones por lotes de obtener y pertenece: buscan cantidad claves de una
+ * vez y dejan en resultados[i] lo que devolveria hash_obtener (o
+ * hash_pertenece) con claves[i]. Superponen las esperas a la memoria de
+ * varias claves, por lo que son mas rapidas que llamar una vez por clave
+ * cuando el hash no entra en la cache. Una clave NULL no se encuentra.
+ * Pre: resultados tiene lugar para cantidad elementos.
+ * Post: Devuelve cuantas claves se encontraron.
+ */
+size_t hash_obtener_lote(const hash_t *hash, const char *const claves[], size_t cantidad, void *resultados[]);
+size_t hash_pertenece_lote(const hash_t *hash, const char *const claves[], size_t cantidad, bool resultados[]);
+
 /* Devuelve la cantidad de elementos del hash.
  * Pre: La estructura hash fue inicializada
  */
@@ -66,10 +297,68 @@ bool hash_iter_avanzar(hash_iter_t *iter);
 // Devuelve clave actual, esa clave no se puede modificar ni liberar.
 const char *hash_iter_ver_actual(const hash_iter_t *iter);
 
+// Devuelve el largo de la clave actual (la clave puede tener '\0' en el medio).
+size_t hash_iter_ver_largo(const hash_iter_t *iter);
+
 // Comprueba si terminó la iteración
 bool hash_iter_al_final(const hash_iter_t *iter);
 
 // Destruye iterador
 void hash_iter_destruir(hash_iter_t* iter);
 
+/* Recorrido sin memoria dinamica: es un iterador que se declara donde haga
+ * falta (por ejemplo en el stack) y se inicializa con hash_recorrido_iniciar;
+ * no se destruye. Los campos son privados. Como el iterador, deja de ser
+ * valido si se guarda o borra una clave.
+ */
+typedef struct hash_recorrido {
+    const hash_t *hash;
+    const void *nodo;           // Nodo de la lista actual del hash abierto
+    size_t posicion;            // En el vector, el desborde, el arreglo de chicos o las ranuras
+    size_t recorridos;          // Claves que ya se dejaron atras
+    bool en_desborde;
+} hash_recorrido_t;
+
+// Inicializa el recorrido en la primer clave del hash
+void hash_recorrido_iniciar(hash_recorrido_t *recorrido, const hash_t *hash);
+
+// Avanza a la clave siguiente; devuelve false si quedo al final
+bool hash_recorrido_avanzar(hash_recorrido_t *recorrido);
+
+// Devuelven la clave actual (que no se puede modificar ni liberar), su largo
+// y su dato; NULL, 0 y NULL al final.
+const char *hash_recorrido_ver_actual(const hash_recorrido_t *recorrido);
+size_t hash_recorrido_ver_largo(const hash_recorrido_t *recorrido);
+void *hash_recorrido_ver_dato(const hash_recorrido_t *recorrido);
+
+// Comprueba si termino el recorrido
+bool hash_recorrido_al_final(const hash_recorrido_t *recorrido);
+
+// Funcion para hash_iterar: recibe cada clave con su largo y su dato, y
+// devuelve false para cortar la iteracion
+typedef bool (*hash_visitar_t)(const char *clave, size_t largo, void *dato, void *extra);
+
+/* Itera el hash aplicandole visitar a cada clave, pasandole extra, hasta que
+ * visitar devuelva false. Recorre el almacenamiento directamente, sin pedir
+ * memoria. visitar no puede guardar ni borrar claves del hash.
+ * Pre: La estructura hash fue inicializada
+ */
+void hash_iterar(const hash_t *hash, hash_visitar_t visitar, void *extra);
+
+/* Itera como hash_iterar solo la parte numero parte (desde 0) de partes
+ * partes iguales del almacenamiento: un rango de posiciones del vector y del
+ * desborde, o de ranuras. Las partes no se superponen y entre todas visitan
+ * cada clave una vez, asi se pueden iterar desde hilos distintos mientras
+ * nadie guarde ni borre.
+ */
+void hash_iterar_parte(const hash_t *hash, size_t parte, size_t partes, hash_visitar_t visitar, void *extra);
+
+/* Itera el hash como hash_iterar, repartiendo las partes entre hilos hilos
+ * que se crean para la llamada (el que llama es uno de ellos). visitar se
+ * llama desde varios hilos a la vez y sin orden; si devuelve false los demas
+ * paran en su proxima clave. Vuelve cuando terminaron todos. Con pocas
+ * claves, o si no se pueden crear los hilos, itera en el que llama.
+ */
+void hash_iterar_paralelo(const hash_t *hash, hash_visitar_t visitar, void *extra, size_t hilos);
+
 #endif // HASH_H
@@ -0,0 +1,635 @@
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "hash_cerrado.h"
+#include "grupos_simd.h"
+#include "hilos.h"
+
+#define CAPACIDAD_INICIAL 1024             // Debe ser potencia de 2 y >= GRUPO_ANCHO_MAXIMO
+#define FACTOR_CARGA_LINEAL 0.75
+#define FACTOR_CARGA_ROBIN_HOOD 0.9
+#define FACTOR_CARGA_GRUPOS 0.875           // Cuenta tambien las lapidas
+#define FACTOR_CARGA_MINIMO_CERRADO 0.125
+#define MINIMO_POR_PARTES 16384            // Ranuras ocupadas desde las que se redimensiona por partes
+#define PARTES_REDIMENSION 64              // Rangos de la tabla nueva que se llenan por separado
+#define DIFERIDAS_POR_PARTE 256            // Ranuras que cada rango puede dejar para el final
+
+#define CONTROL_VACIO 0x80
+#define CONTROL_BORRADO 0xFE
+
+/* Pide un arreglo de ranuras libres */
+static ranura_t* ranuras_crear(const hash_cerrado_t* tabla, size_t capacidad) {
+    return memoria_pedir_ceros(tabla->memoria, capacidad, sizeof(ranura_t));
+}
+
+/* Distancia de la ranura en posicion a su posicion ideal */
+static size_t distancia(const ranura_t* ranura, size_t posicion, size_t mascara) {
+    return (posicion - (ranura->codigo & mascara)) & mascara;
+}
+
+/* Fragmento de 7 bits del codigo que se guarda en el byte de control. Usa los
+ * bits altos, los bajos eligen la posicion.
+ */
+static uint8_t fragmento(uint32_t codigo) {
+    return (uint8_t)(codigo >> 25);
+}
+
+/* Escribe un byte de control. Los primeros GRUPO_ANCHO_MAXIMO bytes se copian
+ * al final para poder leer un grupo entero desde cualquier posicion.
+ */
+static void control_escribir(hash_cerrado_t* tabla, size_t posicion, uint8_t valor) {
+    tabla->control[posicion] = valor;
+    if(posicion < GRUPO_ANCHO_MAXIMO)
+        tabla->control[tabla->capacidad + posicion] = valor;
+}
+
+/* Coloca la ranura en la tabla por grupos, en la primer ranura libre o borrada */
+static size_t colocar_grupos(hash_cerrado_t* tabla, ranura_t nueva) {
+    const grupo_operaciones_t* grupo = grupo_operaciones();
+    size_t mascara = tabla->capacidad - 1;
+    size_t posicion = nueva.codigo & mascara;
+
+    while(true)
+    {
+        uint32_t libres = grupo->libres(&tabla->control[posicion]);
+        if(libres)
+        {
+            size_t destino = (posicion + (size_t)__builtin_ctz(libres)) & mascara;
+            if(tabla->control[destino] == CONTROL_BORRADO) tabla->borrados--;
+            control_escribir(tabla, destino, fragmento(nueva.codigo));
+            tabla->ranuras[destino] = nueva;
+            return destino;
+        }
+        posicion = (posicion + grupo->ancho) & mascara;
+    }
+}
+
+/* Coloca la ranura con sondeo lineal o Robin Hood, siguiendo el sondeo
+ * desde posicion, que esta a recorrido de su posicion ideal.
+ * Post: Devuelve la posicion donde quedo la ranura recibida.
+ */
+static size_t colocar_desde(hash_cerrado_t* tabla, ranura_t nueva, size_t posicion, size_t recorrido) {
+    size_t mascara = tabla->capacidad - 1;
+    size_t destino = tabla->capacidad;
+
+    while(true)
+    {
+        ranura_t* ranura = &tabla->ranuras[posicion];
+        if(!ranura->clave)
+        {
+            *ranura = nueva;
+            return destino == tabla->capacidad ? posicion : destino;
+        }
+
+        // Robin Hood: si el que esta ocupando la ranura esta mas cerca de su
+        // posicion ideal que el que se inserta, se intercambian.
+        if(tabla->sondeo == SONDEO_ROBIN_HOOD)
+        {
+            size_t d = distancia(ranura, posicion, mascara);
+            if(d < recorrido)
+            {
+                ranura_t desplazada = *ranura;
+                *ranura = nueva;
+                nueva = desplazada;
+                recorrido = d;
+                if(destino == tabla->capacidad) destino = posicion;
+            }
+        }
+
+        posicion = (posicion + 1) & mascara;
+        recorrido++;
+    }
+}
+
+/* Coloca la ranura en la tabla sin comprobar capacidad ni duplicados.
+ * Post: Devuelve la posicion donde quedo la ranura recibida.
+ */
+static size_t colocar(hash_cerrado_t* tabla, ranura_t nueva) {
+    if(tabla->sondeo == SONDEO_GRUPOS) return colocar_grupos(tabla, nueva);
+    return colocar_desde(tabla, nueva, nueva.codigo & (tabla->capacidad - 1), 0);
+}
+
+/* Pide los bytes de control, todos vacios */
+static uint8_t* control_crear(const hash_cerrado_t* tabla, size_t capacidad) {
+    uint8_t* control = memoria_pedir(tabla->memoria, capacidad + GRUPO_ANCHO_MAXIMO);
+    if(control) memset(control, CONTROL_VACIO, capacidad + GRUPO_ANCHO_MAXIMO);
+    return control;
+}
+
+/* Coloca la ranura como colocar, pero sin tocar nada desde fin: ni ranuras
+ * ni bytes de control. Cuenta en lapidas las que reutiliza, sin cambiar la
+ * tabla, para sumarlas despues.
+ * Pre: La posicion ideal de la ranura esta antes de fin.
+ * Post: Devuelve false si el sondeo llego a fin; en nueva queda la ranura
+ * que falta colocar (en Robin Hood puede ser otra, desplazada).
+ */
+static bool colocar_en_rango(hash_cerrado_t* tabla, ranura_t* nueva, size_t fin, size_t* lapidas) {
+    size_t mascara = tabla->capacidad - 1;
+    size_t posicion = nueva->codigo & mascara;
+
+    if(tabla->sondeo == SONDEO_GRUPOS)
+    {
+        // Solo grupos enteros dentro del rango: ni se leen bytes de otro.
+        const grupo_operaciones_t* grupo = grupo_operaciones();
+        for(; posicion + grupo->ancho <= fin; posicion += grupo->ancho)
+        {
+            uint32_t libres = grupo->libres(&tabla->control[posicion]);
+            if(!libres) continue;
+
+            size_t destino = posicion + (size_t)__builtin_ctz(libres);
+            if(tabla->control[destino] == CONTROL_BORRADO) (*lapidas)++;
+            control_escribir(tabla, destino, fragmento(nueva->codigo));
+            tabla->ranuras[destino] = *nueva;
+            return true;
+        }
+        return false;
+    }
+
+    for(size_t recorrido = 0; posicion < fin; posicion++, recorrido++)
+    {
+        ranura_t* ranura = &tabla->ranuras[posicion];
+        if(!ranura->clave)
+        {
+            *ranura = *nueva;
+            return true;
+        }
+        if(tabla->sondeo == SONDEO_ROBIN_HOOD)
+        {
+            size_t d = distancia(ranura, posicion, mascara);
+            if(d < recorrido)
+            {
+                ranura_t desplazada = *ranura;
+                *ranura = *nueva;
+                *nueva = desplazada;
+                recorrido = d;
+            }
+        }
+    }
+    return false;
+}
+
+/* Redimension por partes: la tabla nueva se divide en rangos de ancho
+ * ranuras y la vieja en bloques; cada rango se llena solo con las ranuras
+ * cuya posicion ideal cae en el, leyendo los bloques viejos de donde pueden
+ * venir. Los rangos no se pisan, asi que los hilos no necesitan cerrojos.
+ */
+typedef struct redimension {
+    hash_cerrado_t* tabla;                  /* Ya con las ranuras nuevas */
+    const ranura_t* viejas;
+    const uint8_t* control_viejo;           /* Solo SONDEO_GRUPOS */
+    size_t capacidad_vieja;
+    size_t ancho;                           /* Ranuras de cada rango nuevo */
+    size_t bloque;                          /* Ranuras de cada bloque viejo */
+    ranura_t* diferidas;                    /* DIFERIDAS_POR_PARTE por rango */
+    size_t* cantidades;                     /* Diferidas de cada rango, SIZE_MAX si no alcanzo */
+} redimension_t;
+
+/* Devuelve donde termina la lectura del bloque viejo que empieza en inicio:
+ * despues de su ultima ranura siguen las que se corrieron desde el, hasta la
+ * primera libre (en grupos, hasta un grupo despues del primer byte vacio).
+ * Puede pasarse de la capacidad vieja; se lee con la mascara.
+ */
+static size_t fin_de_bloque(const redimension_t* redimension, size_t inicio) {
+    size_t mascara = redimension->capacidad_vieja - 1;
+    size_t fin = inicio + redimension->bloque;
+    size_t limite = inicio + redimension->capacidad_vieja;
+    if(redimension->bloque == redimension->capacidad_vieja) return fin;
+
+    if(!redimension->control_viejo)
+    {
+        while(fin < limite && redimension->viejas[fin & mascara].clave) fin++;
+        return fin;
+    }
+    while(fin < limite && redimension->control_viejo[fin & mascara] != CONTROL_VACIO) fin++;
+    return fin + GRUPO_ANCHO_MAXIMO < limite ? fin + GRUPO_ANCHO_MAXIMO : limite;
+}
+
+/* Llena un rango de la tabla nueva. Las ranuras que no entran antes del fin
+ * del rango quedan diferidas.
+ */
+static void llenar_rango(void* extra, size_t rango) {
+    redimension_t* redimension = extra;
+    hash_cerrado_t* tabla = redimension->tabla;
+    size_t mascara_vieja = redimension->capacidad_vieja - 1;
+    size_t bloques = redimension->capacidad_vieja / redimension->bloque;
+    size_t rangos = tabla->capacidad / redimension->ancho;
+    size_t paso = bloques < rangos ? bloques : rangos;
+    size_t fin = (rango + 1) * redimension->ancho;
+    ranura_t* diferidas = &redimension->diferidas[rango * DIFERIDAS_POR_PARTE];
+    size_t cantidad = 0, lapidas = 0;
+
+    for(size_t bloque = rango % paso; bloque < bloques; bloque += paso)
+    {
+        size_t fin_bloque = fin_de_bloque(redimension, bloque * redimension->bloque);
+        for(size_t i = bloque * redimension->bloque; i < fin_bloque; i++)
+        {
+            ranura_t nueva = redimension->viejas[i & mascara_vieja];
+            if(!nueva.clave || (nueva.codigo & mascara_vieja) / redimension->bloque != bloque
+               || (nueva.codigo & (tabla->capacidad - 1)) / redimension->ancho != rango) continue;
+            if(colocar_en_rango(tabla, &nueva, fin, &lapidas)) continue;
+
+            if(cantidad == DIFERIDAS_POR_PARTE)
+            {
+                redimension->cantidades[rango] = SIZE_MAX;
+                return;
+            }
+            diferidas[cantidad++] = nueva;
+        }
+    }
+    redimension->cantidades[rango] = cantidad;
+}
+
+/* Reubica en la tabla (con las ranuras nuevas, vacias) las viejas por
+ * partes, repartiendo los rangos entre los hilos de la tabla si tiene, y
+ * despues coloca las diferidas. El resultado no depende de los hilos.
+ * Post: Devuelve false si no hubo memoria o algun rango difirio demasiadas,
+ * con las ranuras nuevas otra vez vacias.
+ */
+static bool redimensionar_por_partes(hash_cerrado_t* tabla, const ranura_t* viejas, const uint8_t* control_viejo, size_t capacidad_vieja) {
+    size_t ancho = tabla->capacidad / PARTES_REDIMENSION;
+    redimension_t redimension = { tabla, viejas, control_viejo, capacidad_vieja, ancho,
+                                  ancho < capacidad_vieja ? ancho : capacidad_vieja, NULL, NULL };
+    redimension.diferidas = memoria_pedir(tabla->memoria, sizeof(ranura_t) * PARTES_REDIMENSION * DIFERIDAS_POR_PARTE);
+    redimension.cantidades = memoria_pedir(tabla->memoria, sizeof(size_t) * PARTES_REDIMENSION);
+
+    bool llenos = redimension.diferidas && redimension.cantidades;
+    if(llenos) hilos_ejecutar(tabla->hilos, llenar_rango, &redimension, PARTES_REDIMENSION);
+    for(size_t rango = 0; llenos && rango < PARTES_REDIMENSION; rango++)
+        llenos = redimension.cantidades[rango] != SIZE_MAX;
+
+    for(size_t rango = 0; llenos && rango < PARTES_REDIMENSION; rango++)
+        for(size_t i = 0; i < redimension.cantidades[rango]; i++)
+            colocar(tabla, redimension.diferidas[rango * DIFERIDAS_POR_PARTE + i]);
+
+    if(!llenos && redimension.diferidas && redimension.cantidades)
+    {
+        memset(tabla->ranuras, 0, sizeof(ranura_t) * tabla->capacidad);
+        if(tabla->control) memset(tabla->control, CONTROL_VACIO, tabla->capacidad + GRUPO_ANCHO_MAXIMO);
+    }
+    memoria_liberar(tabla->memoria, redimension.diferidas);
+    memoria_liberar(tabla->memoria, redimension.cantidades);
+    return llenos;
+}
+
+/* Cambia la capacidad de la tabla reubicando las ranuras. No rehashea las
+ * claves, usa el codigo guardado en cada ranura. Con muchas ranuras las
+ * reubica por partes.
+ */
+static bool redimensionar(hash_cerrado_t* tabla, size_t nueva_capacidad) {
+    ranura_t* nuevas = ranuras_crear(tabla, nueva_capacidad);
+    if(!nuevas) return false;
+
+    uint8_t* nuevo_control = NULL;
+    if(tabla->sondeo == SONDEO_GRUPOS)
+    {
+        nuevo_control = control_crear(tabla, nueva_capacidad);
+        if(!nuevo_control)
+        {
+            memoria_liberar(tabla->memoria, nuevas);
+            return false;
+        }
+    }
+
+    ranura_t* viejas = tabla->ranuras;
+    uint8_t* control_viejo = tabla->control;
+    size_t capacidad_vieja = tabla->capacidad;
+
+    tabla->control = nuevo_control;
+    tabla->borrados = 0;
+    tabla->ranuras = nuevas;
+    tabla->capacidad = nueva_capacidad;
+
+    bool por_partes = tabla->cantidad >= MINIMO_POR_PARTES && nueva_capacidad / PARTES_REDIMENSION >= GRUPO_ANCHO_MAXIMO;
+    if(!por_partes || !redimensionar_por_partes(tabla, viejas, control_viejo, capacidad_vieja))
+    {
+        for(size_t i = 0; i < capacidad_vieja; i++)
+            if(viejas[i].clave) colocar(tabla, viejas[i]);
+    }
+
+    memoria_liberar(tabla->memoria, control_viejo);
+    memoria_liberar(tabla->memoria, viejas);
+    return true;
+}
+
+bool hash_cerrado_inicializar(hash_cerrado_t* tabla, sondeo_t sondeo, const memoria_t* memoria) {
+    tabla->memoria = memoria;
+    tabla->ranuras = ranuras_crear(tabla, CAPACIDAD_INICIAL);
+    if(!tabla->ranuras) return false;
+
+    tabla->control = NULL;
+    tabla->hilos = NULL;
+    if(sondeo == SONDEO_GRUPOS)
+    {
+        tabla->control = control_crear(tabla, CAPACIDAD_INICIAL);
+        if(!tabla->control)
+        {
+            memoria_liberar(tabla->memoria, tabla->ranuras);
+            return false;
+        }
+    }
+
+    tabla->capacidad = CAPACIDAD_INICIAL;
+    tabla->capacidad_minima = CAPACIDAD_INICIAL;
+    tabla->achicar = true;
+    tabla->cantidad = 0;
+    tabla->borrados = 0;
+    tabla->sondeo = sondeo;
+    return true;
+}
+
+/* hash_cerrado_buscar para el sondeo por grupos. La busqueda termina en el
+ * primer grupo que tenga una ranura que nunca se uso.
+ */
+static ranura_t* buscar_grupos(const hash_cerrado_t* tabla, const char* clave, size_t largo, uint32_t codigo) {
+    const grupo_operaciones_t* grupo = grupo_operaciones();
+    size_t mascara = tabla->capacidad - 1;
+    size_t posicion = codigo & mascara;
+    uint8_t buscado = fragmento(codigo);
+
+    for(size_t sondeados = 0; sondeados < tabla->capacidad; sondeados += grupo->ancho)
+    {
+        const uint8_t* control = &tabla->control[posicion];
+        uint32_t coincidencias = grupo->coincidir(control, buscado);
+
+        while(coincidencias)
+        {
+            ranura_t* ranura = &tabla->ranuras[(posicion + (size_t)__builtin_ctz(coincidencias)) & mascara];
+            if(ranura->codigo == codigo && ranura->largo == largo && memcmp(ranura->clave, clave, largo) == 0)
+                return ranura;
+            coincidencias &= coincidencias - 1;
+        }
+
+        if(grupo->coincidir(control, CONTROL_VACIO)) return NULL;
+        posicion = (posicion + grupo->ancho) & mascara;
+    }
+    return NULL;
+}
+
+ranura_t* hash_cerrado_buscar(const hash_cerrado_t* tabla, const char* clave, size_t largo, uint32_t codigo) {
+    if(tabla->sondeo == SONDEO_GRUPOS) return buscar_grupos(tabla, clave, largo, codigo);
+
+    size_t mascara = tabla->capacidad - 1;
+    size_t posicion = codigo & mascara;
+    size_t recorrido = 0;
+
+    while(true)
+    {
+        ranura_t* ranura = &tabla->ranuras[posicion];
+        if(!ranura->clave) return NULL;
+
+        // Robin Hood: nadie con esta clave pudo haber quedado mas lejos.
+        if(tabla->sondeo == SONDEO_ROBIN_HOOD && distancia(ranura, posicion, mascara) < recorrido)
+            return NULL;
+
+        if(ranura->codigo == codigo && ranura->largo == largo && memcmp(ranura->clave, clave, largo) == 0)
+            return ranura;
+
+        posicion = (posicion + 1) & mascara;
+        recorrido++;
+    }
+}
+
+size_t hash_cerrado_posicion(const hash_cerrado_t* tabla, uint32_t codigo) {
+    return codigo & (tabla->capacidad - 1);
+}
+
+void hash_cerrado_anticipar(const hash_cerrado_t* tabla, uint32_t codigo) {
+    size_t posicion = hash_cerrado_posicion(tabla, codigo);
+    memoria_anticipar(&tabla->ranuras[posicion]);
+    if(tabla->sondeo == SONDEO_GRUPOS) memoria_anticipar(&tabla->control[posicion]);
+}
+
+bool hash_cerrado_colocar_en_rango(hash_cerrado_t* tabla, ranura_t* nueva, size_t fin, size_t* lapidas) {
+    return colocar_en_rango(tabla, nueva, fin, lapidas);
+}
+
+void hash_cerrado_colocar(hash_cerrado_t* tabla, ranura_t nueva) {
+    colocar(tabla, nueva);
+}
+
+void hash_cerrado_contar_colocadas(hash_cerrado_t* tabla, size_t colocadas, size_t lapidas) {
+    tabla->cantidad += colocadas;
+    tabla->borrados -= lapidas;
+}
+
+/* Factor de carga maximo segun el sondeo */
+static double factor_maximo(const hash_cerrado_t* tabla) {
+    if(tabla->sondeo == SONDEO_ROBIN_HOOD) return FACTOR_CARGA_ROBIN_HOOD;
+    if(tabla->sondeo == SONDEO_GRUPOS) return FACTOR_CARGA_GRUPOS;
+    return FACTOR_CARGA_LINEAL;
+}
+
+/* Menor capacidad donde entran cantidad claves sin pasar el factor de carga */
+static size_t capacidad_para(const hash_cerrado_t* tabla, size_t cantidad) {
+    size_t capacidad = CAPACIDAD_INICIAL;
+    while((double)cantidad > (double)capacidad * factor_maximo(tabla))
+        capacidad *= 2;
+    return capacidad;
+}
+
+bool hash_cerrado_reservar(hash_cerrado_t* tabla, size_t cantidad) {
+    size_t capacidad = capacidad_para(tabla, cantidad);
+    if(capacidad > tabla->capacidad && !redimensionar(tabla, capacidad)) return false;
+    tabla->capacidad_minima = capacidad;
+    return true;
+}
+
+bool hash_cerrado_agrandar(hash_cerrado_t* tabla, size_t cantidad) {
+    size_t capacidad = capacidad_para(tabla, cantidad);
+    if(capacidad <= tabla->capacidad) return true;
+    return redimensionar(tabla, capacidad);
+}
+
+bool hash_cerrado_compactar(hash_cerrado_t* tabla) {
+    size_t capacidad = tabla->capacidad_minima;
+    while((double)tabla->cantidad > (double)capacidad * factor_maximo(tabla) / 2)
+        capacidad *= 2;
+
+    if(capacidad >= tabla->capacidad) return true;
+    return redimensionar(tabla, capacidad);
+}
+
+bool hash_cerrado_hay_lugar(const hash_cerrado_t* tabla, size_t cantidad) {
+    return (double)(tabla->cantidad + tabla->borrados + cantidad) <= (double)tabla->capacidad * factor_maximo(tabla);
+}
+
+/* Devuelve si una ranura mas pasaria el factor de carga */
+static bool llena(const hash_cerrado_t* tabla) {
+    return (double)(tabla->cantidad + tabla->borrados + 1) > (double)tabla->capacidad * factor_maximo(tabla);
+}
+
+/* Hace lugar para una ranura mas.
+ * Post: Devuelve false si no hubo memoria.
+ */
+static bool crecer(hash_cerrado_t* tabla) {
+    // Si la mitad de lo usado son lapidas alcanza con limpiarlas.
+    size_t nueva_capacidad = tabla->capacidad * 2;
+    if(tabla->borrados > tabla->cantidad) nueva_capacidad = tabla->capacidad;
+    return redimensionar(tabla, nueva_capacidad);
+}
+
+bool hash_cerrado_insertar(hash_cerrado_t* tabla, char* clave, size_t largo, uint32_t codigo, void* dato) {
+    if(llena(tabla) && !crecer(tabla)) return false;
+
+    ranura_t nueva = { clave, dato, largo, codigo };
+    colocar(tabla, nueva);
+    tabla->cantidad++;
+    return true;
+}
+
+/* Coloca la ranura nueva donde termino una busqueda sin exito (posicion a
+ * recorrido de la ideal; en grupos, la primer libre o borrada que se vio).
+ * Si la tabla esta llena crece y la coloca desde cero.
+ * Post: Devuelve la ranura colocada, o NULL si no hubo memoria.
+ */
+static ranura_t* colocar_nueva(hash_cerrado_t* tabla, ranura_t nueva, size_t posicion, size_t recorrido) {
+    if(llena(tabla))
+    {
+        if(!crecer(tabla)) return NULL;
+        posicion = colocar(tabla, nueva);
+    }
+    else if(tabla->sondeo == SONDEO_GRUPOS)
+    {
+        if(tabla->control[posicion] == CONTROL_BORRADO) tabla->borrados--;
+        control_escribir(tabla, posicion, fragmento(nueva.codigo));
+        tabla->ranuras[posicion] = nueva;
+    }
+    else
+        posicion = colocar_desde(tabla, nueva, posicion, recorrido);
+
+    tabla->cantidad++;
+    return &tabla->ranuras[posicion];
+}
+
+/* hash_cerrado_buscar_o_insertar para el sondeo por grupos: mientras busca
+ * anota la primer ranura libre o borrada, que es donde va la clave nueva.
+ */
+static ranura_t* buscar_o_insertar_grupos(hash_cerrado_t* tabla, ranura_t nueva, bool* insertada) {
+    const grupo_operaciones_t* grupo = grupo_operaciones();
+    size_t mascara = tabla->capacidad - 1;
+    size_t posicion = nueva.codigo & mascara;
+    size_t destino = tabla->capacidad;
+    uint8_t buscado = fragmento(nueva.codigo);
+
+    for(size_t sondeados = 0; sondeados < tabla->capacidad; sondeados += grupo->ancho)
+    {
+        const uint8_t* control = &tabla->control[posicion];
+        uint32_t coincidencias = grupo->coincidir(control, buscado);
+
+        while(coincidencias)
+        {
+            ranura_t* ranura = &tabla->ranuras[(posicion + (size_t)__builtin_ctz(coincidencias)) & mascara];
+            if(ranura->codigo == nueva.codigo && ranura->largo == nueva.largo && memcmp(ranura->clave, nueva.clave, nueva.largo) == 0)
+                return ranura;
+            coincidencias &= coincidencias - 1;
+        }
+
+        uint32_t libres = grupo->libres(control);
+        if(libres && destino == tabla->capacidad)
+            destino = (posicion + (size_t)__builtin_ctz(libres)) & mascara;
+        if(grupo->coincidir(control, CONTROL_VACIO)) break;
+        posicion = (posicion + grupo->ancho) & mascara;
+    }
+
+    *insertada = true;
+    return colocar_nueva(tabla, nueva, destino, 0);
+}
+
+ranura_t* hash_cerrado_buscar_o_insertar(hash_cerrado_t* tabla, const char* clave, size_t largo, uint32_t codigo, bool* insertada) {
+    // La ranura nueva apunta a la clave recibida hasta que la reemplacen.
+    ranura_t nueva = { (char*) clave, NULL, largo, codigo };
+    *insertada = false;
+    if(tabla->sondeo == SONDEO_GRUPOS) return buscar_o_insertar_grupos(tabla, nueva, insertada);
+
+    size_t mascara = tabla->capacidad - 1;
+    size_t posicion = codigo & mascara;
+    size_t recorrido = 0;
+
+    while(true)
+    {
+        ranura_t* ranura = &tabla->ranuras[posicion];
+        if(!ranura->clave) break;
+
+        // Robin Hood: la clave no esta y este es su lugar.
+        if(tabla->sondeo == SONDEO_ROBIN_HOOD && distancia(ranura, posicion, mascara) < recorrido)
+            break;
+
+        if(ranura->codigo == codigo && ranura->largo == largo && memcmp(ranura->clave, clave, largo) == 0)
+            return ranura;
+
+        posicion = (posicion + 1) & mascara;
+        recorrido++;
+    }
+
+    *insertada = true;
+    return colocar_nueva(tabla, nueva, posicion, recorrido);
+}
+
+/* hash_cerrado_quitar para el sondeo por grupos: deja una lapida */
+static void quitar_grupos(hash_cerrado_t* tabla, size_t posicion) {
+    control_escribir(tabla, posicion, CONTROL_BORRADO);
+    tabla->ranuras[posicion].clave = NULL;
+    tabla->borrados++;
+}
+
+/* hash_cerrado_quitar para el sondeo lineal y Robin Hood.
+ * Corrimiento hacia atras: se adelantan al hueco los que quedarian
+ * inalcanzables, hasta encontrar una ranura libre. En Robin Hood basta con
+ * frenar en el primero que esta en su posicion ideal.
+ */
+static void quitar_corriendo(hash_cerrado_t* tabla, size_t hueco) {
+    size_t mascara = tabla->capacidad - 1;
+    size_t siguiente = (hueco + 1) & mascara;
+
+    while(tabla->ranuras[siguiente].clave)
+    {
+        size_t d = distancia(&tabla->ranuras[siguiente], siguiente, mascara);
+        if(tabla->sondeo == SONDEO_ROBIN_HOOD && d == 0) break;
+
+        // Se mueve solo si su posicion ideal no esta entre el hueco y el.
+        if(d >= ((siguiente - hueco) & mascara))
+        {
+            tabla->ranuras[hueco] = tabla->ranuras[siguiente];
+            hueco = siguiente;
+        }
+        siguiente = (siguiente + 1) & mascara;
+    }
+    tabla->ranuras[hueco].clave = NULL;
+}
+
+void hash_cerrado_quitar(hash_cerrado_t* tabla, ranura_t* ranura) {
+    size_t posicion = (size_t)(ranura - tabla->ranuras);
+
+    if(tabla->sondeo == SONDEO_GRUPOS)
+        quitar_grupos(tabla, posicion);
+    else
+        quitar_corriendo(tabla, posicion);
+
+    tabla->cantidad--;
+
+    if(tabla->achicar && tabla->capacidad > tabla->capacidad_minima && (double)tabla->cantidad < (double)tabla->capacidad * FACTOR_CARGA_MINIMO_CERRADO)
+        redimensionar(tabla, tabla->capacidad / 2);    // Si falla queda con la capacidad actual
+}
+
+size_t hash_cerrado_proxima(const hash_cerrado_t* tabla, size_t posicion) {
+    while(posicion < tabla->capacidad && !tabla->ranuras[posicion].clave)
+        posicion++;
+    return posicion;
+}
+
+void hash_cerrado_destruir(hash_cerrado_t* tabla, void (*destruir_dato)(void*)) {
+    for(size_t i = 0; i < tabla->capacidad; i++)
+    {
+        if(!tabla->ranuras[i].clave) continue;
+        if(destruir_dato) destruir_dato(tabla->ranuras[i].dato);
+        memoria_liberar(tabla->memoria, tabla->ranuras[i].clave);
+    }
+    memoria_liberar(tabla->memoria, tabla->ranuras);
+    memoria_liberar(tabla->memoria, tabla->control);
+    tabla->ranuras = NULL;
+    tabla->control = NULL;
+    tabla->capacidad = 0;
+    tabla->cantidad = 0;
+}
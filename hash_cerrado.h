@@ -0,0 +1,151 @@
+#ifndef HASH_CERRADO_H
+#define HASH_CERRADO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "hilos.h"
+#include "memoria.h"
+
+/*
+ * HASH CERRADO (direccionamiento abierto)
+ * Motor alternativo para hash.c: las claves, los codigos de hash y los datos
+ * se guardan en un unico arreglo contiguo de ranuras, sin listas ni nodos.
+ * La capacidad es siempre potencia de 2 y los borrados usan corrimiento hacia
+ * atras, por lo que no quedan lapidas.
+ *
+ * En el sondeo por grupos (estilo "Swiss table") ademas hay un byte de control
+ * por ranura con 7 bits del codigo. Se comparan grupos enteros de bytes de
+ * control con SIMD y solo se compara la clave cuando el fragmento coincide.
+ * Ahi los borrados dejan lapidas que se limpian al redimensionar.
+ *
+ * Con muchas ranuras, redimensionar llena la tabla nueva por rangos que no
+ * se pisan, repartidos entre los hilos de la tabla si tiene.
+ */
+
+typedef enum {
+    SONDEO_LINEAL,          // Sondeo lineal clasico
+    SONDEO_ROBIN_HOOD,      // Sondeo lineal reubicando al elemento "mas rico"
+    SONDEO_GRUPOS           // Sondeo por grupos de bytes de control (SIMD)
+} sondeo_t;
+
+typedef struct ranura {
+    char* clave;            // NULL si la ranura esta libre
+    void* dato;
+    size_t largo;           // Largo de la clave
+    uint32_t codigo;        // Hash completo de la clave
+} ranura_t;
+
+typedef struct hash_cerrado {
+    ranura_t* ranuras;
+    size_t capacidad;       // Cantidad de ranuras (potencia de 2)
+    size_t capacidad_minima;    // Al borrar no se achica por debajo de esta
+    bool achicar;           // Se achica sola al borrar (true por defecto)
+    size_t cantidad;        // Cantidad de ranuras ocupadas
+    sondeo_t sondeo;
+    uint8_t* control;       // Solo SONDEO_GRUPOS: capacidad + GRUPO_ANCHO_MAXIMO bytes
+    size_t borrados;        // Solo SONDEO_GRUPOS: cantidad de lapidas
+    const memoria_t* memoria;   // De donde salen las ranuras, el control y las claves
+    hilos_t* hilos;         // Si no es NULL, las redimensiones grandes se reparten entre ellos
+} hash_cerrado_t;
+
+/* Inicializa la tabla vacia con la capacidad inicial. Pide la memoria a
+ * memoria (NULL para usar malloc).
+ * Post: Devuelve false si no hubo memoria.
+ */
+bool hash_cerrado_inicializar(hash_cerrado_t* tabla, sondeo_t sondeo, const memoria_t* memoria);
+
+/* Agranda la tabla para que entren cantidad claves sin redimensionar, y no
+ * la deja achicarse por debajo de eso. La ultima reserva reemplaza a las
+ * anteriores.
+ * Post: Devuelve false si no hubo memoria para agrandarla.
+ */
+bool hash_cerrado_reservar(hash_cerrado_t* tabla, size_t cantidad);
+
+/* Agranda la tabla (una sola vez) para que entren cantidad claves sin
+ * redimensionar. A diferencia de hash_cerrado_reservar no cambia la
+ * capacidad minima: despues se puede achicar como siempre.
+ * Post: Devuelve false si no hubo memoria, y la tabla queda como estaba.
+ */
+bool hash_cerrado_agrandar(hash_cerrado_t* tabla, size_t cantidad);
+
+/* Achica la tabla a la menor capacidad donde sus claves ocupan hasta la
+ * mitad del factor de carga maximo, sin bajar de la capacidad minima.
+ * Post: Devuelve false si no hubo memoria, y la tabla queda como estaba.
+ */
+bool hash_cerrado_compactar(hash_cerrado_t* tabla);
+
+/* Devuelve la ranura que contiene la clave o NULL si no esta. Solo compara
+ * los bytes de la clave si coinciden el codigo y el largo.
+ */
+ranura_t* hash_cerrado_buscar(const hash_cerrado_t* tabla, const char* clave, size_t largo, uint32_t codigo);
+
+/* Devuelve la posicion de la ranura donde empieza la busqueda del codigo.
+ * Cambia cuando la tabla se redimensiona.
+ */
+size_t hash_cerrado_posicion(const hash_cerrado_t* tabla, uint32_t codigo);
+
+/* Pide que se traigan a la cache la ranura (y el byte de control) donde
+ * empieza la busqueda del codigo, para buscarlo despues sin esperar a la
+ * memoria. No cambia la tabla.
+ */
+void hash_cerrado_anticipar(const hash_cerrado_t* tabla, uint32_t codigo);
+
+/* Devuelve si entran cantidad ranuras mas sin pasar el factor de carga
+ * (contando las lapidas), es decir, sin redimensionar.
+ */
+bool hash_cerrado_hay_lugar(const hash_cerrado_t* tabla, size_t cantidad);
+
+/* Coloca la ranura de una clave que NO esta en la tabla sin tocar nada
+ * desde la ranura fin (ni sus bytes de control), para que varios hilos
+ * llenen rangos distintos a la vez. No cambia la cantidad: las colocadas y
+ * las lapidas reutilizadas (que se suman en lapidas) se anotan despues con
+ * hash_cerrado_contar_colocadas.
+ * Pre: Hay lugar en la tabla y la posicion de la ranura esta antes de fin.
+ * Post: Devuelve false si no entro antes de fin; en nueva queda la ranura
+ * que falta colocar (en Robin Hood puede ser otra, desplazada), para
+ * colocarla con hash_cerrado_colocar.
+ */
+bool hash_cerrado_colocar_en_rango(hash_cerrado_t* tabla, ranura_t* nueva, size_t fin, size_t* lapidas);
+
+/* Coloca la ranura de una clave que NO esta en la tabla, sin comprobar
+ * capacidad y sin cambiar la cantidad.
+ * Pre: Hay lugar en la tabla.
+ */
+void hash_cerrado_colocar(hash_cerrado_t* tabla, ranura_t nueva);
+
+/* Suma a la tabla las ranuras colocadas por rango y las lapidas que
+ * reutilizaron.
+ */
+void hash_cerrado_contar_colocadas(hash_cerrado_t* tabla, size_t colocadas, size_t lapidas);
+
+/* Inserta una clave que NO esta en la tabla. La tabla se queda con la clave
+ * (pedida a la memoria de la tabla). Redimensiona si hace falta.
+ * Post: Devuelve false si no hubo memoria para crecer.
+ */
+bool hash_cerrado_insertar(hash_cerrado_t* tabla, char* clave, size_t largo, uint32_t codigo, void* dato);
+
+/* Busca la clave con un solo sondeo y, si no esta, la inserta ahi mismo
+ * (creciendo si hace falta) con dato NULL e insertada en true. La ranura
+ * nueva apunta a la clave recibida, que NO se copia: antes de cualquier otra
+ * operacion hay que reemplazar ranura->clave por una copia pedida a la
+ * memoria de la tabla, o quitar la ranura.
+ * Post: Devuelve la ranura de la clave, o NULL si no hubo memoria para crecer.
+ */
+ranura_t* hash_cerrado_buscar_o_insertar(hash_cerrado_t* tabla, const char* clave, size_t largo, uint32_t codigo, bool* insertada);
+
+/* Vacia la ranura indicada (obtenida con hash_cerrado_buscar) reacomodando
+ * las siguientes. No libera la clave ni el dato.
+ */
+void hash_cerrado_quitar(hash_cerrado_t* tabla, ranura_t* ranura);
+
+/* Devuelve la posicion de la primer ranura ocupada desde posicion inclusive,
+ * o la capacidad si no hay mas.
+ */
+size_t hash_cerrado_proxima(const hash_cerrado_t* tabla, size_t posicion);
+
+/* Libera las ranuras y las claves, llamando a destruir_dato con cada dato. */
+void hash_cerrado_destruir(hash_cerrado_t* tabla, void (*destruir_dato)(void*));
+
+#endif // HASH_CERRADO_H
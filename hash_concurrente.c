@@ -0,0 +1,752 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_concurrente.h"
+#include "hash_rapido.h"
+
+#define FRANJAS_POR_DEFECTO 64
+#define FRANJAS_MAXIMAS 65536
+#define POSICIONES_POR_FRANJA 16    // Posiciones iniciales de cada franja
+#define CARGA_MAXIMA 2              // Claves por posicion de una franja para crecer
+#define CARGA_MINIMA 8              // Se achica con menos de una clave cada CARGA_MINIMA posiciones
+#define RECLAMAR_CADA 64            // Retirados de una franja entre intentos de liberarlos
+#define LINEA_CACHE 64
+
+/* Los nodos y las tablas publicadas no cambian salvo siguiente, dato y las
+ * posiciones, que se escriben con atomicos: los lectores los recorren sin
+ * tomar ningun mutex.
+ */
+typedef struct nodo_concurrente {
+    struct nodo_concurrente* siguiente;
+    void* dato;
+    uint64_t codigo;
+    size_t largo;
+    char clave[];
+} nodo_concurrente_t;
+
+/* El vector con su largo: al redimensionar se reemplaza entero, asi un
+ * lector nunca ve un vector con el largo de otro.
+ */
+typedef struct tabla {
+    size_t largo;                   // Potencia de 2
+    unsigned bits;                  // log2(largo)
+    nodo_concurrente_t* posiciones[];
+} tabla_t;
+
+/* Nodo o tabla (sin sus nodos) que un escritor saco del hash y que algun
+ * lector todavia puede estar viendo.
+ */
+typedef struct retirado {
+    void* puntero;
+    uint64_t epoca;                 // Epoca global cuando se retiro
+} retirado_t;
+
+/* Mutex, cantidad de claves y retirados de una franja. El relleno separa
+ * las franjas en lineas de cache distintas, asi dos hilos que usan franjas
+ * vecinas no se invalidan la cache uno al otro.
+ */
+typedef union franja {
+    struct {
+        pthread_mutex_t mutex;
+        size_t cantidad;            // Se escribe con el mutex, se lee sin el
+        retirado_t* retirados;      // En orden de epoca
+        size_t cantidad_retirados;
+        size_t capacidad_retirados;
+    } estado;
+    char relleno[2 * LINEA_CACHE];
+} franja_t;
+
+struct hash_concurrente {
+    tabla_t* tabla;                 // Se cambia con todas las franjas tomadas
+    uint64_t reubicaciones;         // Impar mientras reubicar mueve nodos
+    franja_t* franjas;
+    size_t cantidad_franjas;        // Potencia de 2, no mayor que el largo
+    unsigned bits_franjas;
+    uint64_t semilla;
+    hash_destruir_dato_t destruir_dato;
+};
+
+struct hash_concurrente_iter {
+    const hash_concurrente_t* hash;
+    franja_t* franja;               // Tomada mientras se recorren sus posiciones
+    size_t numero;                  // De la franja
+    size_t posicion;                // En la tabla
+    nodo_concurrente_t* nodo;       // NULL al final
+};
+
+/*
+ * EPOCAS
+ * Los lectores no toman mutex ni escriben memoria compartida: cada hilo
+ * anuncia en su propio lector (una linea de cache solo suya) la epoca global
+ * en la que empezo a leer, y al terminar la borra. Lo que un escritor saca
+ * del hash no se libera enseguida sino que queda retirado con la epoca del
+ * momento. La epoca global solo avanza cuando todos los lectores que estan
+ * leyendo ya la vieron, asi lo retirado en la epoca e se libera cuando la
+ * global llega a e + 2: para entonces terminaron todas las lecturas que lo
+ * pudieron encontrar. Los lectores son del proceso, compartidos por todos
+ * los hash concurrentes; cuando un hilo termina otro reutiliza el suyo.
+ */
+
+typedef union lector {
+    struct {
+        uint64_t epoca;             // 0 si no esta leyendo
+        bool en_uso;                // Tiene un hilo
+        union lector* siguiente;    // No cambia despues de agregarlo
+    } estado;
+    char relleno[2 * LINEA_CACHE];
+} lector_t;
+
+static uint64_t epoca_global = 1;
+static lector_t* lectores = NULL;   // Solo se agregan, al principio
+static pthread_key_t clave_lector;
+static pthread_once_t clave_lector_creada = PTHREAD_ONCE_INIT;
+static bool clave_lector_valida = false;
+
+static void soltar_lector(void* lector) {
+    __atomic_store_n(&((lector_t*) lector)->estado.en_uso, false, __ATOMIC_RELEASE);
+}
+
+static void crear_clave_lector(void) {
+    clave_lector_valida = !pthread_key_create(&clave_lector, soltar_lector);
+}
+
+/* Devuelve el lector del hilo, dandole uno la primera vez.
+ * Post: Devuelve NULL si no hubo memoria.
+ */
+static lector_t* lector_del_hilo(void) {
+    pthread_once(&clave_lector_creada, crear_clave_lector);
+    if(!clave_lector_valida) return NULL;
+
+    lector_t* lector = pthread_getspecific(clave_lector);
+    if(lector) return lector;
+
+    // Primero se busca uno de un hilo que termino.
+    for(lector = __atomic_load_n(&lectores, __ATOMIC_ACQUIRE); lector; lector = lector->estado.siguiente)
+    {
+        bool en_uso = false;
+        if(__atomic_compare_exchange_n(&lector->estado.en_uso, &en_uso, true, false, __ATOMIC_ACQUIRE, __ATOMIC_RELAXED))
+            break;
+    }
+    if(!lector)
+    {
+        void* memoria;
+        if(posix_memalign(&memoria, LINEA_CACHE, sizeof(lector_t))) return NULL;
+        lector = memoria;
+        lector->estado.epoca = 0;
+        lector->estado.en_uso = true;
+        lector->estado.siguiente = __atomic_load_n(&lectores, __ATOMIC_RELAXED);
+        while(!__atomic_compare_exchange_n(&lectores, &lector->estado.siguiente, lector, true,
+                                           __ATOMIC_RELEASE, __ATOMIC_RELAXED));
+    }
+    if(pthread_setspecific(clave_lector, lector))
+    {
+        soltar_lector(lector);
+        return NULL;
+    }
+    return lector;
+}
+
+/* Anuncia que el lector empieza a leer. La barrera hace que lo que lea
+ * despues no se adelante al anuncio.
+ */
+static void entrar(lector_t* lector) {
+    __atomic_store_n(&lector->estado.epoca, __atomic_load_n(&epoca_global, __ATOMIC_RELAXED), __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+}
+
+static void salir(lector_t* lector) {
+    __atomic_store_n(&lector->estado.epoca, 0, __ATOMIC_RELEASE);
+}
+
+/* Avanza la epoca global si todos los lectores que estan leyendo ya la
+ * vieron.
+ * Post: Devuelve la epoca global.
+ */
+static uint64_t avanzar_epoca(void) {
+    uint64_t epoca = __atomic_load_n(&epoca_global, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_SEQ_CST);
+
+    for(lector_t* lector = __atomic_load_n(&lectores, __ATOMIC_ACQUIRE); lector; lector = lector->estado.siguiente)
+    {
+        uint64_t suya = __atomic_load_n(&lector->estado.epoca, __ATOMIC_ACQUIRE);
+        if(suya && suya != epoca) return epoca;
+    }
+    if(__atomic_compare_exchange_n(&epoca_global, &epoca, epoca + 1, false, __ATOMIC_SEQ_CST, __ATOMIC_RELAXED))
+        return epoca + 1;
+    return epoca;
+}
+
+/* Libera una tabla con sus nodos, llamando a destruir_dato si no es NULL */
+static void tabla_liberar(tabla_t* tabla, hash_destruir_dato_t destruir_dato) {
+    for(size_t i = 0; i < tabla->largo; i++)
+    {
+        nodo_concurrente_t* nodo = tabla->posiciones[i];
+        while(nodo)
+        {
+            nodo_concurrente_t* siguiente = nodo->siguiente;
+            if(destruir_dato) destruir_dato(nodo->dato);
+            free(nodo);
+            nodo = siguiente;
+        }
+    }
+    free(tabla);
+}
+
+/* Libera los retirados de la franja que ya ningun lector puede ver.
+ * Pre: La franja esta tomada.
+ */
+static void reclamar(franja_t* franja) {
+    uint64_t epoca = avanzar_epoca();
+    retirado_t* retirados = franja->estado.retirados;
+    size_t cantidad = franja->estado.cantidad_retirados;
+
+    size_t liberados = 0;
+    while(liberados < cantidad && retirados[liberados].epoca + 2 <= epoca)
+        free(retirados[liberados++].puntero);
+
+    if(!liberados) return;
+    memmove(retirados, retirados + liberados, (cantidad - liberados) * sizeof(retirado_t));
+    franja->estado.cantidad_retirados -= liberados;
+}
+
+/* Deja lugar para anotar un retirado mas, liberando antes lo que ya se
+ * pueda. Se llama antes de sacar algo del hash, asi si no hay memoria la
+ * operacion no se hace y nada queda sin anotar.
+ * Pre: La franja esta tomada.
+ * Post: Devuelve false si no hubo memoria.
+ */
+static bool reservar_retiro(franja_t* franja) {
+    if(franja->estado.cantidad_retirados < franja->estado.capacidad_retirados) return true;
+
+    reclamar(franja);
+    if(franja->estado.cantidad_retirados < franja->estado.capacidad_retirados) return true;
+
+    size_t capacidad = 2 * franja->estado.capacidad_retirados + RECLAMAR_CADA;
+    retirado_t* retirados = realloc(franja->estado.retirados, capacidad * sizeof(retirado_t));
+    if(!retirados) return false;
+    franja->estado.retirados = retirados;
+    franja->estado.capacidad_retirados = capacidad;
+    return true;
+}
+
+/* Retira un nodo o una tabla que ya no es alcanzable desde el hash.
+ * Pre: La franja esta tomada y reservar_retiro le dejo lugar.
+ */
+static void retirar(franja_t* franja, void* puntero) {
+    retirado_t retirado = { puntero, __atomic_load_n(&epoca_global, __ATOMIC_SEQ_CST) };
+    franja->estado.retirados[franja->estado.cantidad_retirados++] = retirado;
+    if(franja->estado.cantidad_retirados % RECLAMAR_CADA == 0) reclamar(franja);
+}
+
+/*
+ * TABLA
+ */
+
+/* Devuelve los 'bits' bits mas altos del codigo */
+static size_t bits_altos(uint64_t codigo, unsigned bits) {
+    return bits ? (size_t) (codigo >> (64 - bits)) : 0;
+}
+
+/* Devuelve log2 de la menor potencia de 2 mayor o igual a n */
+static unsigned bits_para(size_t n) {
+    unsigned bits = 0;
+    while(((size_t) 1 << bits) < n) bits++;
+    return bits;
+}
+
+/* Devuelve los bits del largo que deja la carga en un cuarto de
+ * CARGA_MAXIMA, sin bajar de POSICIONES_POR_FRANJA por franja.
+ */
+static unsigned bits_de_largo(const hash_concurrente_t* hash, size_t cantidad) {
+    unsigned bits = bits_para(4 * cantidad / CARGA_MAXIMA);
+    unsigned minimo = hash->bits_franjas + bits_para(POSICIONES_POR_FRANJA);
+    return bits > minimo ? bits : minimo;
+}
+
+static tabla_t* tabla_crear(unsigned bits) {
+    size_t largo = (size_t) 1 << bits;
+    tabla_t* tabla = calloc(1, sizeof(tabla_t) + largo * sizeof(nodo_concurrente_t*));
+    if(!tabla) return NULL;
+
+    tabla->largo = largo;
+    tabla->bits = bits;
+    return tabla;
+}
+
+/* Pre: Alguna franja esta tomada. */
+static size_t posiciones_por_franja(const hash_concurrente_t* hash) {
+    return hash->tabla->largo >> hash->bits_franjas;
+}
+
+/* Devuelve si la franja tiene demasiadas claves para sus posiciones.
+ * Pre: La franja esta tomada.
+ */
+static bool sobrecargada(const hash_concurrente_t* hash, const franja_t* franja) {
+    return franja->estado.cantidad > CARGA_MAXIMA * posiciones_por_franja(hash);
+}
+
+/* Bloquea la franja de un codigo y la devuelve */
+static franja_t* tomar_franja(const hash_concurrente_t* hash, uint64_t codigo) {
+    franja_t* franja = &hash->franjas[bits_altos(codigo, hash->bits_franjas)];
+    pthread_mutex_lock(&franja->estado.mutex);
+    return franja;
+}
+
+static void soltar_franja(franja_t* franja) {
+    pthread_mutex_unlock(&franja->estado.mutex);
+}
+
+static void sumar_cantidad(franja_t* franja, size_t suma) {
+    __atomic_store_n(&franja->estado.cantidad, franja->estado.cantidad + suma, __ATOMIC_RELAXED);
+}
+
+/* Devuelve el enlace que apunta al nodo de la clave, o al final de la lista
+ * de su posicion si no esta. Solo los escritores cambian los enlaces, y
+ * siempre con la franja tomada.
+ * Pre: La franja del codigo esta tomada.
+ */
+static nodo_concurrente_t** buscar(const hash_concurrente_t* hash, const char* clave, size_t largo, uint64_t codigo) {
+    nodo_concurrente_t** enlace = &hash->tabla->posiciones[bits_altos(codigo, hash->tabla->bits)];
+    while(*enlace)
+    {
+        nodo_concurrente_t* nodo = *enlace;
+        if(nodo->codigo == codigo && nodo->largo == largo && !memcmp(nodo->clave, clave, largo))
+            return enlace;
+        enlace = &nodo->siguiente;
+    }
+    return enlace;
+}
+
+/* Busca la clave sin ningun mutex, leyendo los enlaces con atomicos.
+ * Pre: El hilo esta leyendo (ver entrar) o tiene la franja tomada.
+ */
+static nodo_concurrente_t* buscar_sin_bloqueo(const tabla_t* tabla, const char* clave, size_t largo, uint64_t codigo) {
+    nodo_concurrente_t* nodo = __atomic_load_n(&tabla->posiciones[bits_altos(codigo, tabla->bits)], __ATOMIC_ACQUIRE);
+    while(nodo)
+    {
+        if(nodo->codigo == codigo && nodo->largo == largo && !memcmp(nodo->clave, clave, largo))
+            return nodo;
+        nodo = __atomic_load_n(&nodo->siguiente, __ATOMIC_ACQUIRE);
+    }
+    return NULL;
+}
+
+static nodo_concurrente_t* nodo_crear(const char* clave, size_t largo, uint64_t codigo) {
+    nodo_concurrente_t* nodo = malloc(sizeof(nodo_concurrente_t) + largo + 1);
+    if(!nodo) return NULL;
+
+    nodo->siguiente = NULL;
+    nodo->dato = NULL;
+    nodo->codigo = codigo;
+    nodo->largo = largo;
+    memcpy(nodo->clave, clave, largo);
+    nodo->clave[largo] = '\0';
+    return nodo;
+}
+
+static void tomar_todas(const hash_concurrente_t* hash) {
+    for(size_t i = 0; i < hash->cantidad_franjas; i++)
+        pthread_mutex_lock(&hash->franjas[i].estado.mutex);
+}
+
+static void soltar_todas(const hash_concurrente_t* hash) {
+    for(size_t i = hash->cantidad_franjas; i > 0; i--)
+        pthread_mutex_unlock(&hash->franjas[i - 1].estado.mutex);
+}
+
+/* Mueve los nodos a una tabla de 2^bits posiciones y la publica. Los nodos
+ * no se copian: se reenlazan de a uno al principio de la lista de su
+ * posicion nueva. Un lector que esta en la tabla vieja puede seguir enlaces
+ * ya cambiados; como un nodo movido solo apunta a nodos movidos antes, la
+ * lectura termina, pero se puede saltear claves. Por eso reubicaciones queda
+ * impar mientras se mueven y buscar_dato no confia en no haber encontrado
+ * una clave si cambio. La tabla vieja se retira sin sus nodos, y enseguida
+ * se libera lo retirado que ya nadie ve (entre ello, las tablas de las
+ * redimensiones anteriores) sin esperar a juntar RECLAMAR_CADA. Si no hay
+ * memoria el hash queda como estaba, que sigue funcionando.
+ * Pre: Todas las franjas estan tomadas.
+ */
+static void reubicar(hash_concurrente_t* hash, unsigned bits) {
+    franja_t* franja = &hash->franjas[0];
+    if(!reservar_retiro(franja)) return;
+
+    tabla_t* vieja = hash->tabla;
+    tabla_t* nueva = tabla_crear(bits);
+    if(!nueva) return;
+
+    // Un lector que ve un enlace cambiado ve tambien la cuenta impar.
+    __atomic_store_n(&hash->reubicaciones, hash->reubicaciones + 1, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+
+    for(size_t i = 0; i < vieja->largo; i++)
+    {
+        nodo_concurrente_t* nodo = vieja->posiciones[i];
+        while(nodo)
+        {
+            nodo_concurrente_t* siguiente = nodo->siguiente;
+            nodo_concurrente_t** lista = &nueva->posiciones[bits_altos(nodo->codigo, bits)];
+            __atomic_store_n(&nodo->siguiente, *lista, __ATOMIC_RELEASE);
+            *lista = nodo;
+            nodo = siguiente;
+        }
+    }
+
+    __atomic_store_n(&hash->tabla, nueva, __ATOMIC_RELEASE);
+    __atomic_store_n(&hash->reubicaciones, hash->reubicaciones + 1, __ATOMIC_RELEASE);
+    retirar(franja, vieja);
+    reclamar(franja);
+}
+
+/* Toma todas las franjas y redimensiona si sigue haciendo falta: otro hilo
+ * pudo haberlo hecho mientras se esperaban. Para crecer alcanza con que la
+ * franja que lo pidio siga sobrecargada; el largo al menos se duplica, asi
+ * tambien se reparte una franja con mas claves que las demas.
+ */
+static void redimensionar(hash_concurrente_t* hash, const franja_t* pedida, bool crecer) {
+    tomar_todas(hash);
+
+    size_t cantidad = 0;
+    for(size_t i = 0; i < hash->cantidad_franjas; i++)
+        cantidad += hash->franjas[i].estado.cantidad;
+    unsigned bits = bits_de_largo(hash, cantidad);
+    const tabla_t* tabla = hash->tabla;
+
+    if(crecer && sobrecargada(hash, pedida))
+        reubicar(hash, bits > tabla->bits ? bits : tabla->bits + 1);
+    else if(!crecer && bits < tabla->bits && cantidad * CARGA_MINIMA < tabla->largo)
+        reubicar(hash, bits);
+
+    soltar_todas(hash);
+}
+
+hash_concurrente_t *hash_concurrente_crear_con_franjas(hash_destruir_dato_t destruir_dato, size_t franjas) {
+    if(!franjas) franjas = FRANJAS_POR_DEFECTO;
+    if(franjas > FRANJAS_MAXIMAS) franjas = FRANJAS_MAXIMAS;
+
+    hash_concurrente_t* hash = malloc(sizeof(hash_concurrente_t));
+    if(!hash) return NULL;
+
+    hash->bits_franjas = bits_para(franjas);
+    hash->cantidad_franjas = (size_t) 1 << hash->bits_franjas;
+    hash->reubicaciones = 0;
+    hash->semilla = hash_rapido_semilla(hash);
+    hash->destruir_dato = destruir_dato;
+    hash->franjas = malloc(hash->cantidad_franjas * sizeof(franja_t));
+    hash->tabla = tabla_crear(bits_de_largo(hash, 0));
+    if(!hash->franjas || !hash->tabla)
+    {
+        free(hash->tabla);
+        free(hash->franjas);
+        free(hash);
+        return NULL;
+    }
+
+    for(size_t i = 0; i < hash->cantidad_franjas; i++)
+    {
+        hash->franjas[i].estado.cantidad = 0;
+        hash->franjas[i].estado.retirados = NULL;
+        hash->franjas[i].estado.cantidad_retirados = 0;
+        hash->franjas[i].estado.capacidad_retirados = 0;
+        if(pthread_mutex_init(&hash->franjas[i].estado.mutex, NULL))
+        {
+            while(i > 0) pthread_mutex_destroy(&hash->franjas[--i].estado.mutex);
+            free(hash->tabla);
+            free(hash->franjas);
+            free(hash);
+            return NULL;
+        }
+    }
+    return hash;
+}
+
+hash_concurrente_t *hash_concurrente_crear(hash_destruir_dato_t destruir_dato) {
+    return hash_concurrente_crear_con_franjas(destruir_dato, 0);
+}
+
+/* Busca la clave y, si no esta, la guarda con dato NULL.
+ * Post: Devuelve el nodo con la franja tomada (en franja), o NULL sin
+ * ninguna franja tomada si no hubo memoria. En insertado queda si la clave
+ * es nueva.
+ */
+static nodo_concurrente_t* buscar_o_insertar(hash_concurrente_t* hash, const char* clave, size_t largo, franja_t** franja, bool* insertado) {
+    uint64_t codigo = hash_rapido(clave, largo, hash->semilla);
+    *franja = tomar_franja(hash, codigo);
+    *insertado = false;
+
+    nodo_concurrente_t** enlace = buscar(hash, clave, largo, codigo);
+    if(*enlace) return *enlace;
+
+    nodo_concurrente_t* nodo = nodo_crear(clave, largo, codigo);
+    if(!nodo)
+    {
+        soltar_franja(*franja);
+        return NULL;
+    }
+    // Se publica completo: un lector que lo encuentra ya ve la clave.
+    __atomic_store_n(enlace, nodo, __ATOMIC_RELEASE);
+    sumar_cantidad(*franja, 1);
+    *insertado = true;
+    return nodo;
+}
+
+bool hash_concurrente_guardar_n(hash_concurrente_t *hash, const char *clave, size_t largo, void *dato) {
+    if(!hash || !clave) return false;
+
+    franja_t* franja;
+    bool insertado;
+    nodo_concurrente_t* nodo = buscar_o_insertar(hash, clave, largo, &franja, &insertado);
+    if(!nodo) return false;
+
+    void* anterior = nodo->dato;
+    __atomic_store_n(&nodo->dato, dato, __ATOMIC_RELEASE);
+    bool crecer = insertado && sobrecargada(hash, franja);
+    soltar_franja(franja);
+
+    if(!insertado && hash->destruir_dato) hash->destruir_dato(anterior);
+    if(crecer) redimensionar(hash, franja, true);
+    return true;
+}
+
+bool hash_concurrente_guardar(hash_concurrente_t *hash, const char *clave, void *dato) {
+    return clave && hash_concurrente_guardar_n(hash, clave, strlen(clave), dato);
+}
+
+bool hash_concurrente_obtener_o_insertar(hash_concurrente_t *hash, const char *clave, void ***dato, bool *insertado) {
+    if(!hash || !clave || !dato) return false;
+
+    franja_t* franja;
+    bool nueva;
+    nodo_concurrente_t* nodo = buscar_o_insertar(hash, clave, strlen(clave), &franja, &nueva);
+    if(!nodo) return false;
+
+    *dato = &nodo->dato;
+    if(insertado) *insertado = nueva;
+    bool crecer = nueva && sobrecargada(hash, franja);
+    soltar_franja(franja);
+
+    if(crecer) redimensionar(hash, franja, true);
+    return true;
+}
+
+bool hash_concurrente_actualizar(hash_concurrente_t *hash, const char *clave, hash_actualizar_t actualizar, void *extra) {
+    if(!hash || !clave || !actualizar) return false;
+
+    franja_t* franja;
+    bool insertado;
+    nodo_concurrente_t* nodo = buscar_o_insertar(hash, clave, strlen(clave), &franja, &insertado);
+    if(!nodo) return false;
+
+    __atomic_store_n(&nodo->dato, actualizar(nodo->dato, extra), __ATOMIC_RELEASE);
+    bool crecer = insertado && sobrecargada(hash, franja);
+    soltar_franja(franja);
+
+    if(crecer) redimensionar(hash, franja, true);
+    return true;
+}
+
+void *hash_concurrente_borrar_n(hash_concurrente_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return NULL;
+
+    uint64_t codigo = hash_rapido(clave, largo, hash->semilla);
+    franja_t* franja = tomar_franja(hash, codigo);
+
+    nodo_concurrente_t** enlace = buscar(hash, clave, largo, codigo);
+    nodo_concurrente_t* nodo = *enlace;
+    if(!nodo || !reservar_retiro(franja))
+    {
+        soltar_franja(franja);
+        return NULL;
+    }
+    // El nodo conserva su siguiente: un lector que esta en el puede seguir.
+    __atomic_store_n(enlace, nodo->siguiente, __ATOMIC_RELEASE);
+    void* dato = nodo->dato;
+    retirar(franja, nodo);
+    sumar_cantidad(franja, (size_t) -1);
+    bool achicar = franja->estado.cantidad * CARGA_MINIMA < posiciones_por_franja(hash)
+                   && hash->tabla->bits > bits_de_largo(hash, 0);
+    size_t largo_tabla = hash->tabla->largo;
+    soltar_franja(franja);
+
+    // La franja vacia sola no alcanza: se mira la cantidad total.
+    if(achicar && hash_concurrente_cantidad(hash) * CARGA_MINIMA < largo_tabla)
+        redimensionar(hash, franja, false);
+    return dato;
+}
+
+void *hash_concurrente_borrar(hash_concurrente_t *hash, const char *clave) {
+    return clave ? hash_concurrente_borrar_n(hash, clave, strlen(clave)) : NULL;
+}
+
+/* Busca la clave sin tomar mutex. Si la encuentra alcanza, pero que no este
+ * solo vale si ningun reubicar movio nodos mientras se buscaba; si no (o si
+ * el hilo no pudo tener un lector porque no hubo memoria) se busca de nuevo
+ * con la franja tomada.
+ * Post: Devuelve si la clave esta y deja su dato en dato.
+ */
+static bool buscar_dato(const hash_concurrente_t* hash, const char* clave, size_t largo, void** dato) {
+    uint64_t codigo = hash_rapido(clave, largo, hash->semilla);
+    lector_t* lector = lector_del_hilo();
+    nodo_concurrente_t* nodo;
+
+    if(lector)
+    {
+        entrar(lector);
+        uint64_t reubicaciones = __atomic_load_n(&hash->reubicaciones, __ATOMIC_ACQUIRE);
+        nodo = buscar_sin_bloqueo(__atomic_load_n(&hash->tabla, __ATOMIC_ACQUIRE), clave, largo, codigo);
+        *dato = nodo ? __atomic_load_n(&nodo->dato, __ATOMIC_ACQUIRE) : NULL;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        bool vale = nodo || (reubicaciones % 2 == 0
+                             && __atomic_load_n(&hash->reubicaciones, __ATOMIC_RELAXED) == reubicaciones);
+        salir(lector);
+        if(vale) return nodo != NULL;
+    }
+
+    franja_t* franja = tomar_franja(hash, codigo);
+    nodo = buscar_sin_bloqueo(hash->tabla, clave, largo, codigo);
+    *dato = nodo ? nodo->dato : NULL;
+    soltar_franja(franja);
+    return nodo != NULL;
+}
+
+void *hash_concurrente_obtener_n(const hash_concurrente_t *hash, const char *clave, size_t largo) {
+    void* dato = NULL;
+    if(hash && clave) buscar_dato(hash, clave, largo, &dato);
+    return dato;
+}
+
+bool hash_concurrente_pertenece_n(const hash_concurrente_t *hash, const char *clave, size_t largo) {
+    void* dato;
+    return hash && clave && buscar_dato(hash, clave, largo, &dato);
+}
+
+void *hash_concurrente_obtener(const hash_concurrente_t *hash, const char *clave) {
+    return clave ? hash_concurrente_obtener_n(hash, clave, strlen(clave)) : NULL;
+}
+
+bool hash_concurrente_pertenece(const hash_concurrente_t *hash, const char *clave) {
+    return clave && hash_concurrente_pertenece_n(hash, clave, strlen(clave));
+}
+
+size_t hash_concurrente_cantidad(const hash_concurrente_t *hash) {
+    if(!hash) return 0;
+
+    size_t cantidad = 0;
+    for(size_t i = 0; i < hash->cantidad_franjas; i++)
+        cantidad += __atomic_load_n(&hash->franjas[i].estado.cantidad, __ATOMIC_RELAXED);
+    return cantidad;
+}
+
+void hash_concurrente_iterar(const hash_concurrente_t *hash, hash_visitar_t visitar, void *extra) {
+    if(!hash || !visitar) return;
+
+    tomar_todas(hash);
+    const tabla_t* tabla = hash->tabla;
+    bool seguir = true;
+    for(size_t i = 0; i < tabla->largo && seguir; i++)
+        for(nodo_concurrente_t* nodo = tabla->posiciones[i]; nodo && seguir; nodo = nodo->siguiente)
+            seguir = visitar(nodo->clave, nodo->largo, nodo->dato, extra);
+    soltar_todas(hash);
+}
+
+/*
+ * ITERADOR
+ * Recorre las franjas en orden teniendo tomada solo la actual: como las
+ * posiciones de una franja son contiguas y nadie redimensiona mientras esta
+ * tomada, ve cada franja como estaba mientras la recorria. Entre una franja y
+ * la siguiente el hash puede redimensionarse, pero las claves no cambian de
+ * franja, asi que cada clave que no se guarda ni borra se ve una sola vez.
+ */
+
+/* Lleva el iterador al primer nodo desde su posicion inclusive, soltando las
+ * franjas que termina y tomando la siguiente. Al final no queda ninguna
+ * tomada.
+ */
+static void iter_buscar(hash_concurrente_iter_t* iter) {
+    const hash_concurrente_t* hash = iter->hash;
+    iter->nodo = NULL;
+
+    while(iter->franja)
+    {
+        size_t fin = (iter->numero + 1) * posiciones_por_franja(hash);
+        for(; iter->posicion < fin; iter->posicion++)
+            if((iter->nodo = hash->tabla->posiciones[iter->posicion])) return;
+
+        soltar_franja(iter->franja);
+        iter->franja = NULL;
+        if(++iter->numero == hash->cantidad_franjas) return;
+
+        iter->franja = &hash->franjas[iter->numero];
+        pthread_mutex_lock(&iter->franja->estado.mutex);
+        iter->posicion = iter->numero * posiciones_por_franja(hash);
+    }
+}
+
+hash_concurrente_iter_t *hash_concurrente_iter_crear(const hash_concurrente_t *hash) {
+    if(!hash) return NULL;
+
+    hash_concurrente_iter_t* iter = malloc(sizeof(hash_concurrente_iter_t));
+    if(!iter) return NULL;
+
+    iter->hash = hash;
+    iter->numero = 0;
+    iter->posicion = 0;
+    iter->franja = &hash->franjas[0];
+    pthread_mutex_lock(&iter->franja->estado.mutex);
+    iter_buscar(iter);
+    return iter;
+}
+
+bool hash_concurrente_iter_avanzar(hash_concurrente_iter_t *iter) {
+    if(hash_concurrente_iter_al_final(iter)) return false;
+
+    if(!(iter->nodo = iter->nodo->siguiente))
+    {
+        iter->posicion++;
+        iter_buscar(iter);
+    }
+    return !hash_concurrente_iter_al_final(iter);
+}
+
+const char *hash_concurrente_iter_ver_actual(const hash_concurrente_iter_t *iter) {
+    return hash_concurrente_iter_al_final(iter) ? NULL : iter->nodo->clave;
+}
+
+size_t hash_concurrente_iter_ver_largo(const hash_concurrente_iter_t *iter) {
+    return hash_concurrente_iter_al_final(iter) ? 0 : iter->nodo->largo;
+}
+
+void *hash_concurrente_iter_ver_dato(const hash_concurrente_iter_t *iter) {
+    return hash_concurrente_iter_al_final(iter) ? NULL : iter->nodo->dato;
+}
+
+bool hash_concurrente_iter_al_final(const hash_concurrente_iter_t *iter) {
+    return !iter || !iter->nodo;
+}
+
+void hash_concurrente_iter_destruir(hash_concurrente_iter_t *iter) {
+    if(!iter) return;
+    if(iter->franja) soltar_franja(iter->franja);
+    free(iter);
+}
+
+void hash_concurrente_destruir(hash_concurrente_t *hash) {
+    if(!hash) return;
+
+    for(size_t i = 0; i < hash->cantidad_franjas; i++)
+    {
+        franja_t* franja = &hash->franjas[i];
+        for(size_t j = 0; j < franja->estado.cantidad_retirados; j++)
+            free(franja->estado.retirados[j].puntero);
+        free(franja->estado.retirados);
+        pthread_mutex_destroy(&franja->estado.mutex);
+    }
+    tabla_liberar(hash->tabla, hash->destruir_dato);
+    free(hash->franjas);
+    free(hash);
+}
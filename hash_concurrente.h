@@ -0,0 +1,104 @@
+#ifndef HASH_CONCURRENTE_H
+#define HASH_CONCURRENTE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "hash.h"
+
+/*
+ * HASH CONCURRENTE
+ * Hash abierto que se puede usar desde varios hilos a la vez sin un mutex
+ * global. Las posiciones del vector se reparten en franjas contiguas, cada
+ * una con su mutex y su cantidad de claves: una operacion solo bloquea la
+ * franja de su clave, asi operaciones sobre franjas distintas no se esperan.
+ * La posicion sale de los bits altos del codigo y la franja de los mas altos
+ * de esos, por lo que una clave no cambia de franja al redimensionar. Para
+ * redimensionar se toman todas las franjas en orden.
+ * Obtener y pertenece no toman ningun mutex ni escriben memoria compartida:
+ * los escritores publican los cambios con operaciones atomicas, y los nodos
+ * borrados y los vectores viejos se liberan recien cuando ningun lector los
+ * puede estar viendo (reclamacion por epocas). Al redimensionar los nodos
+ * pasan a la tabla nueva sin copiarse; una busqueda sin mutex que no
+ * encuentra la clave mientras se movian la busca de nuevo con su franja.
+ */
+
+struct hash_concurrente;
+typedef struct hash_concurrente hash_concurrente_t;
+
+struct hash_concurrente_iter;
+typedef struct hash_concurrente_iter hash_concurrente_iter_t;
+
+/* Crea el hash con la cantidad de franjas por defecto */
+hash_concurrente_t *hash_concurrente_crear(hash_destruir_dato_t destruir_dato);
+
+/* Crea el hash con la cantidad de franjas indicada (0 para la por defecto),
+ * redondeada a una potencia de 2. Conviene que sean bastantes mas que los
+ * hilos que lo usan.
+ * Post: Devuelve NULL si no hubo memoria.
+ */
+hash_concurrente_t *hash_concurrente_crear_con_franjas(hash_destruir_dato_t destruir_dato, size_t franjas);
+
+/* Guardar, borrar, obtener y pertenece como los de hash.h. Cada uno es
+ * atomico respecto de los demas. guardar llama a destruir_dato con el dato
+ * reemplazado fuera del mutex; obtener no impide que otro hilo lo reemplace
+ * o lo borre mientras se usa el dato devuelto. borrar necesita memoria para
+ * anotar el nodo hasta poder liberarlo: si no hay, deja la clave y devuelve
+ * NULL.
+ */
+bool hash_concurrente_guardar(hash_concurrente_t *hash, const char *clave, void *dato);
+void *hash_concurrente_borrar(hash_concurrente_t *hash, const char *clave);
+void *hash_concurrente_obtener(const hash_concurrente_t *hash, const char *clave);
+bool hash_concurrente_pertenece(const hash_concurrente_t *hash, const char *clave);
+
+/* Versiones que reciben el largo de la clave, como las _n de hash.h */
+bool hash_concurrente_guardar_n(hash_concurrente_t *hash, const char *clave, size_t largo, void *dato);
+void *hash_concurrente_borrar_n(hash_concurrente_t *hash, const char *clave, size_t largo);
+void *hash_concurrente_obtener_n(const hash_concurrente_t *hash, const char *clave, size_t largo);
+bool hash_concurrente_pertenece_n(const hash_concurrente_t *hash, const char *clave, size_t largo);
+
+/* Como hash_obtener_o_insertar. Los nodos no se mueven de memoria al
+ * redimensionar, asi que la direccion vale hasta que se borre la clave.
+ * Usarla mientras otros hilos guardan o actualizan la misma clave es una
+ * carrera: para eso esta hash_concurrente_actualizar.
+ * Post: Devuelve false si no hubo memoria.
+ */
+bool hash_concurrente_obtener_o_insertar(hash_concurrente_t *hash, const char *clave, void ***dato, bool *insertado);
+
+/* Como hash_actualizar, pero la lectura y el reemplazo son una sola
+ * operacion atomica: sirve para contar o acumular desde varios hilos.
+ * actualizar se llama con la franja bloqueada y no puede usar el hash.
+ * Post: Devuelve false si no hubo memoria.
+ */
+bool hash_concurrente_actualizar(hash_concurrente_t *hash, const char *clave, hash_actualizar_t actualizar, void *extra);
+
+/* Devuelve la cantidad de claves, sumando la de cada franja. Mientras otros
+ * hilos guardan o borran es solo aproximada.
+ */
+size_t hash_concurrente_cantidad(const hash_concurrente_t *hash);
+
+/* Itera el hash como hash_iterar, con todas las franjas bloqueadas: ve una
+ * foto del hash y los demas hilos esperan hasta que termine. visitar no
+ * puede usar el hash.
+ */
+void hash_concurrente_iterar(const hash_concurrente_t *hash, hash_visitar_t visitar, void *extra);
+
+/* Iterador del hash. Tiene tomada la franja que esta recorriendo (una sola a
+ * la vez), asi que los demas hilos solo esperan para escribir en esa. Se
+ * usa desde un solo hilo, que mientras exista no puede usar el hash. Ve
+ * una sola vez cada clave que nadie guarda ni borra mientras tanto.
+ */
+hash_concurrente_iter_t *hash_concurrente_iter_crear(const hash_concurrente_t *hash);
+bool hash_concurrente_iter_avanzar(hash_concurrente_iter_t *iter);
+const char *hash_concurrente_iter_ver_actual(const hash_concurrente_iter_t *iter);
+size_t hash_concurrente_iter_ver_largo(const hash_concurrente_iter_t *iter);
+void *hash_concurrente_iter_ver_dato(const hash_concurrente_iter_t *iter);
+bool hash_concurrente_iter_al_final(const hash_concurrente_iter_t *iter);
+void hash_concurrente_iter_destruir(hash_concurrente_iter_t *iter);
+
+/* Destruye el hash como hash_destruir.
+ * Pre: Ningun otro hilo lo esta usando.
+ */
+void hash_concurrente_destruir(hash_concurrente_t *hash);
+
+#endif // HASH_CONCURRENTE_H
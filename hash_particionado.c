@@ -0,0 +1,544 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "hash_particionado.h"
+#include "hash_rapido.h"
+#include "hilos.h"
+
+#define PARTICIONES_POR_DEFECTO 16
+#define PARTICIONES_MAXIMAS 4096
+#define LINEA_CACHE 64
+
+/* Hash, cerrojo y cantidad de una particion. Las lecturas toman el cerrojo
+ * compartido y las escrituras exclusivo. El relleno separa las particiones
+ * en lineas de cache distintas.
+ */
+typedef union particion {
+    struct {
+        hash_t* hash;
+        pthread_rwlock_t cerrojo;
+        size_t cantidad;            // Copia de hash_cantidad para leerla sin el cerrojo
+    } estado;
+    char relleno[2 * LINEA_CACHE];
+} particion_t;
+
+struct hash_particionado {
+    particion_t* particiones;
+    size_t cantidad_particiones;    // Potencia de 2
+    unsigned bits;                  // log2(cantidad_particiones)
+    uint64_t semilla;               // La misma en todas las particiones
+};
+
+/* Iterador: el recorrido de una particion por vez */
+struct hash_particionado_iter {
+    const hash_particionado_t* hash;
+    size_t particion;
+    hash_recorrido_t recorrido;
+};
+
+/* Devuelve el codigo de la clave. Todas las particiones tienen la misma
+ * funcion y la misma semilla, asi que el de la primera sirve para todas:
+ * con el se elige la particion y se le pasa a su hash, que no lo vuelve a
+ * calcular.
+ */
+static uint64_t codigo_de(const hash_particionado_t* hash, const char* clave, size_t largo) {
+    return hash_codigo(hash->particiones[0].estado.hash, clave, largo);
+}
+
+/* Devuelve la particion de un codigo, por sus bits altos */
+static particion_t* particion_de(const hash_particionado_t* hash, uint64_t codigo) {
+    if(!hash->bits) return hash->particiones;
+    return &hash->particiones[codigo >> (64 - hash->bits)];
+}
+
+/* Toma la particion del codigo para escribir */
+static particion_t* tomar(const hash_particionado_t* hash, uint64_t codigo) {
+    particion_t* particion = particion_de(hash, codigo);
+    pthread_rwlock_wrlock(&particion->estado.cerrojo);
+    return particion;
+}
+
+/* Toma la particion del codigo para leer, compartida con otros lectores */
+static particion_t* tomar_para_leer(const hash_particionado_t* hash, uint64_t codigo) {
+    particion_t* particion = particion_de(hash, codigo);
+    pthread_rwlock_rdlock(&particion->estado.cerrojo);
+    return particion;
+}
+
+/* Actualiza la cantidad de la particion y la suelta */
+static void soltar(particion_t* particion) {
+    __atomic_store_n(&particion->estado.cantidad, hash_cantidad(particion->estado.hash), __ATOMIC_RELAXED);
+    pthread_rwlock_unlock(&particion->estado.cerrojo);
+}
+
+static void soltar_lectura(particion_t* particion) {
+    pthread_rwlock_unlock(&particion->estado.cerrojo);
+}
+
+/* Libera las primeras 'creadas' particiones y el hash */
+static void liberar(hash_particionado_t* hash, size_t creadas) {
+    for(size_t i = 0; i < creadas; i++)
+    {
+        hash_destruir(hash->particiones[i].estado.hash);
+        pthread_rwlock_destroy(&hash->particiones[i].estado.cerrojo);
+    }
+    free(hash->particiones);
+    free(hash);
+}
+
+hash_particionado_t *hash_particionado_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones,
+                                                          size_t particiones) {
+    if(!particiones) particiones = PARTICIONES_POR_DEFECTO;
+    if(particiones > PARTICIONES_MAXIMAS) particiones = PARTICIONES_MAXIMAS;
+
+    hash_particionado_t* hash = malloc(sizeof(hash_particionado_t));
+    if(!hash) return NULL;
+
+    hash->bits = 0;
+    while(((size_t) 1 << hash->bits) < particiones) hash->bits++;
+    hash->cantidad_particiones = (size_t) 1 << hash->bits;
+    hash->semilla = hash_rapido_semilla(hash);
+    hash->particiones = malloc(hash->cantidad_particiones * sizeof(particion_t));
+    if(!hash->particiones)
+    {
+        free(hash);
+        return NULL;
+    }
+
+    hash_opciones_t de_particion;
+    if(opciones) de_particion = *opciones;
+    else hash_opciones_por_defecto(&de_particion);
+    de_particion.capacidad = (de_particion.capacidad + hash->cantidad_particiones - 1) / hash->cantidad_particiones;
+
+    for(size_t i = 0; i < hash->cantidad_particiones; i++)
+    {
+        particion_t* particion = &hash->particiones[i];
+        particion->estado.cantidad = 0;
+        particion->estado.hash = hash_crear_con_opciones(destruir_dato, &de_particion);
+        if(!particion->estado.hash)
+        {
+            liberar(hash, i);
+            return NULL;
+        }
+        hash_elegir_semilla(particion->estado.hash, hash->semilla);
+        if(pthread_rwlock_init(&particion->estado.cerrojo, NULL))
+        {
+            hash_destruir(particion->estado.hash);
+            liberar(hash, i);
+            return NULL;
+        }
+    }
+    return hash;
+}
+
+hash_particionado_t *hash_particionado_crear(hash_destruir_dato_t destruir_dato, size_t particiones) {
+    return hash_particionado_crear_con_opciones(destruir_dato, NULL, particiones);
+}
+
+bool hash_particionado_reservar(hash_particionado_t *hash, size_t cantidad) {
+    if(!hash) return false;
+
+    size_t por_particion = (cantidad + hash->cantidad_particiones - 1) / hash->cantidad_particiones;
+    bool ok = true;
+    for(size_t i = 0; i < hash->cantidad_particiones; i++)
+    {
+        particion_t* particion = &hash->particiones[i];
+        pthread_rwlock_wrlock(&particion->estado.cerrojo);
+        ok &= hash_reservar(particion->estado.hash, por_particion);
+        soltar(particion);
+    }
+    return ok;
+}
+
+bool hash_particionado_compactar(hash_particionado_t *hash) {
+    if(!hash) return false;
+
+    bool ok = true;
+    for(size_t i = 0; i < hash->cantidad_particiones; i++)
+    {
+        particion_t* particion = &hash->particiones[i];
+        pthread_rwlock_wrlock(&particion->estado.cerrojo);
+        ok &= hash_compactar(particion->estado.hash);
+        soltar(particion);
+    }
+    return ok;
+}
+
+bool hash_particionado_guardar_n(hash_particionado_t *hash, const char *clave, size_t largo, void *dato) {
+    if(!hash || !clave) return false;
+
+    uint64_t codigo = codigo_de(hash, clave, largo);
+    particion_t* particion = tomar(hash, codigo);
+    bool guardado = hash_guardar_hasheada(particion->estado.hash, clave, largo, codigo, dato);
+    soltar(particion);
+    return guardado;
+}
+
+void *hash_particionado_borrar_n(hash_particionado_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return NULL;
+
+    uint64_t codigo = codigo_de(hash, clave, largo);
+    particion_t* particion = tomar(hash, codigo);
+    void* dato = hash_borrar_hasheada(particion->estado.hash, clave, largo, codigo);
+    soltar(particion);
+    return dato;
+}
+
+void *hash_particionado_obtener_n(const hash_particionado_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return NULL;
+
+    uint64_t codigo = codigo_de(hash, clave, largo);
+    particion_t* particion = tomar_para_leer(hash, codigo);
+    void* dato = hash_obtener_hasheada(particion->estado.hash, clave, largo, codigo);
+    soltar_lectura(particion);
+    return dato;
+}
+
+bool hash_particionado_pertenece_n(const hash_particionado_t *hash, const char *clave, size_t largo) {
+    if(!hash || !clave) return false;
+
+    uint64_t codigo = codigo_de(hash, clave, largo);
+    particion_t* particion = tomar_para_leer(hash, codigo);
+    bool pertenece = hash_pertenece_hasheada(particion->estado.hash, clave, largo, codigo);
+    soltar_lectura(particion);
+    return pertenece;
+}
+
+bool hash_particionado_guardar(hash_particionado_t *hash, const char *clave, void *dato) {
+    return clave && hash_particionado_guardar_n(hash, clave, strlen(clave), dato);
+}
+
+void *hash_particionado_borrar(hash_particionado_t *hash, const char *clave) {
+    return clave ? hash_particionado_borrar_n(hash, clave, strlen(clave)) : NULL;
+}
+
+void *hash_particionado_obtener(const hash_particionado_t *hash, const char *clave) {
+    return clave ? hash_particionado_obtener_n(hash, clave, strlen(clave)) : NULL;
+}
+
+bool hash_particionado_pertenece(const hash_particionado_t *hash, const char *clave) {
+    return clave && hash_particionado_pertenece_n(hash, clave, strlen(clave));
+}
+
+bool hash_particionado_obtener_o_insertar(hash_particionado_t *hash, const char *clave, void ***dato, bool *insertado) {
+    if(insertado) *insertado = false;
+    if(!hash || !clave || !dato) return false;
+
+    size_t largo = strlen(clave);
+    uint64_t codigo = codigo_de(hash, clave, largo);
+    particion_t* particion = tomar(hash, codigo);
+    bool ok = hash_obtener_o_insertar_hasheada(particion->estado.hash, clave, largo, codigo, dato, insertado);
+    soltar(particion);
+    return ok;
+}
+
+bool hash_particionado_actualizar(hash_particionado_t *hash, const char *clave, hash_actualizar_t actualizar, void *extra) {
+    if(!hash || !clave || !actualizar) return false;
+
+    size_t largo = strlen(clave);
+    uint64_t codigo = codigo_de(hash, clave, largo);
+    particion_t* particion = tomar(hash, codigo);
+    void** dato;
+    bool actualizado = hash_obtener_o_insertar_hasheada(particion->estado.hash, clave, largo, codigo, &dato, NULL);
+    if(actualizado) *dato = actualizar(*dato, extra);
+    soltar(particion);
+    return actualizado;
+}
+
+/*
+ * LOTES
+ * Las claves del lote se agrupan por particion (manteniendo su orden) y cada
+ * particion se toma una sola vez para todas las suyas, con su codigo ya
+ * calculado.
+ */
+
+/* Claves de un lote agrupadas por particion: los indices de las de la
+ * particion p estan en orden[inicios[p]] a orden[inicios[p + 1] - 1], en el
+ * orden del lote. Las claves NULL no estan en ningun grupo.
+ */
+typedef struct grupos {
+    size_t* orden;
+    size_t* inicios;
+    uint64_t* codigos;              // Uno por clave del lote
+    size_t* largos;
+} grupos_t;
+
+static void grupos_liberar(grupos_t* grupos) {
+    free(grupos->orden);
+    free(grupos->inicios);
+    free(grupos->codigos);
+    free(grupos->largos);
+}
+
+/* Agrupa las claves por particion con un conteo: una pasada cuenta cuantas
+ * van a cada una y otra las ubica.
+ * Post: Devuelve false si no hubo memoria.
+ */
+static bool agrupar(const hash_particionado_t* hash, const char* const claves[], size_t cantidad, grupos_t* grupos) {
+    size_t particiones = hash->cantidad_particiones;
+    size_t lugar = cantidad ? cantidad : 1;
+    grupos->orden = malloc(lugar * sizeof(size_t));
+    grupos->inicios = calloc(particiones + 1, sizeof(size_t));
+    grupos->codigos = malloc(lugar * sizeof(uint64_t));
+    grupos->largos = malloc(lugar * sizeof(size_t));
+    if(!grupos->orden || !grupos->inicios || !grupos->codigos || !grupos->largos)
+    {
+        grupos_liberar(grupos);
+        return false;
+    }
+
+    for(size_t i = 0; i < cantidad; i++)
+    {
+        if(!claves[i]) continue;
+        grupos->largos[i] = strlen(claves[i]);
+        grupos->codigos[i] = codigo_de(hash, claves[i], grupos->largos[i]);
+        grupos->inicios[particion_de(hash, grupos->codigos[i]) - hash->particiones + 1]++;
+    }
+    for(size_t p = 0; p < particiones; p++)
+        grupos->inicios[p + 1] += grupos->inicios[p];
+
+    // Se ubican corriendo los inicios, que despues se vuelven a correr atras.
+    for(size_t i = 0; i < cantidad; i++)
+        if(claves[i]) grupos->orden[grupos->inicios[particion_de(hash, grupos->codigos[i]) - hash->particiones]++] = i;
+    for(size_t p = particiones; p > 0; p--)
+        grupos->inicios[p] = grupos->inicios[p - 1];
+    grupos->inicios[0] = 0;
+    return true;
+}
+
+bool hash_particionado_guardar_lote(hash_particionado_t *hash, const char *const claves[], void *const datos[], size_t cantidad) {
+    if(!hash || (!claves && cantidad)) return false;
+
+    grupos_t grupos;
+    if(!agrupar(hash, claves, cantidad, &grupos))
+    {
+        // Sin memoria para agrupar se guardan de a una.
+        bool todos = true;
+        for(size_t i = 0; i < cantidad; i++)
+            todos &= hash_particionado_guardar(hash, claves[i], datos ? datos[i] : NULL);
+        return todos;
+    }
+
+    bool todos = grupos.inicios[hash->cantidad_particiones] == cantidad;
+    for(size_t p = 0; p < hash->cantidad_particiones; p++)
+    {
+        size_t desde = grupos.inicios[p], hasta = grupos.inicios[p + 1];
+        if(desde == hasta) continue;
+
+        particion_t* particion = &hash->particiones[p];
+        pthread_rwlock_wrlock(&particion->estado.cerrojo);
+        hash_t* interno = particion->estado.hash;
+        // Si no se puede reservar, guardar agranda de a poco.
+        hash_reservar(interno, hash_cantidad(interno) + hasta - desde);
+        for(size_t j = desde; j < hasta; j++)
+        {
+            size_t i = grupos.orden[j];
+            todos &= hash_guardar_hasheada(interno, claves[i], grupos.largos[i], grupos.codigos[i], datos ? datos[i] : NULL);
+        }
+        soltar(particion);
+    }
+    grupos_liberar(&grupos);
+    return todos;
+}
+
+/* Busca las claves de un lote tomando cada particion una vez para leer.
+ * Deja en datos y encontradas (los que no son NULL) lo de cada clave.
+ * Post: Devuelve cuantas se encontraron.
+ */
+static size_t buscar_lote(const hash_particionado_t* hash, const char* const claves[], size_t cantidad,
+                          void* datos[], bool encontradas[]) {
+    grupos_t grupos;
+    size_t total = 0;
+    if(!agrupar(hash, claves, cantidad, &grupos))
+    {
+        // Sin memoria para agrupar se buscan de a una.
+        for(size_t i = 0; i < cantidad; i++)
+        {
+            bool esta = hash_particionado_pertenece(hash, claves[i]);
+            if(datos) datos[i] = esta ? hash_particionado_obtener(hash, claves[i]) : NULL;
+            if(encontradas) encontradas[i] = esta;
+            total += esta;
+        }
+        return total;
+    }
+
+    for(size_t i = 0; i < cantidad; i++)
+    {
+        if(datos) datos[i] = NULL;
+        if(encontradas) encontradas[i] = false;
+    }
+    for(size_t p = 0; p < hash->cantidad_particiones; p++)
+    {
+        size_t desde = grupos.inicios[p], hasta = grupos.inicios[p + 1];
+        if(desde == hasta) continue;
+
+        particion_t* particion = &hash->particiones[p];
+        pthread_rwlock_rdlock(&particion->estado.cerrojo);
+        for(size_t j = desde; j < hasta; j++)
+        {
+            size_t i = grupos.orden[j];
+            const hash_t* interno = particion->estado.hash;
+            bool esta = hash_pertenece_hasheada(interno, claves[i], grupos.largos[i], grupos.codigos[i]);
+            if(datos && esta) datos[i] = hash_obtener_hasheada(interno, claves[i], grupos.largos[i], grupos.codigos[i]);
+            if(encontradas) encontradas[i] = esta;
+            total += esta;
+        }
+        soltar_lectura(particion);
+    }
+    grupos_liberar(&grupos);
+    return total;
+}
+
+size_t hash_particionado_obtener_lote(const hash_particionado_t *hash, const char *const claves[], size_t cantidad, void *resultados[]) {
+    if(!hash || !claves || !resultados) return 0;
+    return buscar_lote(hash, claves, cantidad, resultados, NULL);
+}
+
+size_t hash_particionado_pertenece_lote(const hash_particionado_t *hash, const char *const claves[], size_t cantidad, bool resultados[]) {
+    if(!hash || !claves || !resultados) return 0;
+    return buscar_lote(hash, claves, cantidad, NULL, resultados);
+}
+
+size_t hash_particionado_cantidad(const hash_particionado_t *hash) {
+    if(!hash) return 0;
+
+    size_t cantidad = 0;
+    for(size_t i = 0; i < hash->cantidad_particiones; i++)
+        cantidad += __atomic_load_n(&hash->particiones[i].estado.cantidad, __ATOMIC_RELAXED);
+    return cantidad;
+}
+
+/* Aplica visitar y anota si corto la iteracion */
+typedef struct visita {
+    hash_visitar_t visitar;
+    void* extra;
+    bool cortada;
+} visita_t;
+
+static bool visitar_particion(const char* clave, size_t largo, void* dato, void* extra) {
+    visita_t* visita = extra;
+    visita->cortada = !visita->visitar(clave, largo, dato, visita->extra);
+    return !visita->cortada;
+}
+
+void hash_particionado_iterar(const hash_particionado_t *hash, hash_visitar_t visitar, void *extra) {
+    if(!hash || !visitar) return;
+
+    visita_t visita = { visitar, extra, false };
+    for(size_t i = 0; i < hash->cantidad_particiones && !visita.cortada; i++)
+    {
+        particion_t* particion = &hash->particiones[i];
+        pthread_rwlock_rdlock(&particion->estado.cerrojo);
+        hash_iterar(particion->estado.hash, visitar_particion, &visita);
+        soltar_lectura(particion);
+    }
+}
+
+/* Iteracion repartida entre hilos: cada tarea es una particion, que se
+ * itera tomada para leer. cortada avisa a todas que visitar devolvio false.
+ */
+typedef struct iteracion_paralela {
+    const hash_particionado_t* hash;
+    hash_visitar_t visitar;
+    void* extra;
+    bool cortada;
+} iteracion_paralela_t;
+
+static bool visitar_en_paralelo(const char* clave, size_t largo, void* dato, void* extra) {
+    iteracion_paralela_t* iteracion = extra;
+    if(__atomic_load_n(&iteracion->cortada, __ATOMIC_RELAXED)) return false;
+    if(iteracion->visitar(clave, largo, dato, iteracion->extra)) return true;
+
+    __atomic_store_n(&iteracion->cortada, true, __ATOMIC_RELAXED);
+    return false;
+}
+
+static void iterar_particion(void* extra, size_t indice) {
+    iteracion_paralela_t* iteracion = extra;
+    if(__atomic_load_n(&iteracion->cortada, __ATOMIC_RELAXED)) return;
+
+    particion_t* particion = &iteracion->hash->particiones[indice];
+    pthread_rwlock_rdlock(&particion->estado.cerrojo);
+    hash_iterar(particion->estado.hash, visitar_en_paralelo, iteracion);
+    soltar_lectura(particion);
+}
+
+void hash_particionado_iterar_paralelo(const hash_particionado_t *hash, hash_visitar_t visitar, void *extra, size_t hilos) {
+    if(!hash || !visitar) return;
+
+    if(hilos > hash->cantidad_particiones) hilos = hash->cantidad_particiones;
+    hilos_t* trabajadores = hilos > 1 ? hilos_crear(hilos) : NULL;
+    iteracion_paralela_t iteracion = { hash, visitar, extra, false };
+    hilos_ejecutar(trabajadores, iterar_particion, &iteracion, hash->cantidad_particiones);
+    hilos_destruir(trabajadores);
+}
+
+void hash_particionado_destruir(hash_particionado_t *hash) {
+    if(!hash) return;
+    liberar(hash, hash->cantidad_particiones);
+}
+
+/* Iterador del hash particionado */
+
+/* Deja el recorrido en la primer clave desde la particion actual inclusive */
+static void buscar_proxima_particion(hash_particionado_iter_t* iter) {
+    const hash_particionado_t* hash = iter->hash;
+    while(iter->particion < hash->cantidad_particiones)
+    {
+        hash_recorrido_iniciar(&iter->recorrido, hash->particiones[iter->particion].estado.hash);
+        if(!hash_recorrido_al_final(&iter->recorrido)) return;
+        iter->particion++;
+    }
+}
+
+hash_particionado_iter_t *hash_particionado_iter_crear(const hash_particionado_t *hash) {
+    if(!hash) return NULL;
+
+    hash_particionado_iter_t* iter = malloc(sizeof(hash_particionado_iter_t));
+    if(!iter) return NULL;
+
+    iter->hash = hash;
+    iter->particion = 0;
+    buscar_proxima_particion(iter);
+    return iter;
+}
+
+bool hash_particionado_iter_al_final(const hash_particionado_iter_t *iter) {
+    return !iter || iter->particion >= iter->hash->cantidad_particiones;
+}
+
+bool hash_particionado_iter_avanzar(hash_particionado_iter_t *iter) {
+    if(hash_particionado_iter_al_final(iter)) return false;
+
+    if(!hash_recorrido_avanzar(&iter->recorrido))
+    {
+        iter->particion++;
+        buscar_proxima_particion(iter);
+    }
+    return !hash_particionado_iter_al_final(iter);
+}
+
+const char *hash_particionado_iter_ver_actual(const hash_particionado_iter_t *iter) {
+    if(hash_particionado_iter_al_final(iter)) return NULL;
+    return hash_recorrido_ver_actual(&iter->recorrido);
+}
+
+size_t hash_particionado_iter_ver_largo(const hash_particionado_iter_t *iter) {
+    if(hash_particionado_iter_al_final(iter)) return 0;
+    return hash_recorrido_ver_largo(&iter->recorrido);
+}
+
+void *hash_particionado_iter_ver_dato(const hash_particionado_iter_t *iter) {
+    if(hash_particionado_iter_al_final(iter)) return NULL;
+    return hash_recorrido_ver_dato(&iter->recorrido);
+}
+
+void hash_particionado_iter_destruir(hash_particionado_iter_t *iter) {
+    free(iter);
+}
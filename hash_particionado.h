@@ -0,0 +1,111 @@
+#ifndef HASH_PARTICIONADO_H
+#define HASH_PARTICIONADO_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+#include "hash.h"
+
+/*
+ * HASH PARTICIONADO
+ * Reparte las claves entre varios hash_t independientes (particiones) segun
+ * los bits altos de su codigo. Cada particion tiene su mutex, su carga y su
+ * redimension: una redimension reubica solo las claves de una particion y
+ * bloquea solo esa, y los hilos que escriben en particiones distintas no se
+ * esperan. Las lecturas toman la particion compartida, asi que no esperan a
+ * otras lecturas. El codigo de cada clave se calcula una sola vez: elige la
+ * particion y se le pasa a su hash. Ofrece las operaciones de hash.h salvo
+ * las de configuracion (que se eligen con las opciones al crearlo),
+ * hash_crear_con_lote, hash_iterar_parte y el recorrido.
+ */
+
+struct hash_particionado;
+struct hash_particionado_iter;
+
+typedef struct hash_particionado hash_particionado_t;
+typedef struct hash_particionado_iter hash_particionado_iter_t;
+
+/* Crea el hash con la cantidad de particiones indicada (0 para la por
+ * defecto), redondeada a una potencia de 2.
+ * Post: Devuelve NULL si no hubo memoria.
+ */
+hash_particionado_t *hash_particionado_crear(hash_destruir_dato_t destruir_dato, size_t particiones);
+
+/* Crea el hash con las opciones indicadas (NULL para las por defecto) para
+ * cada particion. La capacidad se reparte entre las particiones. Si hay
+ * allocator, lo usan todas a la vez y tiene que admitir varios hilos.
+ * Post: Devuelve NULL si no hubo memoria o si las opciones no son validas.
+ */
+hash_particionado_t *hash_particionado_crear_con_opciones(hash_destruir_dato_t destruir_dato, const hash_opciones_t *opciones,
+                                                          size_t particiones);
+
+/* Como hash_reservar, repartiendo cantidad entre las particiones.
+ * Post: Devuelve false si no hubo memoria; parte de las particiones puede
+ * haber quedado reservada.
+ */
+bool hash_particionado_reservar(hash_particionado_t *hash, size_t cantidad);
+
+/* Como hash_compactar, una particion por vez.
+ * Post: Devuelve false si alguna no se pudo compactar.
+ */
+bool hash_particionado_compactar(hash_particionado_t *hash);
+
+/* Operaciones de hash.h. Cada una bloquea solo la particion de su clave. La
+ * direccion de obtener_o_insertar vale como en hash.h, pero usarla mientras
+ * otros hilos guardan o borran en su particion es una carrera: para eso
+ * esta hash_particionado_actualizar.
+ */
+bool hash_particionado_guardar(hash_particionado_t *hash, const char *clave, void *dato);
+void *hash_particionado_borrar(hash_particionado_t *hash, const char *clave);
+void *hash_particionado_obtener(const hash_particionado_t *hash, const char *clave);
+bool hash_particionado_pertenece(const hash_particionado_t *hash, const char *clave);
+bool hash_particionado_obtener_o_insertar(hash_particionado_t *hash, const char *clave, void ***dato, bool *insertado);
+bool hash_particionado_actualizar(hash_particionado_t *hash, const char *clave, hash_actualizar_t actualizar, void *extra);
+
+bool hash_particionado_guardar_n(hash_particionado_t *hash, const char *clave, size_t largo, void *dato);
+void *hash_particionado_borrar_n(hash_particionado_t *hash, const char *clave, size_t largo);
+void *hash_particionado_obtener_n(const hash_particionado_t *hash, const char *clave, size_t largo);
+bool hash_particionado_pertenece_n(const hash_particionado_t *hash, const char *clave, size_t largo);
+
+/* Operaciones por lotes de hash.h. Agrupan las claves por particion y
+ * toman cada particion una sola vez; guardar reserva lugar en cada una para
+ * todas las suyas.
+ */
+bool hash_particionado_guardar_lote(hash_particionado_t *hash, const char *const claves[], void *const datos[], size_t cantidad);
+size_t hash_particionado_obtener_lote(const hash_particionado_t *hash, const char *const claves[], size_t cantidad, void *resultados[]);
+size_t hash_particionado_pertenece_lote(const hash_particionado_t *hash, const char *const claves[], size_t cantidad, bool resultados[]);
+
+/* Devuelve la cantidad de claves, sumando la de cada particion. Mientras
+ * otros hilos guardan o borran es solo aproximada.
+ */
+size_t hash_particionado_cantidad(const hash_particionado_t *hash);
+
+/* Itera el hash como hash_iterar, una particion por vez y con esa particion
+ * bloqueada. visitar no puede usar el hash.
+ */
+void hash_particionado_iterar(const hash_particionado_t *hash, hash_visitar_t visitar, void *extra);
+
+/* Como hash_iterar_paralelo: reparte las particiones entre hilos hilos (no
+ * mas que particiones) creados para la llamada, cada una tomada para leer
+ * mientras se itera. visitar se llama desde varios hilos a la vez.
+ */
+void hash_particionado_iterar_paralelo(const hash_particionado_t *hash, hash_visitar_t visitar, void *extra, size_t hilos);
+
+/* Destruye el hash como hash_destruir.
+ * Pre: Ningun otro hilo lo esta usando.
+ */
+void hash_particionado_destruir(hash_particionado_t *hash);
+
+/* Iterador que recorre todas las particiones. Como el de hash.h, deja de
+ * ser valido si se guarda o borra una clave, y no bloquea: mientras otros
+ * hilos escriben hay que usar hash_particionado_iterar.
+ */
+hash_particionado_iter_t *hash_particionado_iter_crear(const hash_particionado_t *hash);
+bool hash_particionado_iter_avanzar(hash_particionado_iter_t *iter);
+const char *hash_particionado_iter_ver_actual(const hash_particionado_iter_t *iter);
+size_t hash_particionado_iter_ver_largo(const hash_particionado_iter_t *iter);
+void *hash_particionado_iter_ver_dato(const hash_particionado_iter_t *iter);
+bool hash_particionado_iter_al_final(const hash_particionado_iter_t *iter);
+void hash_particionado_iter_destruir(hash_particionado_iter_t *iter);
+
+#endif // HASH_PARTICIONADO_H
@@ -0,0 +1,296 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#include "hash_rapido.h"
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define RAPIDO_X86
+#include <immintrin.h>
+#endif
+
+#define FRANJA 64                   // Bytes por franja: 8 carriles de 8 bytes
+#define FRANJAS_POR_BLOQUE 16       // Al final de cada bloque se revuelven los acumuladores
+#define PRIMO32 0x9E3779B1u
+
+static const uint64_t SECRETO[8] = {
+    0xa0761d6478bd642full, 0xe7037ed1a0b428dbull, 0x8ebc6af09c88c6e3ull, 0x589965cc75374cc3ull,
+    0x9E3779B185EBCA87ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0x85EBCA77C2B2AE63ull
+};
+
+/* Lecturas sin requisitos de alineacion */
+
+static uint64_t leer64(const uint8_t* p) {
+    uint64_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+static uint64_t leer32(const uint8_t* p) {
+    uint32_t v;
+    memcpy(&v, p, sizeof(v));
+    return v;
+}
+
+/* Multiplica a y b en 128 bits y devuelve la parte baja en a y la alta en b */
+static void multiplicar(uint64_t* a, uint64_t* b) {
+#ifdef __SIZEOF_INT128__
+    __extension__ typedef unsigned __int128 uint128_t;
+    uint128_t r = (uint128_t) *a * *b;
+    *a = (uint64_t) r;
+    *b = (uint64_t) (r >> 64);
+#else
+    uint64_t ha = *a >> 32, hb = *b >> 32, la = (uint32_t) *a, lb = (uint32_t) *b;
+    uint64_t rh = ha * hb, rm0 = ha * lb, rm1 = hb * la, rl = la * lb;
+    uint64_t t = rl + (rm0 << 32), c = t < rl;
+    uint64_t lo = t + (rm1 << 32);
+    c += lo < t;
+    *a = lo;
+    *b = rh + (rm0 >> 32) + (rm1 >> 32) + c;
+#endif
+}
+
+static uint64_t mezclar(uint64_t a, uint64_t b) {
+    multiplicar(&a, &b);
+    return a ^ b;
+}
+
+/* Claves cortas y medianas, estilo wyhash */
+static uint64_t hash_mediano(const uint8_t* p, size_t largo, uint64_t semilla) {
+    uint64_t a, b;
+    semilla ^= mezclar(semilla ^ SECRETO[0], SECRETO[1]);
+
+    if(largo <= 16)
+    {
+        if(largo >= 4)
+        {
+            size_t medio = (largo >> 3) << 2;
+            a = (leer32(p) << 32) | leer32(p + medio);
+            b = (leer32(p + largo - 4) << 32) | leer32(p + largo - 4 - medio);
+        }
+        else if(largo > 0)
+        {
+            a = ((uint64_t) p[0] << 16) | ((uint64_t) p[largo >> 1] << 8) | p[largo - 1];
+            b = 0;
+        }
+        else
+            a = b = 0;
+    }
+    else
+    {
+        size_t resto = largo;
+        if(resto > 48)
+        {
+            uint64_t semilla1 = semilla, semilla2 = semilla;
+            do
+            {
+                semilla = mezclar(leer64(p) ^ SECRETO[1], leer64(p + 8) ^ semilla);
+                semilla1 = mezclar(leer64(p + 16) ^ SECRETO[2], leer64(p + 24) ^ semilla1);
+                semilla2 = mezclar(leer64(p + 32) ^ SECRETO[3], leer64(p + 40) ^ semilla2);
+                p += 48;
+                resto -= 48;
+            } while(resto > 48);
+            semilla ^= semilla1 ^ semilla2;
+        }
+        while(resto > 16)
+        {
+            semilla = mezclar(leer64(p) ^ SECRETO[1], leer64(p + 8) ^ semilla);
+            p += 16;
+            resto -= 16;
+        }
+        // Los ultimos 16 bytes pueden solaparse con los ya leidos.
+        a = leer64(p + resto - 16);
+        b = leer64(p + resto - 8);
+    }
+
+    a ^= SECRETO[1];
+    b ^= semilla;
+    multiplicar(&a, &b);
+    return mezclar(a ^ SECRETO[0] ^ largo, b ^ SECRETO[1]);
+}
+
+/* Claves largas: cada carril i suma el producto de las dos mitades de
+ * (dato ^ llave) y el carril vecino (i ^ 1) suma el dato.
+ */
+
+typedef void (*acumular_t)(uint64_t acc[8], const uint8_t* p, size_t franjas, const uint64_t llaves[8]);
+
+static void acumular_escalar(uint64_t acc[8], const uint8_t* p, size_t franjas, const uint64_t llaves[8]) {
+    for(size_t f = 0; f < franjas; f++, p += FRANJA)
+    {
+        for(unsigned i = 0; i < 8; i++)
+        {
+            uint64_t dato = leer64(p + 8 * i);
+            uint64_t mezcla = dato ^ llaves[i];
+            acc[i ^ 1] += dato;
+            acc[i] += (mezcla & 0xFFFFFFFFu) * (mezcla >> 32);
+        }
+    }
+}
+
+#ifdef RAPIDO_X86
+
+/* SSE2: dos carriles por registro */
+__attribute__((target("sse2")))
+static void acumular_sse2(uint64_t acc[8], const uint8_t* p, size_t franjas, const uint64_t llaves[8]) {
+    __m128i a[4], k[4];
+    for(unsigned j = 0; j < 4; j++)
+    {
+        a[j] = _mm_loadu_si128((const __m128i*) (acc + 2 * j));
+        k[j] = _mm_loadu_si128((const __m128i*) (llaves + 2 * j));
+    }
+    for(size_t f = 0; f < franjas; f++, p += FRANJA)
+    {
+        for(unsigned j = 0; j < 4; j++)
+        {
+            __m128i dato = _mm_loadu_si128((const __m128i*) (p + 16 * j));
+            __m128i mezcla = _mm_xor_si128(dato, k[j]);
+            __m128i producto = _mm_mul_epu32(mezcla, _mm_srli_epi64(mezcla, 32));
+            __m128i cruzado = _mm_shuffle_epi32(dato, _MM_SHUFFLE(1, 0, 3, 2));
+            a[j] = _mm_add_epi64(a[j], _mm_add_epi64(producto, cruzado));
+        }
+    }
+    for(unsigned j = 0; j < 4; j++)
+        _mm_storeu_si128((__m128i*) (acc + 2 * j), a[j]);
+}
+
+/* AVX2: cuatro carriles por registro */
+__attribute__((target("avx2")))
+static void acumular_avx2(uint64_t acc[8], const uint8_t* p, size_t franjas, const uint64_t llaves[8]) {
+    __m256i a[2], k[2];
+    for(unsigned j = 0; j < 2; j++)
+    {
+        a[j] = _mm256_loadu_si256((const __m256i*) (acc + 4 * j));
+        k[j] = _mm256_loadu_si256((const __m256i*) (llaves + 4 * j));
+    }
+    for(size_t f = 0; f < franjas; f++, p += FRANJA)
+    {
+        for(unsigned j = 0; j < 2; j++)
+        {
+            __m256i dato = _mm256_loadu_si256((const __m256i*) (p + 32 * j));
+            __m256i mezcla = _mm256_xor_si256(dato, k[j]);
+            __m256i producto = _mm256_mul_epu32(mezcla, _mm256_srli_epi64(mezcla, 32));
+            __m256i cruzado = _mm256_shuffle_epi32(dato, _MM_SHUFFLE(1, 0, 3, 2));
+            a[j] = _mm256_add_epi64(a[j], _mm256_add_epi64(producto, cruzado));
+        }
+    }
+    for(unsigned j = 0; j < 2; j++)
+        _mm256_storeu_si256((__m256i*) (acc + 4 * j), a[j]);
+}
+
+#endif // RAPIDO_X86
+
+/* Se lee y se escribe con atomicos: lo usan todos los hilos */
+static acumular_t acumular = NULL;
+static pthread_once_t eleccion_automatica = PTHREAD_ONCE_INIT;
+
+/* Devuelve si el procesador soporta el conjunto de instrucciones */
+static bool soportado(grupo_instrucciones_t instrucciones) {
+#ifdef RAPIDO_X86
+    __builtin_cpu_init();
+    if(instrucciones == GRUPO_AVX2) return __builtin_cpu_supports("avx2");
+    if(instrucciones == GRUPO_SSE2) return __builtin_cpu_supports("sse2");
+#endif
+    return instrucciones == GRUPO_ESCALAR;
+}
+
+grupo_instrucciones_t hash_rapido_elegir_instrucciones(grupo_instrucciones_t instrucciones) {
+    if(instrucciones == GRUPO_AUTOMATICO) instrucciones = GRUPO_AVX2;
+
+    while(instrucciones > GRUPO_ESCALAR && !soportado(instrucciones))
+        instrucciones--;
+
+    acumular_t elegido = acumular_escalar;
+#ifdef RAPIDO_X86
+    if(instrucciones == GRUPO_SSE2) elegido = acumular_sse2;
+    if(instrucciones == GRUPO_AVX2) elegido = acumular_avx2;
+#endif
+    __atomic_store_n(&acumular, elegido, __ATOMIC_RELEASE);
+    return instrucciones;
+}
+
+/* Eleccion automatica, una sola vez; respeta una eleccion anterior */
+static void elegir_automatico(void) {
+    if(!__atomic_load_n(&acumular, __ATOMIC_ACQUIRE)) hash_rapido_elegir_instrucciones(GRUPO_AUTOMATICO);
+}
+
+/* Devuelve el acumulador en uso, eligiendolo la primera vez */
+static acumular_t acumulador(void) {
+    acumular_t elegido = __atomic_load_n(&acumular, __ATOMIC_ACQUIRE);
+    if(elegido) return elegido;
+
+    pthread_once(&eleccion_automatica, elegir_automatico);
+    return __atomic_load_n(&acumular, __ATOMIC_ACQUIRE);
+}
+
+/* Evita que los acumuladores pierdan entropia en los bits altos */
+static void revolver(uint64_t acc[8], const uint64_t llaves[8]) {
+    for(unsigned i = 0; i < 8; i++)
+    {
+        acc[i] ^= acc[i] >> 47;
+        acc[i] ^= llaves[i];
+        acc[i] *= PRIMO32;
+    }
+}
+
+/* Claves largas: franjas completas con los acumuladores y los ultimos 1 a 64
+ * bytes con hash_mediano.
+ */
+static uint64_t hash_largo(const uint8_t* p, size_t largo, uint64_t semilla) {
+    acumular_t acumular_franjas = acumulador();
+
+    uint64_t acc[8], llaves[8];
+    for(unsigned i = 0; i < 8; i++)
+    {
+        acc[i] = SECRETO[7 - i];
+        llaves[i] = i % 2 ? SECRETO[i] - semilla : SECRETO[i] + semilla;
+    }
+
+    size_t franjas = (largo - 1) / FRANJA;
+    size_t resto = largo - franjas * FRANJA;
+    while(franjas)
+    {
+        size_t cantidad = franjas < FRANJAS_POR_BLOQUE ? franjas : FRANJAS_POR_BLOQUE;
+        acumular_franjas(acc, p, cantidad, llaves);
+        p += cantidad * FRANJA;
+        franjas -= cantidad;
+        if(cantidad == FRANJAS_POR_BLOQUE) revolver(acc, llaves);
+    }
+
+    uint64_t h = (uint64_t) largo * SECRETO[4];
+    for(unsigned i = 0; i < 4; i++)
+        h = mezclar(h ^ acc[2 * i], acc[2 * i + 1] ^ SECRETO[i]);
+
+    return hash_mediano(p, resto, h);
+}
+
+uint64_t hash_rapido(const void* clave, size_t largo, uint64_t semilla) {
+    if(largo < LARGO_FRANJAS) return hash_mediano(clave, largo, semilla);
+    return hash_largo(clave, largo, semilla);
+}
+
+uint64_t hash_rapido_semilla(const void* direccion) {
+    static uint64_t base = 0, contador = 0;
+
+    uint64_t leida = __atomic_load_n(&base, __ATOMIC_RELAXED);
+    if(!leida)
+    {
+        FILE* azar = fopen("/dev/urandom", "rb");
+        if(!azar || fread(&leida, sizeof(leida), 1, azar) != 1)
+            leida = (uint64_t) time(NULL) ^ ((uint64_t) clock() << 32);
+        if(azar) fclose(azar);
+        leida |= 1;
+
+        // Si otro hilo la leyo antes, queda la suya.
+        uint64_t esperada = 0;
+        if(!__atomic_compare_exchange_n(&base, &esperada, leida, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+            leida = esperada;
+    }
+
+    uint64_t datos[3] = { leida, (uint64_t) (uintptr_t) direccion, __atomic_add_fetch(&contador, 1, __ATOMIC_RELAXED) };
+    return hash_rapido(datos, sizeof(datos), leida);
+}
@@ -0,0 +1,37 @@
+#ifndef HASH_RAPIDO_H
+#define HASH_RAPIDO_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include "grupos_simd.h"
+
+/*
+ * Funcion de hash de 64 bits para claves de cualquier largo.
+ * - Claves cortas y medianas: estilo wyhash, lecturas de 8 bytes y
+ *   multiplicaciones de 64x64 -> 128 bits, 48 bytes por vuelta.
+ * - Claves largas (LARGO_FRANJAS o mas): estilo XXH3, 8 acumuladores de 64
+ *   bits que avanzan 64 bytes por franja; con SSE2 o AVX2 se procesan varios
+ *   acumuladores por instruccion.
+ * El resultado no depende del conjunto de instrucciones ni de la alineacion
+ * de la clave (todas las lecturas se hacen con memcpy).
+ */
+
+#define LARGO_FRANJAS 1024
+
+/* Devuelve el hash de los 'largo' bytes de clave */
+uint64_t hash_rapido(const void* clave, size_t largo, uint64_t semilla);
+
+/* Fuerza el conjunto de instrucciones para las claves largas. Si el
+ * procesador no lo soporta se usa el mejor disponible por debajo.
+ * Post: Devuelve el conjunto que quedo en uso.
+ */
+grupo_instrucciones_t hash_rapido_elegir_instrucciones(grupo_instrucciones_t instrucciones);
+
+/* Devuelve una semilla al azar, distinta en cada llamada. La base se lee una
+ * sola vez de /dev/urandom (si no existe se usa la hora) y se mezcla con
+ * direccion y un contador. Se puede llamar desde varios hilos a la vez.
+ */
+uint64_t hash_rapido_semilla(const void* direccion);
+
+#endif // HASH_RAPIDO_H
@@ -0,0 +1,149 @@
+#include <pthread.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdlib.h>
+
+#include "hilos.h"
+
+struct hilos {
+    pthread_t* ids;
+    size_t creados;                 // Hilos de trabajo: cantidad - 1
+    pthread_mutex_t mutex;
+    pthread_cond_t hay_trabajo;
+    pthread_cond_t terminado;
+    size_t trabajo;                 // Numero del ultimo trabajo publicado
+    size_t ocupados;                // Hilos que todavia no terminaron el trabajo actual
+    bool salir;
+    hilos_tarea_t tarea;
+    void* extra;
+    size_t tareas;
+    size_t siguiente;               // Proxima tarea a tomar, atomico
+};
+
+/* Toma tareas del trabajo actual hasta que no queden */
+static void hacer_tareas(hilos_t* hilos) {
+    for(;;)
+    {
+        size_t indice = __atomic_fetch_add(&hilos->siguiente, 1, __ATOMIC_RELAXED);
+        if(indice >= hilos->tareas) return;
+        hilos->tarea(hilos->extra, indice);
+    }
+}
+
+/* Ciclo de cada hilo de trabajo: espera un trabajo nuevo, hace tareas y
+ * avisa que termino.
+ */
+static void* trabajar(void* extra) {
+    hilos_t* hilos = extra;
+    size_t visto = 0;
+
+    pthread_mutex_lock(&hilos->mutex);
+    for(;;)
+    {
+        while(!hilos->salir && hilos->trabajo == visto)
+            pthread_cond_wait(&hilos->hay_trabajo, &hilos->mutex);
+        if(hilos->salir) break;
+        visto = hilos->trabajo;
+        pthread_mutex_unlock(&hilos->mutex);
+
+        hacer_tareas(hilos);
+
+        pthread_mutex_lock(&hilos->mutex);
+        if(--hilos->ocupados == 0) pthread_cond_signal(&hilos->terminado);
+    }
+    pthread_mutex_unlock(&hilos->mutex);
+    return NULL;
+}
+
+/* Termina los hilos creados y libera todo */
+static void liberar(hilos_t* hilos) {
+    pthread_mutex_lock(&hilos->mutex);
+    hilos->salir = true;
+    pthread_cond_broadcast(&hilos->hay_trabajo);
+    pthread_mutex_unlock(&hilos->mutex);
+
+    for(size_t i = 0; i < hilos->creados; i++)
+        pthread_join(hilos->ids[i], NULL);
+
+    pthread_cond_destroy(&hilos->terminado);
+    pthread_cond_destroy(&hilos->hay_trabajo);
+    pthread_mutex_destroy(&hilos->mutex);
+    free(hilos->ids);
+    free(hilos);
+}
+
+hilos_t *hilos_crear(size_t cantidad) {
+    if(!cantidad) return NULL;
+
+    hilos_t* hilos = malloc(sizeof(hilos_t));
+    if(!hilos) return NULL;
+
+    hilos->ids = malloc(sizeof(pthread_t) * cantidad);
+    if(!hilos->ids)
+    {
+        free(hilos);
+        return NULL;
+    }
+    if(pthread_mutex_init(&hilos->mutex, NULL))
+    {
+        free(hilos->ids);
+        free(hilos);
+        return NULL;
+    }
+    pthread_cond_init(&hilos->hay_trabajo, NULL);
+    pthread_cond_init(&hilos->terminado, NULL);
+    hilos->creados = 0;
+    hilos->trabajo = 0;
+    hilos->ocupados = 0;
+    hilos->salir = false;
+    hilos->tarea = NULL;
+    hilos->extra = NULL;
+    hilos->tareas = 0;
+    hilos->siguiente = 0;
+
+    for(size_t i = 0; i < cantidad - 1; i++)
+    {
+        if(pthread_create(&hilos->ids[i], NULL, trabajar, hilos))
+        {
+            liberar(hilos);
+            return NULL;
+        }
+        hilos->creados++;
+    }
+    return hilos;
+}
+
+size_t hilos_cantidad(const hilos_t *hilos) {
+    return hilos ? hilos->creados + 1 : 1;
+}
+
+void hilos_ejecutar(hilos_t *hilos, hilos_tarea_t tarea, void *extra, size_t tareas) {
+    if(!hilos || !hilos->creados || tareas < 2)
+    {
+        for(size_t i = 0; i < tareas; i++)
+            tarea(extra, i);
+        return;
+    }
+
+    pthread_mutex_lock(&hilos->mutex);
+    hilos->tarea = tarea;
+    hilos->extra = extra;
+    hilos->tareas = tareas;
+    hilos->siguiente = 0;
+    hilos->ocupados = hilos->creados;
+    hilos->trabajo++;
+    pthread_cond_broadcast(&hilos->hay_trabajo);
+    pthread_mutex_unlock(&hilos->mutex);
+
+    hacer_tareas(hilos);
+
+    // Los hilos que siguen haciendo su ultima tarea todavia leen el trabajo.
+    pthread_mutex_lock(&hilos->mutex);
+    while(hilos->ocupados)
+        pthread_cond_wait(&hilos->terminado, &hilos->mutex);
+    pthread_mutex_unlock(&hilos->mutex);
+}
+
+void hilos_destruir(hilos_t *hilos) {
+    if(hilos) liberar(hilos);
+}
@@ -0,0 +1,39 @@
+#ifndef HILOS_H
+#define HILOS_H
+
+#include <stddef.h>
+
+/*
+ * HILOS
+ * Conjunto fijo de hilos de trabajo (pthreads) para repartir un trabajo en
+ * tareas independientes. Los hilos se crean una sola vez y esperan dormidos
+ * entre un trabajo y el siguiente; el hilo que pide el trabajo tambien hace
+ * tareas. Lo usa el hash para la carga por lotes y la redimension.
+ */
+
+struct hilos;
+typedef struct hilos hilos_t;
+
+/* Tarea numero indice de un trabajo; extra es el de hilos_ejecutar */
+typedef void (*hilos_tarea_t)(void *extra, size_t indice);
+
+/* Crea el conjunto para trabajar con cantidad hilos, contando al que llama
+ * a hilos_ejecutar (se crean cantidad - 1).
+ * Post: Devuelve NULL si cantidad es 0 o si no se pudieron crear.
+ */
+hilos_t *hilos_crear(size_t cantidad);
+
+/* Devuelve la cantidad de hilos con la que se creo (1 con NULL) */
+size_t hilos_cantidad(const hilos_t *hilos);
+
+/* Llama a tarea(extra, i) para cada i de 0 a tareas - 1, repartiendo las
+ * tareas entre los hilos, y vuelve cuando terminaron todas. Con hilos NULL
+ * las hace el que llama, en orden.
+ * Pre: Un solo hilo a la vez ejecuta trabajos en el conjunto.
+ */
+void hilos_ejecutar(hilos_t *hilos, hilos_tarea_t tarea, void *extra, size_t tareas);
+
+/* Termina los hilos y libera el conjunto */
+void hilos_destruir(hilos_t *hilos);
+
+#endif // HILOS_H
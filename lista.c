@@ -1,5 +1,6 @@
 #include <stdlib.h>
 #include "lista.h"
+#include "bloques.h"
 #include <stdbool.h>
 
 typedef struct nodo {
@@ -11,19 +12,51 @@ struct lista {
 	nodo_t* primero;
 	nodo_t* ultimo;
 	size_t largo;
+	bloques_t* bloques;	// De donde salen los nodos, o NULL para usar malloc
 };
 
 struct lista_iter
 {
 	nodo_t* nodo_ant;
 	nodo_t* nodo_act;
+	const memoria_t* memoria;	// De donde salio el iterador
 };
 
+// Devuelve de donde salen la lista y su iterador: la memoria de su reserva
+// de nodos, o NULL para usar malloc
+static const memoria_t* memoria_de(const lista_t *lista)
+{
+    return lista->bloques ? lista->bloques->memoria : NULL;
+}
+
+// Pide un nodo a la reserva de la lista, o con malloc si no tiene
+static nodo_t* nodo_crear(lista_t *lista)
+{
+    return lista->bloques ? bloques_pedir(lista->bloques) : malloc(sizeof(nodo_t));
+}
+
+// Libera un nodo pedido con nodo_crear
+static void nodo_destruir(lista_t *lista, nodo_t *nodo)
+{
+    if(lista->bloques)
+        bloques_devolver(lista->bloques, nodo);
+    else
+        free(nodo);
+}
+
 // Crea una lista.
 // Post: devuelve una nueva lista vacía.
 lista_t* lista_crear(void)
 {
-    lista_t* lista = malloc(sizeof(lista_t));
+    return lista_crear_con_bloques(NULL);
+}
+
+// Crea una lista que pide sus nodos a la reserva recibida. La lista y sus
+// iteradores salen de la misma memoria que la reserva.
+// Post: devuelve una nueva lista vacía.
+lista_t* lista_crear_con_bloques(bloques_t *bloques)
+{
+    lista_t* lista = memoria_pedir(bloques ? bloques->memoria : NULL, sizeof(lista_t));
 
     if(!lista)
     	return NULL;
@@ -31,10 +64,23 @@ lista_t* lista_crear(void)
     lista->primero = NULL;
     lista->ultimo = NULL;
     lista->largo = 0;
+    lista->bloques = bloques;
 
     return lista;
 }
 
+// Devuelve el tamaño de cada nodo de la lista, para crear su reserva.
+size_t lista_tam_nodo(void)
+{
+    return sizeof(nodo_t);
+}
+
+// Devuelve el tamaño de la estructura de la lista, sin sus nodos.
+size_t lista_tam(void)
+{
+    return sizeof(lista_t);
+}
+
 // Destruye la lista. Si se recibe la función destruir_dato por parámetro,
 // para cada uno de los elementos de la lista llama a destruir_dato.
 // Pre: la lista fue creada. destruir_dato es una función capaz de destruir
@@ -47,7 +93,7 @@ void lista_destruir(lista_t *lista, void destruir_dato(void*))
 				destruir_dato(lista_borrar_primero(lista));
 		else
 			lista_borrar_primero(lista);
-	free(lista);
+	memoria_liberar(memoria_de(lista), lista);
 }
 
 // Devuelve verdadero o falso, según si la lista tiene o no elementos enlistados.
@@ -63,7 +109,7 @@ bool lista_esta_vacia(const lista_t *lista)
 // de la lista.
 bool lista_insertar_primero(lista_t *lista, void* valor)
 {
-	nodo_t* nodo = malloc(sizeof(nodo_t));
+	nodo_t* nodo = nodo_crear(lista);
 
 	if(nodo == NULL)
 		return false;
@@ -84,21 +130,22 @@ bool lista_insertar_primero(lista_t *lista, void* valor)
 // Post: se agregó un nuevo elemento a la lista, valor se encuentra al final
 // de la lista.
 bool lista_insertar_ultimo(lista_t *lista, void* valor)
-{
-    if(!lista) return false;
-    if(lista_esta_vacia(lista))
-        return lista_insertar_primero(lista, valor);
+{
+	if(!lista) return false;
+	if(lista_esta_vacia(lista))
+		return lista_insertar_primero(lista, valor);
 
-	nodo_t* nodo = malloc(sizeof(nodo_t));
-	nodo->dato = valor;
-    nodo->siguiente = NULL;
+	nodo_t* nodo = nodo_crear(lista);
 
 	if(nodo == NULL)
 		return false;
 
-    lista->ultimo->siguiente = nodo;
-	lista->ultimo = nodo;
-	lista->largo++;
+	nodo->dato = valor;
+	nodo->siguiente = NULL;
+
+	lista->ultimo->siguiente = nodo;
+	lista->ultimo = nodo;
+	lista->largo++;
 
 	return true;
 }
@@ -112,6 +159,13 @@ void* lista_ver_primero(const lista_t *lista)
 	return (!lista_esta_vacia(lista)) ? lista->primero->dato : NULL;
 }
 
+// Pide que se traiga a la cache el primer nodo de la lista.
+// Pre: la lista fue creada.
+void lista_anticipar(const lista_t *lista)
+{
+	memoria_anticipar(lista->primero);
+}
+
 // Saca el primer elemento de la lista. Si la lista tiene elementos, se quita el
 // primero de la lista, y se devuelve su valor, si está vacía, devuelve NULL.
 // Pre: la lista fue creada.
@@ -125,7 +179,7 @@ void* lista_borrar_primero(lista_t *lista)
 	void* dato = lista_ver_primero(lista);
 
 	nodo_t* nuevo_primero = lista->primero->siguiente;
-	free(lista->primero);
+	nodo_destruir(lista, lista->primero);
 	lista->largo--;
 	lista->primero = nuevo_primero;
 	return dato;
@@ -144,11 +198,12 @@ size_t lista_largo(const lista_t *lista)
 // Post: se devolvió un iterador posicionado en el primer elemento
 lista_iter_t *lista_iter_crear(const lista_t *lista)
 {
-    lista_iter_t* iter = malloc(sizeof(lista_iter_t));
+    lista_iter_t* iter = memoria_pedir(memoria_de(lista), sizeof(lista_iter_t));
 	if(!iter) return NULL;
 
 	iter->nodo_ant = NULL;
 	iter->nodo_act = lista->primero;
+	iter->memoria = memoria_de(lista);
 
 	return iter;
 }
@@ -191,7 +246,7 @@ void* lista_iter_ver_actual(const lista_iter_t *iter)
 void lista_iter_destruir(lista_iter_t *iter)
 {
 	if(!iter) return;
-	free(iter);
+	memoria_liberar(iter->memoria, iter);
 }
 
 // Inserta en una lista en la posicion actual del iterador
@@ -212,7 +267,7 @@ bool lista_insertar(lista_t *lista, lista_iter_t *iter, void *dato)
 		return true;
 	}
 
-	nodo_t* nodo = malloc(sizeof(nodo_t));
+	nodo_t* nodo = nodo_crear(lista);
     if(nodo == NULL) return false;
 
     nodo->dato = dato;
@@ -257,9 +312,9 @@ void* lista_borrar(lista_t *lista, lista_iter_t *iter)
         iter->nodo_act = iter->nodo_ant->siguiente;
     }
 
-    free(nodo);
-    lista->largo--;
-
+    nodo_destruir(lista, nodo);
+    lista->largo--;
+
     if(lista_largo(lista)==1)
         lista->ultimo = lista->primero;
 
@@ -273,22 +328,113 @@ void lista_iterar(lista_t *lista, bool (*visitar)(void *dato, void *extra), void
     if(!lista || !visitar || !extra)
 		return;
 
-    lista_iter_t *iter = lista_iter_crear(lista);
-
-    if(!iter)
-        return;
-
-    while( !lista_iter_al_final(iter) && visitar(lista_iter_ver_actual(iter), extra) )
-       lista_iter_avanzar(iter);
-
-    lista_iter_destruir(iter);
+    // Recorre los nodos directamente, sin pedir memoria para un iterador
+    nodo_t* nodo = lista->primero;
+    while(nodo && visitar(nodo->dato, extra))
+        nodo = nodo->siguiente;
+}
 
+// Devuelve el primer dato para el cual es_buscado devuelve true, pasandole el
+// parametro extra. No pide memoria.
+// Pre: la lista fue creada
+// Post: se devolvio el dato encontrado o NULL si ninguno cumple
+void* lista_buscar(const lista_t *lista, bool (*es_buscado)(const void *dato, const void *extra), const void *extra)
+{
+    for(nodo_t* nodo = lista->primero; nodo; nodo = nodo->siguiente)
+        if(es_buscado(nodo->dato, extra))
+            return nodo->dato;
+    return NULL;
 }
 
+// Elimina el primer dato para el cual es_buscado devuelve true, pasandole el
+// parametro extra. No pide memoria.
+// Pre: la lista fue creada
+// Post: se devolvio el dato eliminado o NULL si ninguno cumple
+void* lista_borrar_buscado(lista_t *lista, bool (*es_buscado)(const void *dato, const void *extra), const void *extra)
+{
+    nodo_t* anterior = NULL;
+    for(nodo_t* nodo = lista->primero; nodo; anterior = nodo, nodo = nodo->siguiente)
+    {
+        if(!es_buscado(nodo->dato, extra))
+            continue;
+
+        if(anterior)
+            anterior->siguiente = nodo->siguiente;
+        else
+            lista->primero = nodo->siguiente;
+
+        if(lista->ultimo == nodo)
+            lista->ultimo = anterior;
+
+        void* dato = nodo->dato;
+        nodo_destruir(lista, nodo);
+        lista->largo--;
+        return dato;
+    }
+    return NULL;
+}
 
+// Mueve el primer elemento de origen al final de destino, sin pedir ni
+// liberar memoria (se reenlaza el mismo nodo).
+// Pre: ambas listas fueron creadas
+// Post: devuelve false si origen estaba vacia
+bool lista_mover_primero(lista_t *origen, lista_t *destino)
+{
+    if(lista_esta_vacia(origen))
+        return false;
+
+    nodo_t* nodo = origen->primero;
+    origen->primero = nodo->siguiente;
+    origen->largo--;
+    if(lista_esta_vacia(origen))
+        origen->ultimo = NULL;
+
+    nodo->siguiente = NULL;
+    if(lista_esta_vacia(destino))
+        destino->primero = nodo;
+    else
+        destino->ultimo->siguiente = nodo;
+    destino->ultimo = nodo;
+    destino->largo++;
+    return true;
+}
 
+// Mueve todos los elementos de origen al final de destino, sin pedir ni
+// liberar memoria.
+// Pre: ambas listas fueron creadas
+// Post: origen quedo vacia
+void lista_concatenar(lista_t *destino, lista_t *origen)
+{
+    if(lista_esta_vacia(origen))
+        return;
 
+    if(lista_esta_vacia(destino))
+        destino->primero = origen->primero;
+    else
+        destino->ultimo->siguiente = origen->primero;
+    destino->ultimo = origen->ultimo;
+    destino->largo += origen->largo;
 
+    origen->primero = NULL;
+    origen->ultimo = NULL;
+    origen->largo = 0;
+}
 
+// Devuelve el primer nodo de la lista, o NULL si esta vacia
+// Pre: la lista fue creada
+const lista_nodo_t* lista_nodo_primero(const lista_t *lista)
+{
+    return lista->primero;
+}
 
+// Devuelve el nodo que sigue, o NULL si nodo es el ultimo
+const lista_nodo_t* lista_nodo_siguiente(const lista_nodo_t *nodo)
+{
+    return nodo->siguiente;
+}
 
+// Devuelve el dato del nodo
+void* lista_nodo_dato(const lista_nodo_t *nodo)
+{
+    return nodo->dato;
+}
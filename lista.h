@@ -4,6 +4,8 @@
 #include <stdlib.h>
 #include <stdbool.h>
 
+#include "bloques.h"
+
 
 /* ******************************************************************
  *                DEFINICION DE LOS TIPOS DE DATOS
@@ -16,6 +18,9 @@ typedef struct lista lista_t;
 
 typedef struct lista_iter lista_iter_t;
 
+// Nodo de la lista, para recorrerla sin iterador (ver lista_nodo_primero).
+typedef struct nodo lista_nodo_t;
+
 
 /* ******************************************************************
  *                    PRIMITIVAS DE LA LISTA
@@ -25,6 +30,18 @@ typedef struct lista_iter lista_iter_t;
 // Post: devuelve una nueva lista vacía.
 lista_t* lista_crear(void);
 
+// Crea una lista que pide y devuelve sus nodos a la reserva bloques en lugar
+// de usar malloc y free. Las listas entre las que se mueven nodos
+// (lista_mover_primero, lista_concatenar) deben usar la misma reserva.
+// Post: devuelve una nueva lista vacía.
+lista_t* lista_crear_con_bloques(bloques_t *bloques);
+
+// Devuelve el tamaño de cada nodo, para inicializar su reserva.
+size_t lista_tam_nodo(void);
+
+// Devuelve el tamaño de la estructura de una lista vacia.
+size_t lista_tam(void);
+
 // Destruye la lista. Si se recibe la función destruir_dato por parámetro,
 // para cada uno de los elementos de la lista llama a destruir_dato.
 // Pre: la lista fue creada. destruir_dato es una función capaz de destruir
@@ -54,6 +71,11 @@ bool lista_insertar_ultimo(lista_t *lista, void *dato);
 // Post: se devolvió el primer elemento de la lista, cuando no está vacía.
 void* lista_ver_primero(const lista_t *lista);
 
+// Pide que se traiga a la cache el primer nodo de la lista, para que un
+// lista_ver_primero o lista_buscar posterior no espere a la memoria.
+// Pre: la lista fue creada.
+void lista_anticipar(const lista_t *lista);
+
 // Saca el primer elemento de la lista. Si la lista tiene elementos, se quita el
 // primero de la lista, y se devuelve su valor, si está vacía, devuelve NULL.
 // Pre: la lista fue creada.
@@ -103,6 +125,39 @@ void* lista_borrar(lista_t *lista, lista_iter_t *iter);
 // Pre: la lista fue creada
 void lista_iterar(lista_t *lista, bool (*visitar)(void *dato, void *extra), void *extra);
 
+// Devuelve el primer dato para el cual es_buscado devuelve true, pasandole el
+// parametro extra. No pide memoria.
+// Pre: la lista fue creada
+// Post: se devolvio el dato encontrado o NULL si ninguno cumple
+void* lista_buscar(const lista_t *lista, bool (*es_buscado)(const void *dato, const void *extra), const void *extra);
+
+// Elimina el primer dato para el cual es_buscado devuelve true, pasandole el
+// parametro extra. No pide memoria.
+// Pre: la lista fue creada
+// Post: se devolvio el dato eliminado o NULL si ninguno cumple
+void* lista_borrar_buscado(lista_t *lista, bool (*es_buscado)(const void *dato, const void *extra), const void *extra);
+
+// Mueve el primer elemento de origen al final de destino, sin pedir ni
+// liberar memoria (se reenlaza el mismo nodo).
+// Pre: ambas listas fueron creadas
+// Post: devuelve false si origen estaba vacia
+bool lista_mover_primero(lista_t *origen, lista_t *destino);
+
+// Mueve todos los elementos de origen al final de destino, sin pedir ni
+// liberar memoria.
+// Pre: ambas listas fueron creadas
+// Post: origen quedo vacia
+void lista_concatenar(lista_t *destino, lista_t *origen);
+
+// Recorrido de solo lectura sin iterador, que no pide memoria:
+// lista_nodo_primero devuelve el primer nodo (NULL si la lista esta vacia),
+// lista_nodo_siguiente el que le sigue (NULL al final) y lista_nodo_dato su
+// dato. Un nodo deja de ser valido cuando se lo borra de la lista.
+// Pre: la lista fue creada
+const lista_nodo_t* lista_nodo_primero(const lista_t *lista);
+const lista_nodo_t* lista_nodo_siguiente(const lista_nodo_t *nodo);
+void* lista_nodo_dato(const lista_nodo_t *nodo);
+
 
 /* *****************************************************************
  *                      PRUEBAS UNITARIAS
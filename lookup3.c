@@ -1,5 +1,6 @@
 #include <stdint.h>
 #include <stdlib.h>
+#include <string.h>
 
 #define rot(x,k) (((x)<<(k)) | ((x)>>(32-(k))))
 
@@ -24,23 +25,30 @@
   c ^= b; c -= rot(b,24); \
 }
 
+/* Lee 4 bytes sin requisitos de alineacion: la clave puede empezar en
+ * cualquier direccion y desreferenciar un uint32_t* desalineado es UB. */
+static uint32_t read32(const uint8_t *p) {
+  uint32_t v;
+  memcpy(&v, p, sizeof(v));
+  return v;
+}
+
 uint32_t lookup3 (const void *key, size_t length, uint32_t initval ) {
   uint32_t  a,b,c;
   const uint8_t  *k;
-  const uint32_t *data32Bit;
 
-  data32Bit = key;
+  k = key;
   a = b = c = 0xdeadbeef + (((uint32_t)length)<<2) + initval;
 
   while (length > 12) {
-    a += *(data32Bit++);
-    b += *(data32Bit++);
-    c += *(data32Bit++);
+    a += read32(k);
+    b += read32(k + 4);
+    c += read32(k + 8);
     mix(a,b,c);
     length -= 12;
+    k += 12;
   }
 
-  k = (const uint8_t *)data32Bit;
   switch (length) {
     case 12: c += ((uint32_t)k[11])<<24;
     case 11: c += ((uint32_t)k[10])<<16;
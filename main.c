@@ -1,16 +1,24 @@
 #include "testing.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
 
 /* ******************************************************************
  *                        PROGRAMA PRINCIPAL
  * *****************************************************************/
 
 void pruebas_hash_catedra(void);
+void pruebas_hash_alumno(void);
+void pruebas_rendimiento_alumno(void);
 void pruebas_volumen_catedra(size_t);
 
 int main(int argc, char *argv[])
 {
+    if (argc > 1 && strcmp(argv[1], "rendimiento") == 0) {
+        pruebas_rendimiento_alumno();
+        return 0;
+    }
+
     if (argc > 1) {
         // Asumimos que nos están pidiendo pruebas de volumen.
         long largo = strtol(argv[1], NULL, 10);
@@ -21,5 +29,8 @@ int main(int argc, char *argv[])
     printf("~~~ PRUEBAS CÁTEDRA ~~~\n");
     pruebas_hash_catedra();
 
+    printf("~~~ PRUEBAS ALUMNO ~~~\n");
+    pruebas_hash_alumno();
+
     return failure_count() > 0;
 }
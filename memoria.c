@@ -0,0 +1,35 @@
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "memoria.h"
+
+void* memoria_pedir(const memoria_t* memoria, size_t tam) {
+    if(!memoria) return malloc(tam);
+    return memoria->pedir(memoria->contexto, tam);
+}
+
+void* memoria_pedir_ceros(const memoria_t* memoria, size_t cantidad, size_t tam) {
+    if(!memoria) return calloc(cantidad, tam);
+    if(tam && cantidad > SIZE_MAX / tam) return NULL;
+
+    void* elemento = memoria->pedir(memoria->contexto, cantidad * tam);
+    if(elemento) memset(elemento, 0, cantidad * tam);
+    return elemento;
+}
+
+void* memoria_redimensionar(const memoria_t* memoria, void* elemento, size_t tam_viejo, size_t tam_nuevo) {
+    if(!memoria) return realloc(elemento, tam_nuevo);
+
+    void* nuevo = memoria->pedir(memoria->contexto, tam_nuevo);
+    if(!nuevo) return NULL;
+    if(elemento) memcpy(nuevo, elemento, tam_viejo < tam_nuevo ? tam_viejo : tam_nuevo);
+    memoria->liberar(memoria->contexto, elemento);
+    return nuevo;
+}
+
+void memoria_liberar(const memoria_t* memoria, void* elemento) {
+    if(!memoria) free(elemento);
+    else if(elemento) memoria->liberar(memoria->contexto, elemento);
+}
@@ -0,0 +1,43 @@
+#ifndef MEMORIA_H
+#define MEMORIA_H
+
+#include <stddef.h>
+
+/*
+ * MEMORIA
+ * Fuente de memoria intercambiable para el hash y sus estructuras (listas,
+ * bloques, tabla cerrada). Todas reciben un const memoria_t*; con NULL usan
+ * malloc, calloc, realloc y free de la biblioteca estandar.
+ */
+
+typedef struct memoria {
+    void* (*pedir)(void* contexto, size_t tam);         // Como malloc, NULL si no hay memoria
+    void (*liberar)(void* contexto, void* elemento);    // Como free, con NULL no hace nada
+    void* contexto;                                     // Se pasa tal cual a pedir y liberar
+} memoria_t;
+
+/* Pide tam bytes sin inicializar. */
+void* memoria_pedir(const memoria_t* memoria, size_t tam);
+
+/* Pide un arreglo de cantidad elementos de tam bytes, todo en cero. */
+void* memoria_pedir_ceros(const memoria_t* memoria, size_t cantidad, size_t tam);
+
+/* Cambia el tamaño de un bloque de tam_viejo bytes a tam_nuevo, conservando
+ * el contenido. Si no hay memoria devuelve NULL y el bloque queda como estaba.
+ */
+void* memoria_redimensionar(const memoria_t* memoria, void* elemento, size_t tam_viejo, size_t tam_nuevo);
+
+/* Libera un bloque pedido con las funciones anteriores. */
+void memoria_liberar(const memoria_t* memoria, void* elemento);
+
+/* Sugiere al procesador traer a la cache lo que hay en direccion, sin
+ * esperar a que llegue. Es solo una pista: no falla con direcciones
+ * invalidas ni con NULL.
+ */
+#if defined(__GNUC__)
+#define memoria_anticipar(direccion) __builtin_prefetch(direccion)
+#else
+#define memoria_anticipar(direccion) ((void) (direccion))
+#endif
+
+#endif // MEMORIA_H
@@ -0,0 +1,1940 @@
+/*
+ * pruebas_alumno.c
+ * Pruebas propias para las extensiones de la Tabla de Hash
+ */
+
+#include "hash.h"
+#include "hash_concurrente.h"
+#include "hash_particionado.h"
+#include "grupos_simd.h"
+#include "hash_rapido.h"
+#include "testing.h"
+
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+
+/* ******************************************************************
+ *                    CONTADOR DE PEDIDOS DE MEMORIA
+ * *****************************************************************/
+
+/* Con glibc se reemplazan malloc, calloc y realloc para contar cuantas veces
+ * se pide memoria y para simular que se queda sin memoria. Con
+ * AddressSanitizer no se puede, ahi no se cuenta.
+ */
+#if defined(__GLIBC__) && !defined(__SANITIZE_ADDRESS__)
+#define CONTADOR_MEMORIA
+extern void *__libc_malloc(size_t);
+extern void *__libc_calloc(size_t, size_t);
+extern void *__libc_realloc(void *, size_t);
+
+/* Se cuentan con atomicos: las pruebas concurrentes piden memoria desde
+ * varios hilos a la vez.
+ */
+static size_t pedidos_memoria;
+static size_t pedidos_hasta_falla = (size_t) -1;     // Los pedidos que se atienden antes de fallar
+
+static bool pedir_memoria(void)
+{
+    __atomic_fetch_add(&pedidos_memoria, 1, __ATOMIC_RELAXED);
+    size_t restantes = __atomic_load_n(&pedidos_hasta_falla, __ATOMIC_RELAXED);
+    do {
+        if (restantes == 0) return false;
+        if (restantes == (size_t) -1) return true;
+    } while (!__atomic_compare_exchange_n(&pedidos_hasta_falla, &restantes, restantes - 1, true,
+                                          __ATOMIC_RELAXED, __ATOMIC_RELAXED));
+    return true;
+}
+
+void *malloc(size_t tam) { return pedir_memoria() ? __libc_malloc(tam) : NULL; }
+void *calloc(size_t cantidad, size_t tam) { return pedir_memoria() ? __libc_calloc(cantidad, tam) : NULL; }
+void *realloc(void *ptr, size_t tam) { return pedir_memoria() ? __libc_realloc(ptr, tam) : NULL; }
+#endif
+
+/* ******************************************************************
+ *                        PRUEBAS UNITARIAS
+ * *****************************************************************/
+
+static const hash_tipo_t TIPOS[] = { HASH_ABIERTO, HASH_CERRADO_LINEAL, HASH_CERRADO_ROBIN_HOOD, HASH_CERRADO_GRUPOS };
+static const char* NOMBRES_TIPOS[] = { "abierto", "cerrado lineal", "cerrado robin hood", "cerrado por grupos" };
+#define CANTIDAD_TIPOS (sizeof(TIPOS) / sizeof(TIPOS[0]))
+
+static void prueba_hash_tipo_basico(hash_tipo_t tipo)
+{
+    hash_t* hash = hash_crear_tipo(free, tipo);
+
+    char *valor1 = malloc(10), *valor2 = malloc(10), *valor3 = malloc(10);
+
+    print_test("Prueba hash tipo crear", hash);
+    print_test("Prueba hash tipo obtener clave inexistente es NULL", !hash_obtener(hash, "perro"));
+    print_test("Prueba hash tipo insertar clave1", hash_guardar(hash, "perro", valor1));
+    print_test("Prueba hash tipo insertar clave vacia", hash_guardar(hash, "", valor2));
+    print_test("Prueba hash tipo la cantidad de elementos es 2", hash_cantidad(hash) == 2);
+    print_test("Prueba hash tipo reemplazar clave1 (libera el anterior)", hash_guardar(hash, "perro", valor3));
+    print_test("Prueba hash tipo obtener clave1 es el reemplazo", hash_obtener(hash, "perro") == valor3);
+    print_test("Prueba hash tipo pertenece clave vacia", hash_pertenece(hash, ""));
+    print_test("Prueba hash tipo borrar clave vacia", hash_borrar(hash, "") == valor2);
+    print_test("Prueba hash tipo clave vacia ya no pertenece", !hash_pertenece(hash, ""));
+    print_test("Prueba hash tipo la cantidad de elementos es 1", hash_cantidad(hash) == 1);
+
+    free(valor2);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_tipo_volumen(hash_tipo_t tipo, size_t largo)
+{
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+
+    const size_t largo_clave = 10;
+    char (*claves)[largo_clave] = malloc(largo * largo_clave);
+    size_t* valores = malloc(largo * sizeof(size_t));
+
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(claves[i], "%08zu", i);
+        valores[i] = i;
+        ok = hash_guardar(hash, claves[i], &valores[i]);
+    }
+    print_test("Prueba hash tipo almacenar muchos elementos", ok);
+    print_test("Prueba hash tipo la cantidad de elementos es correcta", hash_cantidad(hash) == largo);
+
+    for (size_t i = 0; i < largo && ok; i++)
+        ok = hash_obtener(hash, claves[i]) == &valores[i];
+    print_test("Prueba hash tipo obtener muchos elementos", ok);
+
+    /* Recorre todo con el iterador y cuenta cada clave una sola vez */
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter)) {
+        size_t* valor = hash_obtener(hash, hash_iter_ver_actual(iter));
+        ok = valor && *valor != largo;
+        if (ok) *valor = largo;
+        recorridos++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash tipo iterar recorre cada clave una vez", ok && recorridos == largo);
+
+    /* Borra la mitad (las pares) y comprueba que las impares sigan */
+    for (size_t i = 0; i < largo && ok; i += 2)
+        ok = hash_borrar(hash, claves[i]) == &valores[i];
+    for (size_t i = 0; i < largo && ok; i++)
+        ok = hash_pertenece(hash, claves[i]) == (i % 2 == 1);
+    print_test("Prueba hash tipo borrar la mitad de los elementos", ok);
+    print_test("Prueba hash tipo la cantidad de elementos es la mitad", hash_cantidad(hash) == largo / 2);
+
+    for (size_t i = 1; i < largo && ok; i += 2)
+        ok = hash_borrar(hash, claves[i]) == &valores[i];
+    print_test("Prueba hash tipo borrar el resto", ok && hash_cantidad(hash) == 0);
+
+    free(claves);
+    free(valores);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_grupos_instrucciones()
+{
+    const grupo_instrucciones_t instrucciones[] = { GRUPO_ESCALAR, GRUPO_SSE2, GRUPO_AVX2 };
+    const size_t largo = 5000;
+    char clave[16];
+
+    hash_t* hash = hash_crear_tipo(NULL, HASH_CERRADO_GRUPOS);
+
+    /* Inserta con un conjunto de instrucciones y busca con todos los demas */
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        grupo_elegir_instrucciones(instrucciones[i % 3]);
+        sprintf(clave, "k%zu", i);
+        ok = hash_guardar(hash, clave, NULL) && (i % 7 != 0 || hash_borrar(hash, clave) == NULL);
+    }
+    print_test("Prueba hash grupos insertar alternando instrucciones", ok);
+
+    for (size_t j = 0; j < 3; j++) {
+        grupo_elegir_instrucciones(instrucciones[j]);
+        ok = true;
+        for (size_t i = 0; i < largo && ok; i++) {
+            sprintf(clave, "k%zu", i);
+            ok = hash_pertenece(hash, clave) == (i % 7 != 0);
+        }
+        print_test("Prueba hash grupos buscar con cada conjunto de instrucciones", ok);
+    }
+    print_test("Prueba hash grupos el escalar siempre esta disponible", grupo_elegir_instrucciones(GRUPO_ESCALAR) == GRUPO_ESCALAR);
+
+    grupo_elegir_instrucciones(GRUPO_AUTOMATICO);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_claves_largas(hash_tipo_t tipo)
+{
+    const size_t largo = 4000;
+    char clave[128];
+    const char* prefijo = "https://ejemplo.com.ar/un/camino/bastante/largo/para/la/clave?id=";
+
+    /* Claves con el mismo prefijo largo que difieren en el final y en el largo,
+     * suficientes para que el hash se redimensione varias veces. */
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%s%zu", prefijo, i);
+        ok = hash_guardar(hash, clave, (void*) (i + 1));
+    }
+    print_test("Prueba hash guardar claves largas", ok);
+
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%s%zu", prefijo, i);
+        ok = hash_obtener(hash, clave) == (void*) (i + 1);
+        sprintf(clave, "%s%zux", prefijo, i);
+        ok &= !hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash claves largas se obtienen despues de redimensionar", ok);
+    print_test("Prueba hash un prefijo de una clave no pertenece", !hash_pertenece(hash, prefijo));
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_claves_con_largo(hash_tipo_t tipo)
+{
+    const char buffer[] = "abcdef";             // Solo se usan los primeros 3 bytes
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+
+    print_test("Prueba hash largo guardar clave con \\0 en el medio", hash_guardar_n(hash, "a\0b", 3, (void*) 1));
+    print_test("Prueba hash largo guardar otra clave con \\0 en el medio", hash_guardar_n(hash, "a\0c", 3, (void*) 2));
+    print_test("Prueba hash largo guardar su prefijo", hash_guardar_n(hash, "a", 1, (void*) 3));
+    print_test("Prueba hash largo guardar clave sin \\0 al final", hash_guardar_n(hash, buffer, 3, (void*) 4));
+    print_test("Prueba hash largo son cuatro claves distintas", hash_cantidad(hash) == 4);
+
+    print_test("Prueba hash largo obtener con \\0 en el medio", hash_obtener_n(hash, "a\0c", 3) == (void*) 2);
+    print_test("Prueba hash largo la clave sin largo es la misma", hash_obtener(hash, "a") == (void*) 3);
+    print_test("Prueba hash largo la clave sin \\0 al final se copio con su largo", hash_obtener(hash, "abc") == (void*) 4);
+    print_test("Prueba hash largo pertenece respeta el largo", !hash_pertenece_n(hash, "a\0b", 2) && hash_pertenece_n(hash, "a\0b", 3));
+
+    size_t largos = 0, recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter)) {
+        largos += hash_iter_ver_largo(iter);
+        recorridos++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash largo el iterador devuelve el largo de cada clave", recorridos == 4 && largos == 10);
+
+    print_test("Prueba hash largo borrar con \\0 en el medio", hash_borrar_n(hash, "a\0b", 3) == (void*) 1);
+    print_test("Prueba hash largo borrar no toca las otras", hash_cantidad(hash) == 3 && hash_pertenece_n(hash, "a\0c", 3));
+
+    /* Con el codigo ya calculado se llega a las mismas claves */
+    print_test("Prueba hash largo obtener con el codigo calculado", hash_obtener_hasheada(hash, "a\0c", 3, hash_codigo(hash, "a\0c", 3)) == (void*) 2);
+    print_test("Prueba hash largo guardar con el codigo calculado",
+               hash_guardar_hasheada(hash, "xyz", 3, hash_codigo(hash, "xyz", 3), (void*) 5) && hash_obtener(hash, "xyz") == (void*) 5);
+    print_test("Prueba hash largo pertenece con el codigo calculado", hash_pertenece_hasheada(hash, "xyz", 3, hash_codigo(hash, "xyz", 3)));
+    void** dato;
+    bool insertado;
+    print_test("Prueba hash largo obtener_o_insertar con el codigo calculado",
+               hash_obtener_o_insertar_hasheada(hash, "a", 1, hash_codigo(hash, "a", 1), &dato, &insertado) && !insertado && *dato == (void*) 3);
+    print_test("Prueba hash largo borrar con el codigo calculado",
+               hash_borrar_hasheada(hash, "xyz", 3, hash_codigo(hash, "xyz", 3)) == (void*) 5 && !hash_pertenece(hash, "xyz"));
+
+    hash_destruir(hash);
+}
+
+static void prueba_hash_busquedas_sin_memoria(hash_tipo_t tipo)
+{
+#ifdef CONTADOR_MEMORIA
+    const size_t largo = 2000;
+    char clave[16];
+
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+
+    /* Busca claves que estan y que no estan; reemplaza y borra las que no estan */
+    bool ok = true;
+    size_t antes = pedidos_memoria;
+    for (size_t i = 0; i < 2 * largo; i++) {
+        sprintf(clave, "%zu", i);
+        ok &= hash_pertenece(hash, clave) == (i < largo);
+        hash_obtener(hash, clave);
+        if (i < largo) hash_guardar(hash, clave, NULL);
+        else hash_borrar(hash, clave);
+    }
+    print_test("Prueba hash busquedas correctas", ok);
+    print_test("Prueba hash obtener, pertenece, reemplazar y borrar ausentes no piden memoria", pedidos_memoria == antes);
+
+    hash_destruir(hash);
+#else
+    (void) tipo;
+#endif
+}
+
+static void prueba_hash_redimension_sin_memoria()
+{
+#ifdef CONTADOR_MEMORIA
+    const size_t largo = 1933;      // Con la siguiente insercion el hash abierto crece
+    char clave[16];
+
+    hash_t* hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, (void*) (i + 1));
+    }
+
+    /* Encontrar una clave guardada no redimensiona: no pide memoria y no
+     * falla aunque no la haya. */
+    void** dato = NULL;
+    bool insertado = true;
+    size_t antes = pedidos_memoria;
+    pedidos_hasta_falla = 0;
+    bool encontrada = hash_obtener_o_insertar(hash, "5", &dato, &insertado);
+    pedidos_hasta_falla = (size_t) -1;
+    print_test("Prueba hash obtener o insertar encuentra sin memoria y sin redimensionar",
+               encontrada && !insertado && *dato == (void*) 6 && pedidos_memoria == antes);
+
+    /* Hace fallar cada uno de los pedidos de memoria de la redimension: el
+     * hash debe quedar con todos sus elementos, hasta que se pueda insertar. */
+    bool ok = true;
+    insertado = false;
+    for (size_t fallar_en = 0; !insertado && ok; fallar_en++) {
+        pedidos_hasta_falla = fallar_en;
+        insertado = hash_guardar(hash, "nueva", NULL);
+        pedidos_hasta_falla = (size_t) -1;
+
+        ok = hash_cantidad(hash) == largo + insertado;
+        for (size_t i = 0; i < largo && ok; i++) {
+            sprintf(clave, "%zu", i);
+            ok = hash_obtener(hash, clave) == (void*) (i + 1);
+        }
+    }
+    print_test("Prueba hash redimension sin memoria conserva los elementos", ok);
+    print_test("Prueba hash redimension con memoria inserta", insertado && hash_pertenece(hash, "nueva"));
+
+    hash_destruir(hash);
+#endif
+}
+
+static void prueba_hash_incremental()
+{
+    const size_t largo = 1940;      // La insercion 1934 empieza a migrar, que sigue en curso
+    char clave[16];
+
+    hash_t* hash = hash_crear(NULL);
+    print_test("Prueba hash incremental se activa en el hash abierto", hash_redimension_incremental(hash, true));
+
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_guardar(hash, clave, (void*) (i + 1));
+        sprintf(clave, "%zu", i / 2);
+        ok &= hash_obtener(hash, clave) == (void*) (i / 2 + 1);
+    }
+    print_test("Prueba hash incremental guardar y obtener mientras migra", ok);
+
+    /* A mitad de la migracion el iterador recorre los dos vectores */
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter)) {
+        size_t i = (size_t) hash_obtener(hash, hash_iter_ver_actual(iter));
+        ok = i > 0 && i <= largo;
+        recorridos++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash incremental iterar durante la migracion", ok && recorridos == largo);
+
+#ifdef CONTADOR_MEMORIA
+    /* Si no hay memoria para una lista, la posicion queda a medio migrar */
+    pedidos_hasta_falla = 0;
+    hash_borrar(hash, "no esta");
+    pedidos_hasta_falla = (size_t) -1;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_obtener(hash, clave) == (void*) (i + 1);
+    }
+    print_test("Prueba hash incremental migrar sin memoria conserva los elementos", ok);
+#endif
+
+    /* Borrando la mayoria termina la migracion y empieza otra para achicar */
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        if (i % 10 != 0) ok = hash_borrar(hash, clave) == (void*) (i + 1);
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_pertenece(hash, clave) == (i % 10 == 0);
+    }
+    print_test("Prueba hash incremental borrar mientras migra", ok);
+    print_test("Prueba hash incremental la cantidad de elementos es correcta", hash_cantidad(hash) == largo / 10);
+
+    hash_destruir(hash);
+
+    hash = hash_crear_tipo(NULL, HASH_CERRADO_LINEAL);
+    print_test("Prueba hash incremental no se activa en el hash cerrado", !hash_redimension_incremental(hash, true));
+    hash_destruir(hash);
+}
+
+/* Escribe en clave la i-esima clave de uno de los conjuntos de prueba */
+static void clave_de_conjunto(char* clave, size_t conjunto, size_t i)
+{
+    switch (conjunto) {
+        case 0: sprintf(clave, "%08zu", i); break;                                      // Numeros consecutivos
+        case 1: sprintf(clave, "%zu", i * 4096); break;                                 // Multiplos de una potencia de 2
+        case 2: sprintf(clave, "https://ejemplo.com.ar/usuarios/%zu/perfil", i); break; // Prefijo y sufijo comunes
+        default: sprintf(clave, "%c%c%c-%zx", 'a' + (int)(i % 26), 'a' + (int)(i / 26 % 26), 'A' + (int)(i % 7), i); break;
+    }
+}
+
+static void prueba_hash_politicas_distribucion()
+{
+    const hash_largo_t politicas[] = { HASH_LARGO_MODULO, HASH_LARGO_POTENCIA_DE_2, HASH_LARGO_MULTIPLICATIVO };
+    const size_t largo = 30000, conjuntos = 4;
+    char clave[64];
+
+    hash_t* hash = hash_crear(NULL);
+    hash_guardar(hash, "a", NULL);
+    print_test("Prueba hash politica no se cambia con elementos", !hash_politica_largo(hash, HASH_LARGO_POTENCIA_DE_2));
+    hash_destruir(hash);
+
+    hash = hash_crear_tipo(NULL, HASH_CERRADO_GRUPOS);
+    print_test("Prueba hash politica no se cambia en el hash cerrado", !hash_politica_largo(hash, HASH_LARGO_POTENCIA_DE_2));
+    hash_destruir(hash);
+
+    for (size_t p = 0; p < 3; p++) {
+        bool ok = true, distribuye = true;
+        for (size_t conjunto = 0; conjunto < conjuntos && ok; conjunto++) {
+            hash = hash_crear(NULL);
+            ok = hash_politica_largo(hash, politicas[p]);
+            for (size_t i = 0; i < largo && ok; i++) {
+                clave_de_conjunto(clave, conjunto, i);
+                ok = hash_guardar(hash, clave, (void*) (i + 1));
+            }
+            for (size_t i = 0; i < largo && ok; i++) {
+                clave_de_conjunto(clave, conjunto, i);
+                ok = hash_obtener(hash, clave) == (void*) (i + 1);
+            }
+
+            /* Con claves al azar quedan vacias (1 - 1/m)^n del total */
+            hash_estadisticas_t estadisticas;
+            ok &= hash_estadisticas(hash, &estadisticas);
+            double vacias = 1;
+            for (size_t i = 0; i < largo; i++) vacias *= 1 - 1 / (double) estadisticas.largo;
+            double esperadas = (double) estadisticas.largo * (1 - vacias);
+
+            distribuye &= (double) estadisticas.ocupadas >= 0.95 * esperadas && estadisticas.lista_mas_larga <= 16;
+            hash_destruir(hash);
+        }
+        print_test("Prueba hash politica guardar y obtener", ok);
+        print_test("Prueba hash politica reparte bien claves reales", distribuye);
+    }
+}
+
+/* FNV-1a de 64 bits, como funcion de hash propia */
+static uint64_t hash_fnv(const void* clave, size_t largo, uint64_t semilla)
+{
+    const unsigned char* bytes = clave;
+    uint64_t h = 0xcbf29ce484222325ull ^ semilla;
+    for (size_t i = 0; i < largo; i++) h = (h ^ bytes[i]) * 0x100000001b3ull;
+    return h;
+}
+
+static void prueba_hash_funciones()
+{
+    const hash_funcion_t funciones[] = { hash_funcion_rapida, hash_funcion_lookup3, hash_fnv };
+    const size_t largo = 5000;
+    char clave[32];
+
+    for (size_t f = 0; f < 3; f++) {
+        hash_t* hash = hash_crear_tipo(NULL, TIPOS[f % CANTIDAD_TIPOS]);
+        bool ok = hash_elegir_funcion(hash, funciones[f]);
+        for (size_t i = 0; i < largo && ok; i++) {
+            sprintf(clave, "clave %zu", i);
+            ok = hash_guardar(hash, clave, (void*) (i + 1));
+        }
+        for (size_t i = 0; i < largo && ok; i++) {
+            sprintf(clave, "clave %zu", i);
+            ok = hash_obtener(hash, clave) == (void*) (i + 1);
+        }
+        print_test("Prueba hash funcion guardar y obtener con cada funcion", ok);
+        print_test("Prueba hash funcion no se cambia con elementos", !hash_elegir_funcion(hash, hash_funcion_rapida));
+        hash_destruir(hash);
+    }
+
+    /* Mismos bytes en cualquier alineacion y con cualquier conjunto de
+     * instrucciones dan el mismo hash */
+    const grupo_instrucciones_t instrucciones[] = { GRUPO_ESCALAR, GRUPO_SSE2, GRUPO_AVX2 };
+    const size_t maximo = 2100;
+    unsigned char* bytes = malloc(maximo + 8);
+    unsigned char* copia = malloc(maximo + 8);
+    for (size_t i = 0; i < maximo + 8; i++) bytes[i] = (unsigned char) (i * 131 + (i >> 7));
+
+    bool iguales = true, lookup3_alineado = true;
+    for (size_t n = 0; n <= maximo && iguales; n += (n < 300 ? 1 : 37)) {
+        hash_rapido_elegir_instrucciones(GRUPO_ESCALAR);
+        uint64_t esperado = hash_funcion_rapida(bytes, n, 7);
+        for (size_t j = 0; j < 3; j++) {
+            hash_rapido_elegir_instrucciones(instrucciones[j]);
+            size_t desplazamiento = (n + j) % 8;
+            memcpy(copia + desplazamiento, bytes, n);
+            iguales &= hash_funcion_rapida(copia + desplazamiento, n, 7) == esperado;
+            lookup3_alineado &= hash_funcion_lookup3(copia + desplazamiento, n, 7) == hash_funcion_lookup3(bytes, n, 7);
+        }
+    }
+    hash_rapido_elegir_instrucciones(GRUPO_AUTOMATICO);
+    print_test("Prueba hash funcion rapida no depende de la alineacion ni de las instrucciones", iguales);
+    print_test("Prueba hash funcion lookup3 no depende de la alineacion", lookup3_alineado);
+
+    /* Cambiar cualquier byte de una clave larga cambia el hash */
+    uint64_t original = hash_funcion_rapida(bytes, maximo, 0);
+    bool distintos = hash_funcion_rapida(bytes, maximo, 1) != original;
+    for (size_t i = 0; i < maximo && distintos; i++) {
+        bytes[i] ^= 1;
+        distintos = hash_funcion_rapida(bytes, maximo, 0) != original;
+        bytes[i] ^= 1;
+    }
+    print_test("Prueba hash funcion rapida depende de cada byte y de la semilla", distintos);
+
+    free(bytes);
+    free(copia);
+}
+
+/* Funcion de hash que manda todas las claves a la misma posicion */
+static uint64_t hash_constante(const void* clave, size_t largo, uint64_t semilla)
+{
+    (void) clave; (void) largo; (void) semilla;
+    return 42;
+}
+
+/* Guarda 'largo' claves con hash_constante y devuelve cuanto tarda en
+ * buscarlas todas (el mejor de tres intentos).
+ */
+static double inundar_y_medir(hash_t* hash, size_t largo)
+{
+    char clave[32];
+    hash_elegir_funcion(hash, hash_constante);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "clave %zu", i);
+        hash_guardar(hash, clave, (void*) (i + 1));
+    }
+
+    double mejor = -1;
+    for (size_t intento = 0; intento < 3; intento++) {
+        clock_t inicio = clock();
+        for (size_t i = 0; i < largo; i++) {
+            sprintf(clave, "clave %zu", i);
+            hash_obtener(hash, clave);
+        }
+        double tiempo = (double) (clock() - inicio);
+        if (mejor < 0 || tiempo < mejor) mejor = tiempo;
+    }
+    return mejor;
+}
+
+static void prueba_hash_inundacion()
+{
+    const size_t largo = 20000;
+    char clave[32];
+
+    hash_t* hash = hash_crear(NULL);
+    print_test("Prueba hash inundacion se elige la funcion constante", hash_elegir_funcion(hash, hash_constante));
+
+    bool ok = true;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "clave %zu", i);
+        ok = hash_guardar(hash, clave, (void*) (i + 1));
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "clave %zu", i);
+        ok = hash_obtener(hash, clave) == (void*) (i + 1) && !hash_pertenece(hash, "clave");
+    }
+    print_test("Prueba hash inundacion guardar y obtener todas las claves", ok);
+
+    hash_estadisticas_t estadisticas;
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash inundacion la lista no pasa del maximo", estadisticas.lista_mas_larga <= 16);
+    print_test("Prueba hash inundacion el resto va al desborde", estadisticas.desbordadas + estadisticas.lista_mas_larga == largo);
+
+    size_t recorridos = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter) && ok; hash_iter_avanzar(iter)) {
+        ok = hash_pertenece(hash, hash_iter_ver_actual(iter));
+        recorridos++;
+    }
+    hash_iter_destruir(iter);
+    print_test("Prueba hash inundacion iterar recorre listas y desborde", ok && recorridos == largo);
+
+    for (size_t i = 0; i < largo && ok; i += 2) {
+        sprintf(clave, "clave %zu", i);
+        ok = hash_borrar(hash, clave) == (void*) (i + 1);
+    }
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "clave %zu", i);
+        ok = hash_pertenece(hash, clave) == (i % 2 == 1);
+    }
+    print_test("Prueba hash inundacion borrar la mitad", ok && hash_cantidad(hash) == largo / 2);
+
+    /* Borrar de atras para adelante vacia los trozos del desborde */
+    for (size_t i = largo; i > 0 && ok; i -= 2) {
+        sprintf(clave, "clave %zu", i - 1);
+        ok = hash_borrar(hash, clave) == (void*) i;
+    }
+    hash_estadisticas(hash, &estadisticas);
+    print_test("Prueba hash inundacion borrar el resto vacia el desborde", ok && hash_cantidad(hash) == 0 && estadisticas.desbordadas == 0);
+
+    /* En orden inverso cada clave nueva va al principio del desborde */
+    for (size_t i = largo; i > 0 && ok; i--) {
+        sprintf(clave, "clave %zu", i);
+        ok = hash_guardar(hash, clave, (void*) i);
+    }
+    for (size_t i = 1; i <= largo && ok; i++) {
+        sprintf(clave, "clave %zu", i);
+        ok = hash_obtener(hash, clave) == (void*) i;
+    }
+    print_test("Prueba hash inundacion guardar en orden inverso", ok && hash_cantidad(hash) == largo);
+    hash_destruir(hash);
+
+    /* Sin el desborde cada busqueda recorre toda la lista */
+    hash_t* lineal = hash_crear(NULL);
+    hash_t* ordenado = hash_crear(NULL);
+    hash_desborde_ordenado(lineal, false);
+    double tiempo_lineal = inundar_y_medir(lineal, 3000);
+    double tiempo_ordenado = inundar_y_medir(ordenado, 3000);
+    print_test("Prueba hash inundacion con desborde buscar es mucho mas rapido", tiempo_ordenado * 10 < tiempo_lineal);
+    hash_destruir(lineal);
+    hash_destruir(ordenado);
+}
+
+/* Guarda las mismas claves en dos hashes y devuelve si se recorren en el
+ * mismo orden */
+static bool mismo_orden(hash_t* hash1, hash_t* hash2)
+{
+    char clave[16];
+    for (size_t i = 0; i < 1000; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash1, clave, NULL);
+        hash_guardar(hash2, clave, NULL);
+    }
+
+    bool iguales = true;
+    hash_iter_t* iter1 = hash_iter_crear(hash1);
+    hash_iter_t* iter2 = hash_iter_crear(hash2);
+    for (; !hash_iter_al_final(iter1); hash_iter_avanzar(iter1), hash_iter_avanzar(iter2))
+        iguales &= strcmp(hash_iter_ver_actual(iter1), hash_iter_ver_actual(iter2)) == 0;
+    hash_iter_destruir(iter1);
+    hash_iter_destruir(iter2);
+    hash_destruir(hash1);
+    hash_destruir(hash2);
+    return iguales;
+}
+
+static void prueba_hash_semillas()
+{
+    print_test("Prueba hash semillas cada hash usa una distinta", !mismo_orden(hash_crear(NULL), hash_crear(NULL)));
+
+    hash_t* hash1 = hash_crear(NULL);
+    hash_t* hash2 = hash_crear(NULL);
+    bool elegidas = hash_elegir_semilla(hash1, 7) && hash_elegir_semilla(hash2, 7);
+    print_test("Prueba hash semillas con la misma semilla se repite el orden", elegidas && mismo_orden(hash1, hash2));
+
+    hash1 = hash_crear(NULL);
+    hash_guardar(hash1, "a", NULL);
+    print_test("Prueba hash semillas no se cambia con elementos", !hash_elegir_semilla(hash1, 7));
+    hash_destruir(hash1);
+}
+
+static void prueba_hash_reservas()
+{
+    const size_t largo = 5000;
+    char clave[300];
+
+    /* Claves cortas y largas (las de mas de 256 bytes no van a las reservas) */
+    hash_t* hash = hash_crear(free);
+    bool ok = true;
+    for (size_t i = 0; i < largo; i++) {
+        memset(clave, 'x', sizeof(clave));
+        sprintf(clave, "%zu", i);
+        clave[i % 2 ? strlen(clave) : sizeof(clave) - 1] = '\0';
+        ok &= hash_guardar(hash, clave, malloc(8));
+    }
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "%zu", i);
+        free(hash_borrar(hash, clave));
+    }
+    print_test("Prueba hash reservas claves cortas y largas", ok && hash_cantidad(hash) == largo / 2);
+    hash_destruir(hash);
+
+#ifdef CONTADOR_MEMORIA
+    /* Lo que se borra se reusa: volver a guardar las claves borradas solo pide
+     * memoria para las listas que quedaron vacias (antes eran tres pedidos
+     * por clave: nodo, clave y nodo de la lista) */
+    hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "clave %zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "clave %zu", i);
+        hash_borrar(hash, clave);
+    }
+    size_t antes = pedidos_memoria;
+    for (size_t i = 0; i < largo; i += 2) {
+        sprintf(clave, "clave %zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+    print_test("Prueba hash reservas reinsertar reusa nodos y claves", pedidos_memoria - antes <= largo / 2);
+    hash_destruir(hash);
+#endif
+}
+
+static void prueba_hash_claves_cortas()
+{
+    char clave[40];
+    hash_t* hash = hash_crear(NULL);
+
+    /* Claves alrededor del largo que entra dentro del nodo */
+    bool ok = true;
+    for (size_t largo = 20; largo < 28; largo++) {
+        memset(clave, 'a' + (int) largo - 20, largo);
+        ok &= hash_guardar_n(hash, clave, largo, (void*) largo);
+    }
+    for (size_t largo = 20; largo < 28; largo++) {
+        memset(clave, 'a' + (int) largo - 20, largo);
+        ok &= hash_obtener_n(hash, clave, largo) == (void*) largo;
+    }
+    print_test("Prueba hash claves cortas y largas dentro y fuera del nodo", ok);
+
+    /* La clave que devuelve el iterador sigue valida despues de redimensionar */
+    hash_iter_t* iter = hash_iter_crear(hash);
+    const char* vista = hash_iter_ver_actual(iter);
+    size_t largo_vista = hash_iter_ver_largo(iter);
+    char copia[40];
+    memcpy(copia, vista, largo_vista + 1);
+    hash_iter_destruir(iter);
+
+    for (size_t i = 0; i < 5000; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+    print_test("Prueba hash claves cortas el puntero del iterador es estable",
+               memcmp(vista, copia, largo_vista + 1) == 0 && hash_obtener_n(hash, vista, largo_vista) == (void*) largo_vista);
+    hash_destruir(hash);
+}
+
+/* Allocator que cuenta los pedidos y los bloques todavia no liberados */
+typedef struct cuenta_allocator {
+    size_t pedidos;
+    size_t en_uso;
+} cuenta_allocator_t;
+
+static void* contar_pedido(void* contexto, size_t tam)
+{
+    cuenta_allocator_t* cuenta = contexto;
+    void* elemento = malloc(tam);
+    if (elemento) {
+        cuenta->pedidos++;
+        cuenta->en_uso++;
+    }
+    return elemento;
+}
+
+static void contar_liberado(void* contexto, void* elemento)
+{
+    cuenta_allocator_t* cuenta = contexto;
+    cuenta->en_uso--;
+    free(elemento);
+}
+
+static void prueba_hash_allocator(hash_tipo_t tipo)
+{
+    cuenta_allocator_t cuenta = { 0, 0 };
+    hash_allocator_t allocator = { contar_pedido, contar_liberado, &cuenta };
+    char clave[300];
+#ifdef CONTADOR_MEMORIA
+    size_t antes = pedidos_memoria;
+#endif
+
+    hash_t* hash = hash_crear_con_allocator(free, tipo, &allocator);
+    bool ok = hash != NULL;
+    for (size_t i = 0; i < 3000 && ok; i++) {
+        memset(clave, 'x', sizeof(clave));
+        sprintf(clave, "%zu", i);
+        clave[i % 3 ? strlen(clave) : sizeof(clave) - 1] = '\0';
+        ok = hash_guardar(hash, clave, malloc(8));
+    }
+    hash_iter_t* iter = hash_iter_crear(hash);
+    ok &= iter && cuenta.en_uso > 0;
+    hash_iter_destruir(iter);
+    for (size_t i = 0; i < 3000; i += 2) {
+        sprintf(clave, "%zu", i);
+        free(hash_borrar(hash, clave));
+    }
+    hash_destruir(hash);
+
+    print_test("Prueba hash allocator guarda, itera y borra", ok);
+    print_test("Prueba hash allocator se libera todo lo pedido", cuenta.en_uso == 0);
+#ifdef CONTADOR_MEMORIA
+    /* Los unicos malloc directos son los de los datos y los del allocator */
+    print_test("Prueba hash allocator toda la memoria pasa por el allocator", pedidos_memoria - antes == 3000 + cuenta.pedidos);
+#endif
+}
+
+static void prueba_hash_chico()
+{
+    char clave[16];
+
+#ifdef CONTADOR_MEMORIA
+    size_t antes = pedidos_memoria;
+    hash_t* vacio = hash_crear(NULL);
+    print_test("Prueba hash chico crear pide solo la estructura", vacio && pedidos_memoria - antes == 1);
+    hash_destruir(vacio);
+#endif
+
+    /* Guarda, reemplaza, borra e itera sin vector */
+    hash_t* hash = hash_crear(free);
+    bool ok = true;
+    for (size_t i = 0; i < 8; i++) {
+        sprintf(clave, "chica %zu", i);
+        ok &= hash_guardar(hash, clave, malloc(4));
+    }
+    ok &= hash_guardar(hash, "chica 3", malloc(4));
+    free(hash_borrar(hash, "chica 0"));
+    ok &= hash_cantidad(hash) == 7 && !hash_pertenece(hash, "chica 0") && hash_pertenece(hash, "chica 7");
+
+    size_t recorridas = 0;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter))
+        recorridas += hash_pertenece(hash, hash_iter_ver_actual(iter));
+    hash_iter_destruir(iter);
+    print_test("Prueba hash chico guardar, borrar e iterar", ok && recorridas == 7);
+
+    /* Pasa al vector: sin memoria no pierde nada y despues pasa */
+#ifdef CONTADOR_MEMORIA
+    bool insertado = false;
+    for (size_t fallar_en = 0; !insertado && ok; fallar_en++) {
+        pedidos_hasta_falla = fallar_en;
+        insertado = hash_guardar(hash, "chica 8", NULL) && hash_guardar(hash, "chica 9", NULL);
+        pedidos_hasta_falla = (size_t) -1;
+        for (size_t i = 1; i < 8 && ok; i++) {
+            sprintf(clave, "chica %zu", i);
+            ok = hash_pertenece(hash, clave);
+        }
+    }
+    print_test("Prueba hash chico pasar al vector sin memoria conserva las claves", ok);
+#endif
+    for (size_t i = 8; i < 100; i++) {
+        sprintf(clave, "chica %zu", i);
+        ok &= hash_guardar(hash, clave, NULL);
+    }
+    ok &= hash_cantidad(hash) == 99;
+    for (size_t i = 1; i < 100 && ok; i++) {
+        sprintf(clave, "chica %zu", i);
+        ok = hash_pertenece(hash, clave);
+    }
+    print_test("Prueba hash chico pasar al vector conserva las claves", ok);
+    hash_destruir(hash);
+}
+
+static void prueba_hash_reservar(hash_tipo_t tipo)
+{
+    const size_t largo = 20000;
+    char clave[16];
+
+    hash_t* hash = hash_crear_con_capacidad(NULL, tipo, largo);
+    hash_estadisticas_t estadisticas;
+    bool con_estadisticas = hash_estadisticas(hash, &estadisticas);
+
+    /* Guardar lo reservado no redimensiona: el vector abierto se pide una vez
+     * con un largo por clave reservada */
+#ifdef CONTADOR_MEMORIA
+    size_t antes = pedidos_memoria;
+#endif
+    bool ok = hash != NULL;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_guardar(hash, clave, NULL);
+    }
+#ifdef CONTADOR_MEMORIA
+    /* El hash cerrado solo pide cada clave; el abierto sus listas y bloques */
+    if (tipo != HASH_ABIERTO) ok &= pedidos_memoria - antes == largo;
+#endif
+    if (con_estadisticas) {
+        hash_estadisticas(hash, &estadisticas);
+        ok &= estadisticas.largo == largo;
+    }
+    print_test("Prueba hash reservar guardar lo reservado no redimensiona", ok);
+
+    /* Borrar todo no lo achica por debajo de lo reservado */
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_borrar(hash, clave);
+    }
+#ifdef CONTADOR_MEMORIA
+    antes = pedidos_memoria;
+#endif
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_guardar(hash, clave, NULL);
+    }
+#ifdef CONTADOR_MEMORIA
+    if (tipo != HASH_ABIERTO) ok &= pedidos_memoria - antes == largo;
+#endif
+    if (con_estadisticas) {
+        hash_estadisticas(hash, &estadisticas);
+        ok &= estadisticas.largo == largo;
+    }
+    print_test("Prueba hash reservar borrar no achica por debajo de lo reservado", ok);
+
+    /* Reservar con claves reubica una sola vez */
+    ok = hash_reservar(hash, 4 * largo) && hash_cantidad(hash) == largo;
+    for (size_t i = 0; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_pertenece(hash, clave);
+    }
+    if (con_estadisticas) {
+        hash_estadisticas(hash, &estadisticas);
+        ok &= estadisticas.largo >= 4 * largo;
+    }
+    print_test("Prueba hash reservar con claves las conserva", ok);
+    hash_destruir(hash);
+}
+
+static size_t claves_hasheadas;
+
+/* hash_funcion_rapida contando las veces que se llama */
+static uint64_t hash_contado(const void* clave, size_t largo, uint64_t semilla)
+{
+    claves_hasheadas++;
+    return hash_funcion_rapida(clave, largo, semilla);
+}
+
+static void* sumar_uno(void* dato, void* extra)
+{
+    (*(size_t*) extra)++;
+    return (void*) ((size_t) dato + 1);
+}
+
+static void prueba_hash_obtener_o_insertar(hash_tipo_t tipo)
+{
+    const size_t distintas = 500, vueltas = 10;
+    char clave[16];
+
+    /* Contar apariciones: un solo hash por operacion */
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+    hash_elegir_funcion(hash, hash_contado);
+    claves_hasheadas = 0;
+    size_t insertadas = 0;
+    bool ok = true;
+    for (size_t i = 0; i < distintas * vueltas && ok; i++) {
+        sprintf(clave, "%zu", i % distintas);
+        void** dato;
+        bool insertado;
+        ok = hash_obtener_o_insertar(hash, clave, &dato, &insertado);
+        ok &= !insertado || *dato == NULL;
+        insertadas += insertado;
+        *dato = (void*) ((size_t) *dato + 1);
+    }
+    ok &= claves_hasheadas == distintas * vueltas && insertadas == distintas && hash_cantidad(hash) == distintas;
+    for (size_t i = 0; i < distintas && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = (size_t) hash_obtener(hash, clave) == vueltas;
+    }
+    print_test("Prueba hash obtener o insertar cuenta con un hash por operacion", ok);
+
+    /* hash_actualizar sobre claves nuevas y guardadas */
+    claves_hasheadas = 0;
+    size_t llamadas = 0;
+    ok = true;
+    for (size_t i = 0; i < 2 * distintas && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_actualizar(hash, clave, sumar_uno, &llamadas);
+    }
+    ok &= claves_hasheadas == 2 * distintas && llamadas == 2 * distintas;
+    ok &= hash_cantidad(hash) == 2 * distintas;
+    ok &= (size_t) hash_obtener(hash, "0") == vueltas + 1 && (size_t) hash_obtener(hash, "999") == 1;
+    print_test("Prueba hash actualizar suma sobre claves nuevas y guardadas", ok);
+    print_test("Prueba hash obtener o insertar con parametros invalidos",
+               !hash_obtener_o_insertar(hash, NULL, NULL, NULL) && !hash_actualizar(hash, "0", NULL, NULL));
+    hash_destruir(hash);
+
+    /* En el hash abierto la direccion del dato sobrevive a las redimensiones */
+    if (tipo == HASH_ABIERTO) {
+        hash = hash_crear_tipo(NULL, tipo);
+        void** primero;
+        ok = hash_obtener_o_insertar(hash, "primero", &primero, NULL);
+        for (size_t i = 0; i < 20000 && ok; i++) {
+            sprintf(clave, "%zu", i);
+            ok = hash_guardar(hash, clave, NULL);
+        }
+        *primero = clave;
+        print_test("Prueba hash obtener o insertar direccion estable", ok && hash_obtener(hash, "primero") == clave);
+        hash_destruir(hash);
+    }
+}
+
+/* Largo del vector del hash abierto */
+typedef struct visitas {
+    bool* vistas;                   // Por el dato de cada clave, i + 1
+    size_t cantidad;
+    size_t repetidas;
+    size_t limite;                  // Corta la iteracion al llegar a esta cantidad
+} visitas_t;
+
+static bool visitar(const char* clave, size_t largo, void* dato, void* extra)
+{
+    visitas_t* visitas = extra;
+    size_t i = (size_t) dato - 1;
+    if (visitas->vistas[i] || largo != strlen(clave)) visitas->repetidas++;
+    visitas->vistas[i] = true;
+    return ++visitas->cantidad < visitas->limite;
+}
+
+static bool contar_visitada(const char* clave, size_t largo, void* dato, void* extra)
+{
+    (void) clave;
+    (void) largo;
+    (void) dato;
+    (*(size_t*) extra)++;
+    return true;
+}
+
+#define HILOS 4
+
+/* Cuenta las visitas de cada clave desde varios hilos a la vez */
+typedef struct visitas_paralelas {
+    size_t* veces;                  // Por el dato de cada clave, i + 1
+    size_t cantidad;
+    bool cortar;                    // visitar devuelve false
+} visitas_paralelas_t;
+
+static bool visitar_en_paralelo(const char* clave, size_t largo, void* dato, void* extra)
+{
+    visitas_paralelas_t* visitas = extra;
+    (void) clave;
+    (void) largo;
+    __atomic_fetch_add(&visitas->veces[(size_t) dato - 1], 1, __ATOMIC_RELAXED);
+    __atomic_fetch_add(&visitas->cantidad, 1, __ATOMIC_RELAXED);
+    return !visitas->cortar;
+}
+
+/* Devuelve si cada una de las largo claves se visito exactamente una vez */
+static bool visitadas_una_vez(const size_t* veces, size_t largo)
+{
+    for (size_t i = 0; i < largo; i++)
+        if (veces[i] != 1) return false;
+    return true;
+}
+
+static void prueba_hash_recorrido_con(hash_tipo_t tipo, size_t largo, const char* descripcion)
+{
+    char clave[24];
+    char texto[128];
+    bool* vistas = calloc(largo + 1, sizeof(bool));
+
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+    hash_redimension_incremental(hash, true);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, (void*) (i + 1));
+    }
+
+    /* El recorrido en el stack visita cada clave una vez, igual que el iterador */
+    hash_recorrido_t recorrido;
+    hash_iter_t* iter = hash_iter_crear(hash);
+    size_t recorridos = 0;
+    bool ok = true;
+    for (hash_recorrido_iniciar(&recorrido, hash); !hash_recorrido_al_final(&recorrido) && ok;
+         hash_recorrido_avanzar(&recorrido)) {
+        const char* actual = hash_recorrido_ver_actual(&recorrido);
+        size_t i = (size_t) hash_recorrido_ver_dato(&recorrido) - 1;
+        ok = i < largo && !vistas[i] && hash_obtener(hash, actual) == (void*) (i + 1);
+        ok &= hash_recorrido_ver_largo(&recorrido) == strlen(actual);
+        ok &= actual == hash_iter_ver_actual(iter);
+        vistas[i] = true;
+        recorridos++;
+        hash_iter_avanzar(iter);
+    }
+    ok &= hash_iter_al_final(iter) && !hash_recorrido_avanzar(&recorrido);
+    ok &= !hash_recorrido_ver_actual(&recorrido) && !hash_recorrido_ver_dato(&recorrido);
+    hash_iter_destruir(iter);
+    sprintf(texto, "Prueba hash recorrido %s visita todas las claves como el iterador", descripcion);
+    print_test(texto, ok && recorridos == largo);
+
+    /* hash_iterar visita todas una vez, o corta cuando visitar devuelve false */
+    memset(vistas, 0, largo * sizeof(bool));
+    visitas_t visitas = { vistas, 0, 0, (size_t) -1 };
+    hash_iterar(hash, visitar, &visitas);
+    sprintf(texto, "Prueba hash iterar %s visita todas las claves", descripcion);
+    print_test(texto, visitas.cantidad == largo && visitas.repetidas == 0);
+
+    memset(vistas, 0, largo * sizeof(bool));
+    visitas = (visitas_t) { vistas, 0, 0, largo / 2 };
+    hash_iterar(hash, visitar, &visitas);
+    sprintf(texto, "Prueba hash iterar %s corta cuando visitar devuelve false", descripcion);
+    print_test(texto, visitas.cantidad == largo / 2);
+
+    /* Las partes, iteradas por separado o en paralelo, visitan cada clave una vez */
+    size_t* veces = calloc(largo + 1, sizeof(size_t));
+    visitas_paralelas_t paralelas = { veces, 0, false };
+    for (size_t parte = 0; parte < 3; parte++)
+        hash_iterar_parte(hash, parte, 3, visitar_en_paralelo, &paralelas);
+    sprintf(texto, "Prueba hash iterar %s por partes visita cada clave una vez", descripcion);
+    print_test(texto, paralelas.cantidad == largo && visitadas_una_vez(veces, largo));
+
+    memset(veces, 0, largo * sizeof(size_t));
+    paralelas = (visitas_paralelas_t) { veces, 0, false };
+    hash_iterar_paralelo(hash, visitar_en_paralelo, &paralelas, HILOS);
+    sprintf(texto, "Prueba hash iterar %s en paralelo visita cada clave una vez", descripcion);
+    print_test(texto, paralelas.cantidad == largo && visitadas_una_vez(veces, largo));
+
+    paralelas = (visitas_paralelas_t) { veces, 0, true };
+    hash_iterar_paralelo(hash, visitar_en_paralelo, &paralelas, HILOS);
+    sprintf(texto, "Prueba hash iterar %s en paralelo corta cuando visitar devuelve false", descripcion);
+    print_test(texto, paralelas.cantidad <= HILOS && (paralelas.cantidad > 0 || !largo));
+    free(veces);
+
+#ifdef CONTADOR_MEMORIA
+    size_t antes = pedidos_memoria;
+    for (hash_recorrido_iniciar(&recorrido, hash); !hash_recorrido_al_final(&recorrido);)
+        hash_recorrido_avanzar(&recorrido);
+    visitas = (visitas_t) { vistas, 0, 0, (size_t) -1 };
+    hash_iterar(hash, visitar, &visitas);
+    sprintf(texto, "Prueba hash recorrido e iterar %s no piden memoria", descripcion);
+    print_test(texto, pedidos_memoria == antes);
+#endif
+
+    hash_destruir(hash);
+    free(vistas);
+}
+
+static void prueba_hash_recorrido(hash_tipo_t tipo)
+{
+    prueba_hash_recorrido_con(tipo, 0, "vacio");
+    prueba_hash_recorrido_con(tipo, 5, "chico");
+    prueba_hash_recorrido_con(tipo, 1940, "mientras migra");     // En el hash abierto
+    prueba_hash_recorrido_con(tipo, 20000, "grande");
+
+    print_test("Prueba hash recorrido sin hash esta al final", hash_recorrido_al_final(NULL));
+}
+
+static size_t largo_vector(const hash_t* hash)
+{
+    hash_estadisticas_t estadisticas;
+    return hash_estadisticas(hash, &estadisticas) ? estadisticas.largo : 0;
+}
+
+static void prueba_hash_lote(hash_tipo_t tipo)
+{
+    const size_t largo = 5000;
+    char (*textos)[16] = malloc(2 * largo * sizeof(*textos));
+    const char** claves = malloc(2 * largo * sizeof(char*));
+    void** datos = malloc(2 * largo * sizeof(void*));
+    bool* pertenecen = malloc(2 * largo * sizeof(bool));
+    for (size_t i = 0; i < 2 * largo; i++) {
+        sprintf(textos[i], "%zu", i);
+        claves[i] = textos[i];
+    }
+
+    /* Hash chico, con una clave que no esta y una NULL */
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+    hash_guardar(hash, "a", textos[0]);
+    hash_guardar(hash, "b", textos[1]);
+    const char* pocas[] = { "b", "no esta", NULL, "a" };
+    size_t encontradas = hash_obtener_lote(hash, pocas, 4, datos);
+    bool ok = encontradas == 2 && datos[0] == textos[1] && !datos[1] && !datos[2] && datos[3] == textos[0];
+    encontradas = hash_pertenece_lote(hash, pocas, 4, pertenecen);
+    ok &= encontradas == 2 && pertenecen[0] && !pertenecen[1] && !pertenecen[2] && pertenecen[3];
+    print_test("Prueba hash lote en un hash chico", ok);
+    hash_destruir(hash);
+
+    /* La mitad de las claves estan; con migracion incremental en curso */
+    hash = hash_crear_tipo(NULL, tipo);
+    hash_redimension_incremental(hash, true);
+    for (size_t i = 0; i < largo; i++)
+        hash_guardar(hash, claves[i], textos[i]);
+
+    encontradas = hash_obtener_lote(hash, claves, 2 * largo, datos);
+    ok = encontradas == largo;
+    for (size_t i = 0; i < 2 * largo && ok; i++)
+        ok = datos[i] == hash_obtener(hash, claves[i]) && datos[i] == (i < largo ? textos[i] : NULL);
+    print_test("Prueba hash lote obtener encuentra lo mismo que hash_obtener", ok);
+
+    encontradas = hash_pertenece_lote(hash, claves, 2 * largo, pertenecen);
+    ok = encontradas == largo;
+    for (size_t i = 0; i < 2 * largo && ok; i++)
+        ok = pertenecen[i] == (i < largo);
+    print_test("Prueba hash lote pertenece encuentra lo mismo que hash_pertenece", ok);
+    print_test("Prueba hash lote vacio no encuentra nada", hash_obtener_lote(hash, claves, 0, datos) == 0);
+
+    hash_destruir(hash);
+    free(pertenecen);
+    free(datos);
+    free(claves);
+    free(textos);
+}
+
+static size_t datos_destruidos;
+
+static void contar_destruido(void* dato)
+{
+    (void) dato;
+    datos_destruidos++;
+}
+
+static void prueba_hash_guardar_lote(hash_tipo_t tipo)
+{
+    const size_t largo = 20000, repetidas = 1000;
+    char (*textos)[16] = malloc(largo * sizeof(*textos));
+    const char** claves = malloc((largo + repetidas) * sizeof(char*));
+    void** datos = malloc((largo + repetidas) * sizeof(void*));
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(textos[i], "%zu", i);
+        claves[i] = textos[i];
+        datos[i] = textos[i];
+    }
+    /* Al final del lote se repiten las primeras claves con otro dato */
+    for (size_t i = 0; i < repetidas; i++) {
+        claves[largo + i] = textos[i];
+        datos[largo + i] = textos[largo - 1 - i];
+    }
+
+    hash_opciones_t opciones;
+    hash_opciones_por_defecto(&opciones);
+    opciones.tipo = tipo;
+    datos_destruidos = 0;
+    hash_t* hash = hash_crear_con_lote(contar_destruido, &opciones, claves, datos, largo + repetidas);
+    bool ok = hash && hash_cantidad(hash) == largo && datos_destruidos == repetidas;
+    for (size_t i = 0; i < largo && ok; i++)
+        ok = hash_obtener(hash, textos[i]) == (i < repetidas ? textos[largo - 1 - i] : textos[i]);
+    print_test("Prueba hash crear con lote guarda todo y queda la ultima repetida", ok);
+    print_test("Prueba hash crear con lote no achica el hash durante la carga",
+               tipo != HASH_ABIERTO || largo_vector(hash) >= largo);
+
+    /* Un lote sobre claves ya guardadas las reemplaza */
+    datos_destruidos = 0;
+    ok = hash_guardar_lote(hash, claves, NULL, repetidas);
+    ok &= hash_cantidad(hash) == largo && datos_destruidos == repetidas;
+    for (size_t i = 0; i < repetidas && ok; i++)
+        ok = hash_pertenece(hash, textos[i]) && !hash_obtener(hash, textos[i]);
+    print_test("Prueba hash guardar lote reemplaza las claves guardadas", ok);
+
+    /* Casos borde: lote vacio y clave NULL */
+    ok = hash_guardar_lote(hash, NULL, NULL, 0);
+    const char* con_nula[] = { "nueva", NULL };
+    ok &= !hash_guardar_lote(hash, con_nula, NULL, 2) && hash_pertenece(hash, "nueva");
+    print_test("Prueba hash guardar lote vacio y con clave NULL", ok);
+    hash_destruir(hash);
+
+    /* Un lote chico en un hash chico */
+    hash = hash_crear_tipo(NULL, tipo);
+    ok = hash_guardar_lote(hash, claves, datos, 3) && hash_cantidad(hash) == 3;
+    ok &= hash_obtener(hash, textos[2]) == textos[2];
+    print_test("Prueba hash guardar lote chico", ok);
+    hash_destruir(hash);
+
+    free(datos);
+    free(claves);
+    free(textos);
+}
+
+/* Devuelve si los dos hashes recorren las mismas claves, con los mismos
+ * datos y en el mismo orden.
+ */
+static bool mismo_recorrido(const hash_t* hash1, const hash_t* hash2)
+{
+    hash_recorrido_t recorrido1, recorrido2;
+    hash_recorrido_iniciar(&recorrido1, hash1);
+    hash_recorrido_iniciar(&recorrido2, hash2);
+    while (!hash_recorrido_al_final(&recorrido1) && !hash_recorrido_al_final(&recorrido2)) {
+        size_t largo = hash_recorrido_ver_largo(&recorrido1);
+        if (largo != hash_recorrido_ver_largo(&recorrido2)) return false;
+        if (memcmp(hash_recorrido_ver_actual(&recorrido1), hash_recorrido_ver_actual(&recorrido2), largo)) return false;
+        if (hash_recorrido_ver_dato(&recorrido1) != hash_recorrido_ver_dato(&recorrido2)) return false;
+        hash_recorrido_avanzar(&recorrido1);
+        hash_recorrido_avanzar(&recorrido2);
+    }
+    return hash_recorrido_al_final(&recorrido1) && hash_recorrido_al_final(&recorrido2);
+}
+
+/* Devuelve si el recorrido del hash pasa por cantidad claves y cada una esta */
+static bool recorrido_completo(const hash_t* hash)
+{
+    size_t recorridas = 0;
+    bool ok = true;
+    hash_recorrido_t recorrido;
+    for (hash_recorrido_iniciar(&recorrido, hash); !hash_recorrido_al_final(&recorrido); hash_recorrido_avanzar(&recorrido)) {
+        recorridas++;
+        ok &= hash_obtener_n(hash, hash_recorrido_ver_actual(&recorrido), hash_recorrido_ver_largo(&recorrido))
+              == hash_recorrido_ver_dato(&recorrido);
+    }
+    return ok && recorridas == hash_cantidad(hash);
+}
+
+/* Funcion de hash con solo 16384 codigos: en una tabla grande las claves
+ * quedan todas al principio.
+ */
+static uint64_t hash_amontonado(const void* clave, size_t largo, uint64_t semilla)
+{
+    return hash_funcion_rapida(clave, largo, semilla) % 16384;
+}
+
+static void prueba_hash_hilos(hash_tipo_t tipo)
+{
+    const size_t largo = 60000, repetidas = 1000;
+    char (*textos)[16] = malloc(2 * largo * sizeof(*textos));
+    const char** claves = malloc((largo + repetidas + 1) * sizeof(char*));
+    void** datos = malloc((largo + repetidas + 1) * sizeof(void*));
+    for (size_t i = 0; i < 2 * largo; i++)
+        sprintf(textos[i], "%zu", i);
+    for (size_t i = 0; i < largo; i++) {
+        claves[i] = textos[i];
+        datos[i] = textos[i];
+    }
+    /* Repetidas con otro dato y una clave NULL en el medio del lote */
+    for (size_t i = 0; i < repetidas; i++) {
+        claves[largo + i] = textos[i * 7];
+        datos[largo + i] = textos[i];
+    }
+    claves[largo + repetidas] = claves[largo / 2];
+    datos[largo + repetidas] = datos[largo / 2];
+    claves[largo / 2] = NULL;
+
+    /* El mismo lote con un hilo y con HILOS, con la misma semilla */
+    hash_t* hashes[2];
+    bool guardados[2];
+    for (size_t i = 0; i < 2; i++) {
+        hash_opciones_t opciones;
+        hash_opciones_por_defecto(&opciones);
+        opciones.tipo = tipo;
+        opciones.hilos = i ? HILOS : 1;
+        hashes[i] = hash_crear_con_opciones(NULL, &opciones);
+        hash_elegir_semilla(hashes[i], 42);
+        guardados[i] = hash_guardar_lote(hashes[i], claves, datos, largo + repetidas + 1);
+    }
+    bool ok = !guardados[0] && !guardados[1];
+    ok &= hash_cantidad(hashes[0]) == largo && hash_cantidad(hashes[1]) == largo;
+    ok &= hash_obtener(hashes[1], textos[7]) == textos[1] && hash_obtener(hashes[1], textos[largo / 2]) == textos[largo / 2];
+    print_test("Prueba hash con hilos guarda el lote como con uno", ok);
+    print_test("Prueba hash con hilos queda igual que con uno", mismo_recorrido(hashes[0], hashes[1]));
+
+    /* Reservar mas reubica todas las claves */
+    ok = hash_reservar(hashes[0], 4 * largo) && hash_reservar(hashes[1], 4 * largo);
+    print_test("Prueba hash con hilos queda igual despues de reubicar", ok && mismo_recorrido(hashes[0], hashes[1]));
+
+    /* Un lote sobre el hash con claves: la mitad ya estan (cambia el dato) */
+    for (size_t i = 0; i < largo; i++) {
+        claves[i] = textos[largo / 2 + i];
+        datos[i] = textos[i];
+    }
+    ok = hash_guardar_lote(hashes[0], claves, datos, largo) && hash_guardar_lote(hashes[1], claves, datos, largo);
+    ok &= hash_cantidad(hashes[1]) == largo + largo / 2 && hash_obtener(hashes[1], textos[largo - 1]) == textos[largo / 2 - 1];
+    ok &= hash_obtener(hashes[1], textos[largo + 1]) == textos[largo / 2 + 1] && recorrido_completo(hashes[1]);
+    print_test("Prueba hash con hilos guarda un lote sobre claves guardadas", ok && mismo_recorrido(hashes[0], hashes[1]));
+
+#ifdef CONTADOR_MEMORIA
+    /* Sin memoria para reubicar con hilos no pierde nada, hasta que puede.
+     * Se pide una lista por posicion nueva: falla en pedidos cada vez mas lejos. */
+    bool reservado = false;
+    ok = true;
+    for (size_t fallar_en = 0; !reservado && ok; fallar_en = 2 * fallar_en + 1) {
+        pedidos_hasta_falla = fallar_en;
+        reservado = hash_reservar(hashes[1], 16 * largo);
+        pedidos_hasta_falla = (size_t) -1;
+        ok = hash_cantidad(hashes[1]) == largo + largo / 2 && recorrido_completo(hashes[1]);
+    }
+    print_test("Prueba hash con hilos reubicar sin memoria conserva los elementos", ok && reservado);
+
+    /* Un lote que se queda sin memoria a mitad de camino guarda una parte */
+    for (size_t i = 0; i < largo / 2; i++) {
+        claves[i] = textos[largo + largo / 2 + i];
+        datos[i] = textos[i];
+    }
+    pedidos_hasta_falla = 40;
+    bool guardado = hash_guardar_lote(hashes[1], claves, datos, largo / 2);
+    pedidos_hasta_falla = (size_t) -1;
+    ok = !guardado && recorrido_completo(hashes[1]);
+    ok &= hash_guardar_lote(hashes[1], claves, datos, largo / 2) && hash_cantidad(hashes[1]) == 2 * largo;
+    ok &= hash_obtener(hashes[1], textos[2 * largo - 1]) == textos[largo / 2 - 1] && recorrido_completo(hashes[1]);
+    print_test("Prueba hash con hilos lote sin memoria queda consistente", ok);
+#endif
+
+    /* Amontonadas se corren de su rango al reubicar por partes */
+    hash_t* amontonados[2];
+    for (size_t i = 0; i < 2; i++) {
+        hash_opciones_t opciones;
+        hash_opciones_por_defecto(&opciones);
+        opciones.tipo = tipo;
+        opciones.hilos = i ? HILOS : 1;
+        amontonados[i] = hash_crear_con_opciones(NULL, &opciones);
+        hash_elegir_semilla(amontonados[i], 42);
+        hash_elegir_funcion(amontonados[i], hash_amontonado);
+        hash_guardar_lote(amontonados[i], (const char* const*) claves, NULL, largo / 3);
+        hash_reservar(amontonados[i], largo);
+    }
+    ok = hash_cantidad(amontonados[1]) == largo / 3 && recorrido_completo(amontonados[1]);
+    print_test("Prueba hash con hilos reubica claves amontonadas", ok && mismo_recorrido(amontonados[0], amontonados[1]));
+    hash_destruir(amontonados[0]);
+    hash_destruir(amontonados[1]);
+
+    hash_opciones_t invalidas;
+    hash_opciones_por_defecto(&invalidas);
+    invalidas.hilos = 0;
+    print_test("Prueba hash con cero hilos no se crea", !hash_crear_con_opciones(NULL, &invalidas));
+
+    hash_destruir(hashes[0]);
+    hash_destruir(hashes[1]);
+    free(datos);
+    free(claves);
+    free(textos);
+}
+
+static void prueba_hash_opciones()
+{
+    char clave[16];
+    hash_opciones_t opciones;
+
+    /* Opciones invalidas: el minimo tiene que quedar debajo de la carga objetivo */
+    hash_opciones_por_defecto(&opciones);
+    opciones.factor_carga_minimo = 1;
+    bool invalidas = !hash_crear_con_opciones(NULL, &opciones);
+    hash_opciones_por_defecto(&opciones);
+    opciones.crecimiento = 1;
+    invalidas &= !hash_crear_con_opciones(NULL, &opciones);
+    print_test("Prueba hash opciones invalidas no crean el hash", invalidas);
+
+    /* Guardar y borrar alrededor de cada umbral redimensiona una sola vez */
+    hash_opciones_por_defecto(&opciones);
+    opciones.largo_minimo = 100;
+    hash_t* hash = hash_crear_con_opciones(NULL, &opciones);
+    for (size_t i = 0; i < 250; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, NULL);
+    }
+    size_t cambios = 0, largo = largo_vector(hash);
+    for (size_t i = 0; i < 1000; i++) {
+        if (i % 2 == 0) hash_guardar(hash, "vaiven", NULL);
+        else hash_borrar(hash, "vaiven");
+        cambios += largo_vector(hash) != largo;
+        largo = largo_vector(hash);
+    }
+    print_test("Prueba hash opciones vaiven al crecer redimensiona una vez", cambios == 1);
+
+    /* Borra hasta que achica y sigue con el vaiven en ese punto */
+    size_t i = 0;
+    largo = largo_vector(hash);
+    while (largo_vector(hash) == largo) {
+        sprintf(clave, "%zu", i++);
+        hash_borrar(hash, clave);
+    }
+    cambios = 0;
+    largo = largo_vector(hash);
+    for (size_t j = 0; j < 1000; j++) {
+        if (j % 2 == 0) hash_guardar(hash, "vaiven", NULL);
+        else hash_borrar(hash, "vaiven");
+        cambios += largo_vector(hash) != largo;
+        largo = largo_vector(hash);
+    }
+    print_test("Prueba hash opciones vaiven despues de achicar no redimensiona", cambios == 0 && largo >= 100);
+    hash_destruir(hash);
+
+    /* Sin achicar automatico solo achica hash_compactar */
+    for (size_t t = 0; t < CANTIDAD_TIPOS; t++) {
+        hash_opciones_por_defecto(&opciones);
+        opciones.tipo = TIPOS[t];
+        opciones.achicar = false;
+        hash = hash_crear_con_opciones(NULL, &opciones);
+        for (size_t j = 0; j < 20000; j++) {
+            sprintf(clave, "%zu", j);
+            hash_guardar(hash, clave, NULL);
+        }
+        size_t lleno = largo_vector(hash);
+        for (size_t j = 0; j < 19990; j++) {
+            sprintf(clave, "%zu", j);
+            hash_borrar(hash, clave);
+        }
+        bool ok = largo_vector(hash) == lleno;
+        ok &= hash_compactar(hash) && largo_vector(hash) <= lleno;
+        if (TIPOS[t] == HASH_ABIERTO) ok &= largo_vector(hash) < lleno;
+        for (size_t j = 19990; j < 20000 && ok; j++) {
+            sprintf(clave, "%zu", j);
+            ok = hash_pertenece(hash, clave);
+        }
+        printf("~ %s ~ ", NOMBRES_TIPOS[t]);
+        print_test("Prueba hash opciones sin achicar, compactar conserva las claves", ok && hash_cantidad(hash) == 10);
+        hash_destruir(hash);
+    }
+}
+
+/* Borrar una clave justo cuando el hash abierto deberia achicarse, sin
+ * memoria para achicarlo: la clave se borra igual y el vector queda como
+ * estaba.
+ */
+static void prueba_hash_borrar_sin_memoria()
+{
+#ifdef CONTADOR_MEMORIA
+    const size_t largo = 2000;
+    char clave[16];
+
+    /* Primero busca cuantos borrados hacen falta para que achique */
+    hash_t* hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, (void*) (i + 1));
+    }
+    size_t lleno = largo_vector(hash), umbral = 0;
+    while (umbral < largo && largo_vector(hash) == lleno) {
+        sprintf(clave, "%zu", umbral++);
+        hash_borrar(hash, clave);
+    }
+    hash_destruir(hash);
+
+    hash = hash_crear(NULL);
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_guardar(hash, clave, (void*) (i + 1));
+    }
+    for (size_t i = 0; i < largo && i + 1 < umbral; i++) {
+        sprintf(clave, "%zu", i);
+        hash_borrar(hash, clave);
+    }
+    sprintf(clave, "%zu", umbral - 1);
+    pedidos_hasta_falla = 0;
+    void* borrado = hash_borrar(hash, clave);
+    pedidos_hasta_falla = (size_t) -1;
+    print_test("Prueba hash borrar sin memoria para achicar devuelve el dato",
+               umbral < largo && borrado == (void*) umbral);
+    print_test("Prueba hash borrar sin memoria para achicar saca la clave",
+               !hash_pertenece(hash, clave) && hash_cantidad(hash) == largo - umbral);
+    print_test("Prueba hash borrar sin memoria para achicar deja el vector", largo_vector(hash) == lleno);
+
+    bool ok = hash_compactar(hash) && largo_vector(hash) < lleno;
+    for (size_t i = umbral; i < largo && ok; i++) {
+        sprintf(clave, "%zu", i);
+        ok = hash_obtener(hash, clave) == (void*) (i + 1);
+    }
+    print_test("Prueba hash borrar sin memoria, compactar despues conserva las claves", ok);
+    hash_destruir(hash);
+#endif
+}
+
+#define CLAVES_POR_HILO 20000
+#define CLAVES_COMPARTIDAS 100
+#define SUMAS_POR_HILO 50
+
+typedef struct hilo_concurrente {
+    hash_concurrente_t* hash;
+    size_t numero;
+    bool ok;
+} hilo_concurrente_t;
+
+static void* incrementar(void* dato, void* extra)
+{
+    (void) extra;
+    return (void*) ((size_t) dato + 1);
+}
+
+/* Cada hilo guarda sus propias claves, suma uno a las compartidas y borra la
+ * mitad de las suyas; mientras tanto los demas hacen lo mismo y el hash
+ * crece varias veces.
+ */
+static void* trabajar_concurrente(void* extra)
+{
+    hilo_concurrente_t* hilo = extra;
+    char clave[32];
+    bool ok = true;
+
+    for (size_t i = 0; i < CLAVES_POR_HILO; i++) {
+        sprintf(clave, "%zu-%zu", hilo->numero, i);
+        ok &= hash_concurrente_guardar(hilo->hash, clave, (void*) (i + 1));
+        if (i % CLAVES_COMPARTIDAS == 0) {
+            for (size_t j = 0; j < CLAVES_COMPARTIDAS; j++) {
+                sprintf(clave, "compartida %zu", j);
+                ok &= hash_concurrente_actualizar(hilo->hash, clave, incrementar, NULL);
+            }
+        }
+    }
+    for (size_t i = 0; i < CLAVES_POR_HILO; i++) {
+        sprintf(clave, "%zu-%zu", hilo->numero, i);
+        ok &= hash_concurrente_obtener(hilo->hash, clave) == (void*) (i + 1);
+        if (i % 2 == 0) ok &= hash_concurrente_borrar(hilo->hash, clave) == (void*) (i + 1);
+    }
+    hilo->ok = ok;
+    return NULL;
+}
+
+static void prueba_hash_concurrente()
+{
+    /* Las operaciones de un solo hilo son las de hash.h */
+    hash_concurrente_t* hash = hash_concurrente_crear(contar_destruido);
+    datos_destruidos = 0;
+    print_test("Prueba hash concurrente crear", hash && hash_concurrente_cantidad(hash) == 0);
+    print_test("Prueba hash concurrente guardar", hash_concurrente_guardar(hash, "a", NULL));
+    print_test("Prueba hash concurrente reemplazar destruye el dato", hash_concurrente_guardar(hash, "a", "x") && datos_destruidos == 1);
+    print_test("Prueba hash concurrente obtener", strcmp(hash_concurrente_obtener(hash, "a"), "x") == 0);
+    print_test("Prueba hash concurrente pertenece", hash_concurrente_pertenece(hash, "a") && !hash_concurrente_pertenece(hash, "b"));
+    print_test("Prueba hash concurrente la cantidad es correcta", hash_concurrente_cantidad(hash) == 1);
+    print_test("Prueba hash concurrente borrar", strcmp(hash_concurrente_borrar(hash, "a"), "x") == 0 && !hash_concurrente_borrar(hash, "a"));
+    print_test("Prueba hash concurrente borrar no destruye el dato", datos_destruidos == 1 && hash_concurrente_cantidad(hash) == 0);
+    print_test("Prueba hash concurrente guardar_n con \\0 en el medio", hash_concurrente_guardar_n(hash, "a\0b", 3, "y"));
+    print_test("Prueba hash concurrente obtener_n distingue el largo",
+               strcmp(hash_concurrente_obtener_n(hash, "a\0b", 3), "y") == 0 && !hash_concurrente_pertenece_n(hash, "a", 1));
+    print_test("Prueba hash concurrente borrar_n", strcmp(hash_concurrente_borrar_n(hash, "a\0b", 3), "y") == 0 && hash_concurrente_cantidad(hash) == 0);
+    hash_concurrente_guardar(hash, "b", NULL);
+    hash_concurrente_destruir(hash);
+    print_test("Prueba hash concurrente destruir destruye los datos", datos_destruidos == 2);
+
+#ifdef CONTADOR_MEMORIA
+    /* Sin memoria para anotar el nodo hasta liberarlo, borrar deja la clave */
+    hash = hash_concurrente_crear_con_franjas(NULL, 1);
+    hash_concurrente_guardar(hash, "c", "w");
+    pedidos_hasta_falla = 0;
+    void* borrado = hash_concurrente_borrar(hash, "c");
+    pedidos_hasta_falla = (size_t) -1;
+    print_test("Prueba hash concurrente borrar sin memoria deja la clave",
+               !borrado && strcmp(hash_concurrente_obtener(hash, "c"), "w") == 0);
+    print_test("Prueba hash concurrente borrar con memoria", strcmp(hash_concurrente_borrar(hash, "c"), "w") == 0);
+    hash_concurrente_destruir(hash);
+#endif
+
+    /* La direccion de obtener_o_insertar sigue valiendo aunque el hash crezca */
+    hash = hash_concurrente_crear(NULL);
+    void** dato;
+    bool insertado;
+    print_test("Prueba hash concurrente obtener_o_insertar inserta",
+               hash_concurrente_obtener_o_insertar(hash, "primera", &dato, &insertado) && insertado && !*dato);
+    char numero[32];
+    for (size_t i = 0; i < 10000; i++) {
+        sprintf(numero, "%zu", i);
+        hash_concurrente_guardar(hash, numero, (void*) (i + 1));
+    }
+    *dato = "z";
+    void** otro;
+    print_test("Prueba hash concurrente obtener_o_insertar despues de crecer",
+               hash_concurrente_obtener_o_insertar(hash, "primera", &otro, &insertado) && !insertado && otro == dato
+               && strcmp(hash_concurrente_obtener(hash, "primera"), "z") == 0);
+
+    size_t recorridas = 0;
+    bool bien = true;
+    hash_concurrente_iter_t* iter = hash_concurrente_iter_crear(hash);
+    for (; !hash_concurrente_iter_al_final(iter); hash_concurrente_iter_avanzar(iter)) {
+        const char* actual = hash_concurrente_iter_ver_actual(iter);
+        bien &= strlen(actual) == hash_concurrente_iter_ver_largo(iter);
+        bien &= strcmp(actual, "primera") == 0 || hash_concurrente_iter_ver_dato(iter) == (void*) (size_t) (atoi(actual) + 1);
+        recorridas++;
+    }
+    print_test("Prueba hash concurrente iterador ve cada clave con su dato", bien && recorridas == 10001);
+    print_test("Prueba hash concurrente iterador al final", !hash_concurrente_iter_avanzar(iter) && !hash_concurrente_iter_ver_actual(iter));
+    hash_concurrente_iter_destruir(iter);
+    print_test("Prueba hash concurrente el iterador suelta las franjas", hash_concurrente_guardar(hash, "otra", NULL));
+    hash_concurrente_destruir(hash);
+
+    /* Varios hilos a la vez, con pocas franjas para que compitan */
+    hash = hash_concurrente_crear_con_franjas(NULL, 4);
+    hilo_concurrente_t hilos[HILOS];
+    pthread_t ids[HILOS];
+    for (size_t i = 0; i < HILOS; i++) {
+        hilos[i] = (hilo_concurrente_t) { hash, i, false };
+        pthread_create(&ids[i], NULL, trabajar_concurrente, &hilos[i]);
+    }
+    bool ok = true;
+    for (size_t i = 0; i < HILOS; i++) {
+        pthread_join(ids[i], NULL);
+        ok &= hilos[i].ok;
+    }
+    print_test("Prueba hash concurrente cada hilo ve sus claves", ok);
+
+    char clave[32];
+    for (size_t j = 0; j < CLAVES_COMPARTIDAS && ok; j++) {
+        sprintf(clave, "compartida %zu", j);
+        ok = hash_concurrente_obtener(hash, clave) == (void*) (HILOS * (CLAVES_POR_HILO / CLAVES_COMPARTIDAS));
+    }
+    print_test("Prueba hash concurrente actualizar no pierde sumas", ok);
+    for (size_t i = 0; i < HILOS * CLAVES_POR_HILO && ok; i++) {
+        sprintf(clave, "%zu-%zu", i / CLAVES_POR_HILO, i % CLAVES_POR_HILO);
+        ok = hash_concurrente_pertenece(hash, clave) == (i % 2 == 1);
+    }
+    print_test("Prueba hash concurrente quedan las claves no borradas", ok);
+    print_test("Prueba hash concurrente la cantidad es correcta",
+               hash_concurrente_cantidad(hash) == HILOS * CLAVES_POR_HILO / 2 + CLAVES_COMPARTIDAS);
+
+    size_t visitadas = 0;
+    hash_concurrente_iterar(hash, contar_visitada, &visitadas);
+    print_test("Prueba hash concurrente iterar visita todas las claves", visitadas == hash_concurrente_cantidad(hash));
+    hash_concurrente_destruir(hash);
+}
+
+#define CLAVES_FIJAS 2000
+#define CLAVES_MOVILES 20000
+#define VUELTAS_ESCRITURA 3
+
+typedef struct lectura_concurrente {
+    hash_concurrente_t* hash;
+    bool* terminar;
+    size_t lecturas;
+    bool ok;
+} lectura_concurrente_t;
+
+/* Lee sin parar mientras los escritores trabajan: las claves fijas siempre
+ * estan con su dato, las moviles pueden estar o no, pero si estan tienen el
+ * suyo.
+ */
+static void* leer_concurrente(void* extra)
+{
+    lectura_concurrente_t* lectura = extra;
+    char clave[32];
+    bool ok = true;
+
+    for (size_t i = 0; !__atomic_load_n(lectura->terminar, __ATOMIC_ACQUIRE); i++) {
+        size_t fija = i % CLAVES_FIJAS, movil = i % CLAVES_MOVILES;
+        sprintf(clave, "fija %zu", fija);
+        ok &= hash_concurrente_obtener(lectura->hash, clave) == (void*) (fija + 1);
+        sprintf(clave, "movil %zu", movil);
+        void* dato = hash_concurrente_obtener(lectura->hash, clave);
+        ok &= !dato || dato == (void*) (movil + 1);
+        lectura->lecturas++;
+    }
+    lectura->ok = ok;
+    return NULL;
+}
+
+/* Guarda y borra todas las claves moviles varias veces, haciendo crecer y
+ * achicar el hash, y reemplaza las fijas por el mismo dato.
+ */
+static void* escribir_concurrente(void* extra)
+{
+    hash_concurrente_t* hash = extra;
+    char clave[32];
+
+    for (size_t vuelta = 0; vuelta < VUELTAS_ESCRITURA; vuelta++) {
+        for (size_t i = 0; i < CLAVES_MOVILES; i++) {
+            sprintf(clave, "movil %zu", i);
+            hash_concurrente_guardar(hash, clave, (void*) (i + 1));
+            sprintf(clave, "fija %zu", i % CLAVES_FIJAS);
+            hash_concurrente_guardar(hash, clave, (void*) (i % CLAVES_FIJAS + 1));
+        }
+        for (size_t i = 0; i < CLAVES_MOVILES; i++) {
+            sprintf(clave, "movil %zu", i);
+            hash_concurrente_borrar(hash, clave);
+        }
+    }
+    return NULL;
+}
+
+static void prueba_hash_concurrente_lecturas()
+{
+    hash_concurrente_t* hash = hash_concurrente_crear(NULL);
+    char clave[32];
+    for (size_t i = 0; i < CLAVES_FIJAS; i++) {
+        sprintf(clave, "fija %zu", i);
+        hash_concurrente_guardar(hash, clave, (void*) (i + 1));
+    }
+
+    bool terminar = false;
+    lectura_concurrente_t lecturas[HILOS];
+    pthread_t lectores[HILOS], escritor;
+    for (size_t i = 0; i < HILOS; i++) {
+        lecturas[i] = (lectura_concurrente_t) { hash, &terminar, 0, false };
+        pthread_create(&lectores[i], NULL, leer_concurrente, &lecturas[i]);
+    }
+    pthread_create(&escritor, NULL, escribir_concurrente, hash);
+    pthread_join(escritor, NULL);
+    __atomic_store_n(&terminar, true, __ATOMIC_RELEASE);
+
+    bool ok = true;
+    size_t total = 0;
+    for (size_t i = 0; i < HILOS; i++) {
+        pthread_join(lectores[i], NULL);
+        ok &= lecturas[i].ok;
+        total += lecturas[i].lecturas;
+    }
+    print_test("Prueba hash concurrente lecturas sin bloqueo mientras se escribe y redimensiona", ok && total > 0);
+    print_test("Prueba hash concurrente despues de escribir quedan las fijas", hash_concurrente_cantidad(hash) == CLAVES_FIJAS);
+    hash_concurrente_destruir(hash);
+}
+
+typedef struct hilo_particionado {
+    hash_particionado_t* hash;
+    size_t numero;
+    bool ok;
+} hilo_particionado_t;
+
+/* Como trabajar_concurrente, con el hash particionado */
+static void* trabajar_particionado(void* extra)
+{
+    hilo_particionado_t* hilo = extra;
+    char clave[32];
+    bool ok = true;
+
+    for (size_t i = 0; i < CLAVES_POR_HILO; i++) {
+        sprintf(clave, "%zu-%zu", hilo->numero, i);
+        ok &= hash_particionado_guardar(hilo->hash, clave, (void*) (i + 1));
+        sprintf(clave, "compartida %zu", i % CLAVES_COMPARTIDAS);
+        ok &= hash_particionado_actualizar(hilo->hash, clave, incrementar, NULL);
+    }
+    for (size_t i = 0; i < CLAVES_POR_HILO; i++) {
+        sprintf(clave, "%zu-%zu", hilo->numero, i);
+        ok &= hash_particionado_obtener(hilo->hash, clave) == (void*) (i + 1);
+        if (i % 2 == 0) ok &= hash_particionado_borrar(hilo->hash, clave) == (void*) (i + 1);
+    }
+    hilo->ok = ok;
+    return NULL;
+}
+
+static void prueba_hash_particionado()
+{
+    /* Las operaciones de un solo hilo son las de hash.h */
+    hash_particionado_t* hash = hash_particionado_crear(contar_destruido, 0);
+    datos_destruidos = 0;
+    print_test("Prueba hash particionado crear", hash && hash_particionado_cantidad(hash) == 0);
+    print_test("Prueba hash particionado guardar", hash_particionado_guardar(hash, "a", NULL));
+    print_test("Prueba hash particionado reemplazar destruye el dato", hash_particionado_guardar(hash, "a", "x") && datos_destruidos == 1);
+    print_test("Prueba hash particionado obtener", strcmp(hash_particionado_obtener(hash, "a"), "x") == 0);
+    print_test("Prueba hash particionado guardar con largo", hash_particionado_guardar_n(hash, "a\0b", 3, "y"));
+    print_test("Prueba hash particionado las claves con largo son distintas",
+               strcmp(hash_particionado_obtener_n(hash, "a\0b", 3), "y") == 0 && hash_particionado_pertenece(hash, "a"));
+    print_test("Prueba hash particionado la cantidad es correcta", hash_particionado_cantidad(hash) == 2);
+    print_test("Prueba hash particionado borrar", strcmp(hash_particionado_borrar(hash, "a"), "x") == 0);
+    print_test("Prueba hash particionado borrar con largo", strcmp(hash_particionado_borrar_n(hash, "a\0b", 3), "y") == 0);
+    print_test("Prueba hash particionado borrado no pertenece", !hash_particionado_pertenece_n(hash, "a\0b", 3));
+    hash_particionado_guardar(hash, "b", NULL);
+    hash_particionado_destruir(hash);
+    print_test("Prueba hash particionado destruir destruye los datos", datos_destruidos == 2);
+
+    /* El iterador recorre todas las particiones, cada clave una vez */
+    const size_t largo = 5000;
+    hash_opciones_t opciones;
+    hash_opciones_por_defecto(&opciones);
+    opciones.tipo = HASH_CERRADO_GRUPOS;
+    hash = hash_particionado_crear_con_opciones(NULL, &opciones, 8);
+    print_test("Prueba hash particionado reservar", hash_particionado_reservar(hash, largo));
+    char clave[32];
+    for (size_t i = 0; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_particionado_guardar(hash, clave, (void*) (i + 1));
+    }
+    bool* vistas = calloc(largo, sizeof(bool));
+    size_t recorridas = 0;
+    bool ok = true;
+    hash_particionado_iter_t* iter = hash_particionado_iter_crear(hash);
+    for (; !hash_particionado_iter_al_final(iter) && ok; hash_particionado_iter_avanzar(iter)) {
+        size_t i = (size_t) hash_particionado_obtener(hash, hash_particionado_iter_ver_actual(iter)) - 1;
+        ok = i < largo && !vistas[i] && hash_particionado_iter_ver_largo(iter) == strlen(hash_particionado_iter_ver_actual(iter))
+             && hash_particionado_iter_ver_dato(iter) == (void*) (i + 1);
+        vistas[i] = true;
+        recorridas++;
+    }
+    ok &= !hash_particionado_iter_avanzar(iter) && !hash_particionado_iter_ver_actual(iter);
+    hash_particionado_iter_destruir(iter);
+    print_test("Prueba hash particionado iterador visita todas las claves una vez", ok && recorridas == largo);
+
+    memset(vistas, 0, largo * sizeof(bool));
+    visitas_t visitas = { vistas, 0, 0, (size_t) -1 };
+    hash_particionado_iterar(hash, visitar, &visitas);
+    print_test("Prueba hash particionado iterar visita todas las claves", visitas.cantidad == largo && visitas.repetidas == 0);
+    memset(vistas, 0, largo * sizeof(bool));
+    visitas = (visitas_t) { vistas, 0, 0, 10 };
+    hash_particionado_iterar(hash, visitar, &visitas);
+    print_test("Prueba hash particionado iterar corta entre particiones", visitas.cantidad == 10);
+    free(vistas);
+
+    size_t* veces = calloc(largo, sizeof(size_t));
+    visitas_paralelas_t paralelas = { veces, 0, false };
+    hash_particionado_iterar_paralelo(hash, visitar_en_paralelo, &paralelas, HILOS);
+    print_test("Prueba hash particionado iterar en paralelo visita cada clave una vez",
+               paralelas.cantidad == largo && visitadas_una_vez(veces, largo));
+    free(veces);
+
+    /* Los lotes toman cada particion una vez */
+    const char* buscadas[] = { "1", "no esta", NULL, "4999" };
+    void* datos[4];
+    bool estan[4];
+    print_test("Prueba hash particionado obtener por lote",
+               hash_particionado_obtener_lote(hash, buscadas, 4, datos) == 2
+               && datos[0] == (void*) 2 && !datos[1] && !datos[2] && datos[3] == (void*) 5000);
+    print_test("Prueba hash particionado pertenece por lote",
+               hash_particionado_pertenece_lote(hash, buscadas, 4, estan) == 2 && estan[0] && !estan[1] && !estan[2] && estan[3]);
+
+    for (size_t i = 100; i < largo; i++) {
+        sprintf(clave, "%zu", i);
+        hash_particionado_borrar(hash, clave);
+    }
+    print_test("Prueba hash particionado compactar conserva las claves",
+               hash_particionado_compactar(hash) && hash_particionado_cantidad(hash) == 100 && hash_particionado_obtener(hash, "5") == (void*) 6);
+    hash_particionado_destruir(hash);
+
+    hash = hash_particionado_crear(NULL, 4);
+    const char* lote[] = { "a", "b", "a", "c" };
+    void* datos_lote[] = { (void*) 1, (void*) 2, (void*) 3, (void*) 4 };
+    print_test("Prueba hash particionado guardar por lote queda la ultima repetida",
+               hash_particionado_guardar_lote(hash, lote, datos_lote, 4) && hash_particionado_cantidad(hash) == 3
+               && hash_particionado_obtener(hash, "a") == (void*) 3 && hash_particionado_obtener(hash, "c") == (void*) 4);
+    const char* con_null[] = { "d", NULL };
+    print_test("Prueba hash particionado guardar por lote con una clave NULL",
+               !hash_particionado_guardar_lote(hash, con_null, NULL, 2) && hash_particionado_pertenece(hash, "d"));
+    void** lugar;
+    bool insertado;
+    print_test("Prueba hash particionado obtener_o_insertar inserta",
+               hash_particionado_obtener_o_insertar(hash, "e", &lugar, &insertado) && insertado && !*lugar);
+    *lugar = (void*) 9;
+    print_test("Prueba hash particionado obtener_o_insertar encuentra",
+               hash_particionado_obtener_o_insertar(hash, "e", &lugar, &insertado) && !insertado && hash_particionado_obtener(hash, "e") == (void*) 9);
+    hash_particionado_destruir(hash);
+
+    /* Varios hilos a la vez */
+    hash = hash_particionado_crear(NULL, 4);
+    hilo_particionado_t hilos[HILOS];
+    pthread_t ids[HILOS];
+    for (size_t i = 0; i < HILOS; i++) {
+        hilos[i] = (hilo_particionado_t) { hash, i, false };
+        pthread_create(&ids[i], NULL, trabajar_particionado, &hilos[i]);
+    }
+    ok = true;
+    for (size_t i = 0; i < HILOS; i++) {
+        pthread_join(ids[i], NULL);
+        ok &= hilos[i].ok;
+    }
+    print_test("Prueba hash particionado cada hilo ve sus claves", ok);
+    for (size_t j = 0; j < CLAVES_COMPARTIDAS && ok; j++) {
+        sprintf(clave, "compartida %zu", j);
+        ok = hash_particionado_obtener(hash, clave) == (void*) (HILOS * (CLAVES_POR_HILO / CLAVES_COMPARTIDAS));
+    }
+    print_test("Prueba hash particionado actualizar no pierde sumas", ok);
+    print_test("Prueba hash particionado la cantidad es correcta",
+               hash_particionado_cantidad(hash) == HILOS * CLAVES_POR_HILO / 2 + CLAVES_COMPARTIDAS);
+    hash_particionado_destruir(hash);
+}
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+void pruebas_hash_alumno()
+{
+    for (size_t i = 0; i < CANTIDAD_TIPOS; i++) {
+        printf("~~~ HASH %s ~~~\n", NOMBRES_TIPOS[i]);
+        prueba_hash_tipo_basico(TIPOS[i]);
+        prueba_hash_tipo_volumen(TIPOS[i], 20000);
+        prueba_hash_claves_largas(TIPOS[i]);
+        prueba_hash_claves_con_largo(TIPOS[i]);
+        prueba_hash_busquedas_sin_memoria(TIPOS[i]);
+        prueba_hash_allocator(TIPOS[i]);
+        prueba_hash_reservar(TIPOS[i]);
+        prueba_hash_lote(TIPOS[i]);
+        prueba_hash_guardar_lote(TIPOS[i]);
+        prueba_hash_hilos(TIPOS[i]);
+        prueba_hash_obtener_o_insertar(TIPOS[i]);
+        prueba_hash_recorrido(TIPOS[i]);
+    }
+    prueba_hash_grupos_instrucciones();
+    prueba_hash_redimension_sin_memoria();
+    prueba_hash_incremental();
+    prueba_hash_politicas_distribucion();
+    prueba_hash_funciones();
+    prueba_hash_inundacion();
+    prueba_hash_semillas();
+    prueba_hash_reservas();
+    prueba_hash_claves_cortas();
+    prueba_hash_chico();
+    prueba_hash_opciones();
+    prueba_hash_borrar_sin_memoria();
+    prueba_hash_concurrente();
+    prueba_hash_concurrente_lecturas();
+    prueba_hash_particionado();
+}
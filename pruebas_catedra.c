@@ -214,9 +214,49 @@ static void prueba_hash_valor_null()
     hash_destruir(hash);
 }
 
+/* Allocator que cuenta los pedidos y el pico de bytes en uso. Guarda el
+ * tamaño de cada pedido adelante del bloque que devuelve.
+ */
+typedef struct contador_memoria {
+    size_t pedidos;
+    size_t liberados;
+    size_t en_uso;
+    size_t pico;
+} contador_memoria_t;
+
+typedef union encabezado_memoria {
+    size_t tam;
+    long double alineacion_real;
+    void* alineacion_puntero;
+} encabezado_memoria_t;
+
+static void* contador_pedir(void* contexto, size_t tam)
+{
+    contador_memoria_t* contador = contexto;
+    encabezado_memoria_t* encabezado = malloc(sizeof(encabezado_memoria_t) + tam);
+    if (!encabezado) return NULL;
+
+    encabezado->tam = tam;
+    contador->pedidos++;
+    contador->en_uso += tam;
+    if (contador->en_uso > contador->pico) contador->pico = contador->en_uso;
+    return encabezado + 1;
+}
+
+static void contador_liberar(void* contexto, void* elemento)
+{
+    contador_memoria_t* contador = contexto;
+    encabezado_memoria_t* encabezado = (encabezado_memoria_t*) elemento - 1;
+    contador->liberados++;
+    contador->en_uso -= encabezado->tam;
+    free(encabezado);
+}
+
 static void prueba_hash_volumen(size_t largo, bool debug)
 {
-    hash_t* hash = hash_crear(NULL);
+    contador_memoria_t contador = { 0, 0, 0, 0 };
+    hash_allocator_t allocator = { contador_pedir, contador_liberar, &contador };
+    hash_t* hash = hash_crear_con_allocator(NULL, HASH_ABIERTO, &allocator);
 
     const size_t largo_clave = 10;
     char (*claves)[largo_clave] = malloc(largo * largo_clave);
@@ -237,6 +277,12 @@ static void prueba_hash_volumen(size_t largo, bool debug)
     if (debug) print_test("Prueba hash la cantidad de elementos es correcta", hash_cantidad(hash) == largo);
     if (debug) print_test("Prueba hash la cantidad de elementos es correcta", hash_cantidad(hash) == largo);
 
+    /* Informa cuanta memoria usa el hash por cada clave guardada */
+    hash_estadisticas_t estadisticas;
+    if (debug && hash_estadisticas(hash, &estadisticas))
+        printf("Memoria del hash: %zu bytes, %.1f por clave\n", estadisticas.memoria,
+               (double) estadisticas.memoria / (double) largo);
+
     /* Verifica que devuelva los valores correctos */
     for (size_t i = 0; i < largo; i++) {
         ok = hash_pertenece(hash, claves[i]);
@@ -259,6 +305,10 @@ static void prueba_hash_volumen(size_t largo, bool debug)
 
     /* Destruye el hash y crea uno nuevo que sí libera */
     hash_destruir(hash);
+
+    if (debug) printf("Allocator: %zu pedidos, pico de %zu bytes\n", contador.pedidos, contador.pico);
+    if (debug) print_test("Prueba hash allocator libera todo lo que pidio",
+                          contador.pedidos == contador.liberados && contador.en_uso == 0);
     hash = hash_crear(free);
 
     /* Inserta 'largo' parejas en el hash */
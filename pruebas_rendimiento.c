@@ -0,0 +1,756 @@
+/*
+ * pruebas_rendimiento.c
+ * Mediciones de tiempo de la Tabla de Hash. No son pruebas de correctitud:
+ * solo imprimen los tiempos para comparar implementaciones.
+ * Se ejecutan con: ./tp1 rendimiento
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include "hash.h"
+#include "hash_concurrente.h"
+#include "hash_particionado.h"
+#include "hash_rapido.h"
+
+#include <pthread.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+
+/* ******************************************************************
+ *                        FUNCIONES AUXILIARES
+ * *****************************************************************/
+
+/* Devuelve el tiempo actual en segundos */
+static double ahora(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec + (double) ts.tv_nsec / 1e9;
+}
+
+/* Crea 'largo' claves de la forma "%08zu" en un solo bloque */
+static char (*crear_claves(size_t largo))[10]
+{
+    char (*claves)[10] = malloc(largo * sizeof(*claves));
+    if (!claves) return NULL;
+    for (size_t i = 0; i < largo; i++)
+        sprintf(claves[i], "%08zu", i % 100000000);
+    return claves;
+}
+
+
+/* ******************************************************************
+ *                             MEDICIONES
+ * *****************************************************************/
+
+/* Inserta 'largo' claves midiendo cada insercion. Las inserciones que tardan
+ * mucho mas que el resto son las que redimensionan el hash. Con reservar el
+ * hash se crea con lugar para todas.
+ */
+static void rendimiento_redimension(hash_tipo_t tipo, const char* nombre, size_t largo, bool reservar)
+{
+    const double umbral = 1e-4;     // 100 us: ninguna insercion comun tarda tanto
+    char (*claves)[10] = crear_claves(largo);
+    hash_t* hash = hash_crear_con_capacidad(NULL, tipo, reservar ? largo : 0);
+    if (!claves || !hash) {
+        free(claves);
+        hash_destruir(hash);
+        return;
+    }
+
+    double total = 0, peor = 0, en_redimensiones = 0;
+    size_t redimensiones = 0;
+
+    for (size_t i = 0; i < largo; i++) {
+        double inicio = ahora();
+        hash_guardar(hash, claves[i], NULL);
+        double tiempo = ahora() - inicio;
+
+        total += tiempo;
+        if (tiempo > peor) peor = tiempo;
+        if (tiempo > umbral) {
+            en_redimensiones += tiempo;
+            redimensiones++;
+        }
+    }
+
+    printf("Redimension %-20s %-9s %9zu claves: total %8.3f s, peor insercion %8.3f ms, "
+           "%zu inserciones lentas suman %8.3f ms\n",
+           nombre, reservar ? "reservado" : "", largo, total, peor * 1e3, redimensiones, en_redimensiones * 1e3);
+
+    hash_destruir(hash);
+    free(claves);
+}
+
+
+/* Histograma de la latencia de cada insercion, en rangos de potencias de 2
+ * microsegundos. Compara la redimension de una vez con la incremental.
+ */
+static void rendimiento_latencia(bool incremental, size_t largo)
+{
+    enum { RANGOS = 24 };           // El ultimo rango junta todo lo que pasa de 4 s
+    size_t histograma[RANGOS] = { 0 };
+    char (*claves)[10] = crear_claves(largo);
+    hash_t* hash = hash_crear(NULL);
+    if (!claves || !hash) {
+        free(claves);
+        hash_destruir(hash);
+        return;
+    }
+    hash_redimension_incremental(hash, incremental);
+
+    double peor = 0;
+    for (size_t i = 0; i < largo; i++) {
+        double inicio = ahora();
+        hash_guardar(hash, claves[i], NULL);
+        double tiempo = ahora() - inicio;
+
+        if (tiempo > peor) peor = tiempo;
+        size_t rango = 0;
+        for (double limite = 1e-6; tiempo >= limite && rango < RANGOS - 1; limite *= 2)
+            rango++;
+        histograma[rango]++;
+    }
+
+    printf("Latencia redimension %-11s %9zu claves, peor insercion %8.3f ms\n",
+           incremental ? "incremental" : "de una vez", largo, peor * 1e3);
+    for (size_t rango = 0; rango < RANGOS; rango++) {
+        if (!histograma[rango]) continue;
+        printf("    < %10.0f us: %9zu\n", (double) (1u << rango), histograma[rango]);
+    }
+
+    hash_destruir(hash);
+    free(claves);
+}
+
+
+/* Busca varias veces 'largo' claves con cada politica de largos del vector */
+static void rendimiento_politicas(size_t largo)
+{
+    const hash_largo_t politicas[] = { HASH_LARGO_MODULO, HASH_LARGO_POTENCIA_DE_2, HASH_LARGO_MULTIPLICATIVO };
+    const char* nombres[] = { "modulo", "potencia de 2", "multiplicativo" };
+    const size_t vueltas = 5;
+    char (*claves)[10] = crear_claves(largo);
+    if (!claves) return;
+
+    for (size_t p = 0; p < 3; p++) {
+        hash_t* hash = hash_crear(NULL);
+        if (!hash || !hash_politica_largo(hash, politicas[p])) {
+            hash_destruir(hash);
+            continue;
+        }
+        for (size_t i = 0; i < largo; i++)
+            hash_guardar(hash, claves[i], claves[i]);
+
+        hash_estadisticas_t estadisticas;
+        hash_estadisticas(hash, &estadisticas);
+
+        size_t encontradas = 0;
+        double inicio = ahora();
+        for (size_t v = 0; v < vueltas; v++)
+            for (size_t i = 0; i < largo; i++)
+                encontradas += hash_obtener(hash, claves[i]) != NULL;
+        double tiempo = ahora() - inicio;
+
+        printf("Politica %-15s %9zu claves: %6.1f ns por busqueda (%zu encontradas), "
+               "largo %zu, ocupadas %zu, lista mas larga %zu\n",
+               nombres[p], largo, tiempo * 1e9 / (double) (vueltas * largo), encontradas,
+               estadisticas.largo, estadisticas.ocupadas, estadisticas.lista_mas_larga);
+        hash_destruir(hash);
+    }
+    free(claves);
+}
+
+
+static volatile uint64_t sumidero;             // Evita que se descarten los hashes
+
+/* Mide cuantos bytes por segundo hashea cada funcion segun el largo de clave */
+static void rendimiento_funciones_hash(void)
+{
+    const size_t total = 64 << 20;             // Bytes hasheados por medicion
+    const size_t maximo = 16384;
+    unsigned char* bytes = malloc(maximo);
+    if (!bytes) return;
+    for (size_t i = 0; i < maximo; i++) bytes[i] = (unsigned char) (i * 131);
+
+    const char* nombres[] = { "lookup3", "rapida escalar", "rapida sse2", "rapida avx2" };
+    const grupo_instrucciones_t instrucciones[] = { GRUPO_ESCALAR, GRUPO_ESCALAR, GRUPO_SSE2, GRUPO_AVX2 };
+
+    printf("Funciones de hash, GB/s por largo de clave:\n%-16s", "");
+    for (size_t largo = 4; largo <= maximo; largo *= 4) printf("%9zu", largo);
+    printf("\n");
+
+    for (size_t f = 0; f < 4; f++) {
+        if (f > 0 && hash_rapido_elegir_instrucciones(instrucciones[f]) != instrucciones[f])
+            continue;
+        printf("%-16s", nombres[f]);
+        for (size_t largo = 4; largo <= maximo; largo *= 4) {
+            size_t vueltas = total / largo;
+            uint64_t acumulado = 0;
+            double inicio = ahora();
+            for (size_t v = 0; v < vueltas; v++) {
+                // Cambia un byte por vuelta para que no se pueda sacar del ciclo.
+                bytes[0] = (unsigned char) v;
+                acumulado += f == 0 ? hash_funcion_lookup3(bytes, largo, acumulado)
+                                    : hash_funcion_rapida(bytes, largo, acumulado);
+            }
+            double tiempo = ahora() - inicio;
+            sumidero = acumulado;
+            printf("%9.2f", (double) (vueltas * largo) / tiempo / 1e9);
+        }
+        printf("\n");
+    }
+    hash_rapido_elegir_instrucciones(GRUPO_AUTOMATICO);
+    free(bytes);
+}
+
+/* Ciclo de vida completo del hash abierto: guardar, borrar la mitad, volver a
+ * guardarla y destruir. Es el caso en que mas pesa pedir y liberar memoria.
+ */
+static void rendimiento_memoria(size_t largo)
+{
+    char (*claves)[10] = crear_claves(largo);
+    if (!claves) return;
+
+    hash_t* hash = hash_crear(NULL);
+    double inicio = ahora();
+    for (size_t i = 0; i < largo; i++)
+        hash_guardar(hash, claves[i], claves[i]);
+    double guardar = ahora();
+    for (size_t i = 0; i < largo; i += 2)
+        hash_borrar(hash, claves[i]);
+    for (size_t i = 0; i < largo; i += 2)
+        hash_guardar(hash, claves[i], claves[i]);
+    double reguardar = ahora();
+    hash_destruir(hash);
+    double destruir = ahora();
+
+    printf("Memoria abierto %9zu claves: guardar %.3f s, borrar y reguardar la mitad %.3f s, destruir %.3f s\n",
+           largo, guardar - inicio, reguardar - guardar, destruir - reguardar);
+    free(claves);
+}
+
+/* Crea y destruye muchos hashes vacios y con pocas claves */
+static void rendimiento_chicos(size_t vueltas)
+{
+    const char* claves[] = { "uno", "dos", "tres", "cuatro" };
+
+    for (size_t cantidad = 0; cantidad <= 4; cantidad += 4) {
+        size_t encontradas = 0;
+        double inicio = ahora();
+        for (size_t v = 0; v < vueltas; v++) {
+            hash_t* hash = hash_crear(NULL);
+            for (size_t i = 0; i < cantidad; i++)
+                hash_guardar(hash, claves[i], NULL);
+            for (size_t i = 0; i < cantidad; i++)
+                encontradas += hash_pertenece(hash, claves[i]);
+            hash_destruir(hash);
+        }
+        double tiempo = ahora() - inicio;
+        printf("Hash chico con %zu claves: %6.1f ns por crear, usar y destruir (%zu encontradas)\n",
+               cantidad, tiempo * 1e9 / (double) vueltas, encontradas);
+    }
+}
+
+/* Vaiven alrededor de los umbrales: con 'base' claves fijas agrega y borra
+ * 'ola' claves una y otra vez. Cuenta cuantas veces cambia el largo del
+ * vector (no mide tiempos: hash_estadisticas recorre el vector). Con
+ * histeresis solo deberia cambiar en las primeras olas.
+ */
+static void rendimiento_vaiven(size_t base, size_t ola, size_t vueltas)
+{
+    char (*claves)[10] = crear_claves(base + ola);
+    if (!claves) return;
+
+    hash_t* hash = hash_crear(NULL);
+    for (size_t i = 0; i < base; i++)
+        hash_guardar(hash, claves[i], NULL);
+
+    hash_estadisticas_t estadisticas;
+    hash_estadisticas(hash, &estadisticas);
+    size_t largo = estadisticas.largo, cambios = 0;
+    for (size_t v = 0; v < vueltas; v++) {
+        for (size_t i = base; i < base + ola; i++) {
+            hash_guardar(hash, claves[i], NULL);
+            hash_estadisticas(hash, &estadisticas);
+            cambios += estadisticas.largo != largo;
+            largo = estadisticas.largo;
+        }
+        for (size_t i = base; i < base + ola; i++) {
+            hash_borrar(hash, claves[i]);
+            hash_estadisticas(hash, &estadisticas);
+            cambios += estadisticas.largo != largo;
+            largo = estadisticas.largo;
+        }
+    }
+    hash_destruir(hash);
+
+    printf("Vaiven abierto %zu claves +-%zu: %zu cambios de largo en %zu vueltas\n",
+           base, ola, cambios, vueltas);
+    free(claves);
+}
+
+/* Busca 'largo' claves en orden al azar, de a una con hash_obtener y de a
+ * lotes con hash_obtener_lote. Con un hash mas grande que la cache cada
+ * busqueda espera a la memoria; los lotes superponen esas esperas.
+ */
+static void rendimiento_lote(hash_tipo_t tipo, const char* nombre, size_t largo)
+{
+    char (*claves)[10] = crear_claves(largo);
+    const char** orden = malloc(largo * sizeof(char*));
+    void** datos = malloc(largo * sizeof(void*));
+    hash_t* hash = hash_crear_con_capacidad(NULL, tipo, largo);
+    if (!claves || !orden || !datos || !hash) {
+        hash_destruir(hash);
+        free(datos);
+        free(orden);
+        free(claves);
+        return;
+    }
+
+    for (size_t i = 0; i < largo; i++) {
+        hash_guardar(hash, claves[i], claves[i]);
+        orden[i] = claves[i];
+    }
+    srand(1);
+    for (size_t i = largo - 1; i > 0; i--) {
+        size_t j = ((size_t) rand() * ((size_t) RAND_MAX + 1) + (size_t) rand()) % (i + 1);
+        const char* aux = orden[i];
+        orden[i] = orden[j];
+        orden[j] = aux;
+    }
+
+    size_t encontradas = 0;
+    double inicio = ahora();
+    for (size_t i = 0; i < largo; i++)
+        encontradas += hash_obtener(hash, orden[i]) != NULL;
+    double de_a_una = ahora() - inicio;
+
+    inicio = ahora();
+    encontradas += hash_obtener_lote(hash, orden, largo, datos);
+    double por_lote = ahora() - inicio;
+
+    printf("Busqueda %-18s %9zu claves: de a una %6.1f ns, por lote %6.1f ns por clave (%zu encontradas)\n",
+           nombre, largo, de_a_una * 1e9 / (double) largo, por_lote * 1e9 / (double) largo, encontradas);
+    hash_destruir(hash);
+    free(datos);
+    free(orden);
+    free(claves);
+}
+
+/* Carga 'largo' claves de tres formas: de a una con hash_guardar, de a una
+ * con el hash reservado de antemano y con hash_crear_con_lote.
+ */
+static void rendimiento_carga(hash_tipo_t tipo, const char* nombre, size_t largo)
+{
+    char (*claves)[10] = crear_claves(largo);
+    const char** punteros = malloc(largo * sizeof(char*));
+    if (!claves || !punteros) {
+        free(punteros);
+        free(claves);
+        return;
+    }
+    for (size_t i = 0; i < largo; i++)
+        punteros[i] = claves[i];
+
+    double inicio = ahora();
+    hash_t* hash = hash_crear_tipo(NULL, tipo);
+    for (size_t i = 0; i < largo; i++)
+        hash_guardar(hash, punteros[i], NULL);
+    double de_a_una = ahora() - inicio;
+    hash_destruir(hash);
+
+    inicio = ahora();
+    hash = hash_crear_con_capacidad(NULL, tipo, largo);
+    for (size_t i = 0; i < largo; i++)
+        hash_guardar(hash, punteros[i], NULL);
+    double reservado = ahora() - inicio;
+    hash_destruir(hash);
+
+    hash_opciones_t opciones;
+    hash_opciones_por_defecto(&opciones);
+    opciones.tipo = tipo;
+    inicio = ahora();
+    hash = hash_crear_con_lote(NULL, &opciones, punteros, NULL, largo);
+    double por_lote = ahora() - inicio;
+
+    printf("Carga %-18s %9zu claves: de a una %.3f s, reservado %.3f s, por lote %.3f s (%zu guardadas)\n",
+           nombre, largo, de_a_una, reservado, por_lote, hash_cantidad(hash));
+    hash_destruir(hash);
+    free(punteros);
+    free(claves);
+}
+
+/* Carga 'largo' claves con hash_crear_con_lote, las vuelve a guardar con
+ * hash_guardar_lote (reemplazando los datos) y despues reserva el cuadruple
+ * (lo que reubica todas), con 1, 2, 4 y 8 hilos. La aceleracion de cada
+ * etapa es contra el tiempo con un solo hilo.
+ */
+static void rendimiento_hilos(hash_tipo_t tipo, const char* nombre, size_t largo)
+{
+    char (*claves)[10] = crear_claves(largo);
+    const char** punteros = malloc(largo * sizeof(char*));
+    void** datos = malloc(largo * sizeof(void*));
+    if (!claves || !punteros || !datos) {
+        free(datos);
+        free(punteros);
+        free(claves);
+        return;
+    }
+    for (size_t i = 0; i < largo; i++) {
+        punteros[i] = claves[i];
+        datos[i] = (void*) (i + 1);
+    }
+
+    double base[3] = { 0, 0, 0 };
+    for (size_t hilos = 1; hilos <= 8; hilos *= 2) {
+        hash_opciones_t opciones;
+        hash_opciones_por_defecto(&opciones);
+        opciones.tipo = tipo;
+        opciones.hilos = hilos;
+        double tiempos[3];
+        double inicio = ahora();
+        hash_t* hash = hash_crear_con_lote(NULL, &opciones, punteros, NULL, largo);
+        tiempos[0] = ahora() - inicio;
+        inicio = ahora();
+        hash_guardar_lote(hash, punteros, datos, largo);
+        tiempos[1] = ahora() - inicio;
+        inicio = ahora();
+        hash_reservar(hash, 4 * largo);
+        tiempos[2] = ahora() - inicio;
+        if (hilos == 1) {
+            for (int i = 0; i < 3; i++)
+                base[i] = tiempos[i];
+        }
+
+        printf("Hilos %-18s %9zu claves, %zu hilos: lote %.3f s (x%.2f), reemplazar %.3f s (x%.2f), "
+               "reservar el cuadruple %.3f s (x%.2f)\n",
+               nombre, largo, hilos, tiempos[0], base[0] / tiempos[0], tiempos[1], base[1] / tiempos[1],
+               tiempos[2], base[2] / tiempos[2]);
+        hash_destruir(hash);
+    }
+    free(datos);
+    free(punteros);
+    free(claves);
+}
+
+static void* incrementar(void* dato, void* extra)
+{
+    (void) extra;
+    return (void*) ((size_t) dato + 1);
+}
+
+/* Cuenta las apariciones de 'largo' claves tomadas de 'distintas' posibles:
+ * con hash_obtener y hash_guardar, con hash_obtener_o_insertar y con
+ * hash_actualizar.
+ */
+static void rendimiento_contar(hash_tipo_t tipo, const char* nombre, size_t largo, size_t distintas)
+{
+    char (*claves)[10] = crear_claves(distintas);
+    if (!claves) return;
+    double tiempos[3];
+    size_t total = 0;
+
+    for (int forma = 0; forma < 3; forma++) {
+        hash_t* hash = hash_crear_tipo(NULL, tipo);
+        srand(1);
+        double inicio = ahora();
+        for (size_t i = 0; i < largo; i++) {
+            const char* clave = claves[(size_t) rand() % distintas];
+            if (forma == 0) {
+                hash_guardar(hash, clave, (void*) ((size_t) hash_obtener(hash, clave) + 1));
+            } else if (forma == 1) {
+                void** dato;
+                hash_obtener_o_insertar(hash, clave, &dato, NULL);
+                *dato = (void*) ((size_t) *dato + 1);
+            } else {
+                hash_actualizar(hash, clave, incrementar, NULL);
+            }
+        }
+        tiempos[forma] = ahora() - inicio;
+        total += hash_cantidad(hash);
+        hash_destruir(hash);
+    }
+
+    printf("Contar %-18s %9zu claves (%zu distintas): obtener y guardar %.3f s, obtener o insertar %.3f s, actualizar %.3f s (%zu)\n",
+           nombre, largo, distintas, tiempos[0], tiempos[1], tiempos[2], total);
+    free(claves);
+}
+
+static bool sumar_largo(const char* clave, size_t largo, void* dato, void* extra)
+{
+    (void) clave;
+    (void) dato;
+    *(size_t*) extra += largo;
+    return true;
+}
+
+static bool sumar_largo_atomico(const char* clave, size_t largo, void* dato, void* extra)
+{
+    (void) clave;
+    (void) dato;
+    __atomic_fetch_add((size_t*) extra, largo, __ATOMIC_RELAXED);
+    return true;
+}
+
+/* Recorre un hash de 'largo' claves con el iterador, con un recorrido en el
+ * stack, con hash_iterar y con hash_iterar_paralelo de 4 hilos, sumando los
+ * largos de las claves.
+ */
+static void rendimiento_recorrer(hash_tipo_t tipo, const char* nombre, size_t largo)
+{
+    char (*claves)[10] = crear_claves(largo);
+    if (!claves) return;
+    hash_t* hash = hash_crear_con_capacidad(NULL, tipo, largo);
+    for (size_t i = 0; i < largo; i++)
+        hash_guardar(hash, claves[i], NULL);
+
+    size_t sumas[4] = { 0, 0, 0, 0 };
+    double inicio = ahora();
+    hash_iter_t* iter = hash_iter_crear(hash);
+    for (; !hash_iter_al_final(iter); hash_iter_avanzar(iter))
+        sumas[0] += strlen(hash_iter_ver_actual(iter));
+    hash_iter_destruir(iter);
+    double iterador = ahora() - inicio;
+
+    inicio = ahora();
+    hash_recorrido_t recorrido;
+    for (hash_recorrido_iniciar(&recorrido, hash); !hash_recorrido_al_final(&recorrido);
+         hash_recorrido_avanzar(&recorrido))
+        sumas[1] += hash_recorrido_ver_largo(&recorrido);
+    double en_stack = ahora() - inicio;
+
+    inicio = ahora();
+    hash_iterar(hash, sumar_largo, &sumas[2]);
+    double iterar = ahora() - inicio;
+
+    inicio = ahora();
+    hash_iterar_paralelo(hash, sumar_largo_atomico, &sumas[3], 4);
+    double paralelo = ahora() - inicio;
+
+    printf("Recorrer %-18s %9zu claves: iterador %.3f s, recorrido %.3f s, hash_iterar %.3f s, en paralelo %.3f s (%s)\n",
+           nombre, largo, iterador, en_stack, iterar, paralelo,
+           sumas[0] == sumas[1] && sumas[1] == sumas[2] && sumas[2] == sumas[3] ? "iguales" : "DISTINTOS");
+    hash_destruir(hash);
+    free(claves);
+}
+
+#define HILOS_MAXIMOS 16
+
+/* Trabajo de un hilo de rendimiento_concurrente. Con hash usa el hash
+ * concurrente; si no, el hash comun detras de un mutex global.
+ */
+typedef struct trabajo {
+    hash_concurrente_t* hash;
+    hash_t* comun;
+    pthread_mutex_t* global;
+    char (*claves)[10];
+    size_t largo;
+    size_t operaciones;
+    unsigned escrituras;            // Por ciento, mitad guardar y mitad borrar
+    uint64_t azar;
+} trabajo_t;
+
+/* Obtiene, guarda o borra claves al azar entre el doble de las cargadas */
+static void* trabajar(void* extra)
+{
+    trabajo_t* trabajo = extra;
+    uint64_t azar = trabajo->azar;
+    size_t encontradas = 0;
+
+    for (size_t i = 0; i < trabajo->operaciones; i++) {
+        azar ^= azar << 13;
+        azar ^= azar >> 7;
+        azar ^= azar << 17;
+        const char* clave = trabajo->claves[azar % (2 * trabajo->largo)];
+        unsigned operacion = (unsigned) (azar >> 54) % 100;
+        bool guardar = operacion < trabajo->escrituras / 2, borrar = !guardar && operacion < trabajo->escrituras;
+
+        if (trabajo->hash) {
+            if (guardar) hash_concurrente_guardar(trabajo->hash, clave, NULL);
+            else if (borrar) hash_concurrente_borrar(trabajo->hash, clave);
+            else encontradas += hash_concurrente_pertenece(trabajo->hash, clave);
+            continue;
+        }
+        pthread_mutex_lock(trabajo->global);
+        if (guardar) hash_guardar(trabajo->comun, clave, NULL);
+        else if (borrar) hash_borrar(trabajo->comun, clave);
+        else encontradas += hash_pertenece(trabajo->comun, clave);
+        pthread_mutex_unlock(trabajo->global);
+    }
+    __atomic_add_fetch(&sumidero, encontradas, __ATOMIC_RELAXED);
+    return NULL;
+}
+
+/* Reparte 'operaciones' entre 1, 2, 4... hilos sobre un hash con 'largo'
+ * claves, con el hash concurrente y con el comun detras de un mutex global,
+ * y muestra millones de operaciones por segundo en total y por hilo.
+ */
+static void rendimiento_concurrente(size_t largo, size_t operaciones, unsigned escrituras)
+{
+    char (*claves)[10] = crear_claves(2 * largo);
+    if (!claves) return;
+    long procesadores = sysconf(_SC_NPROCESSORS_ONLN);
+    printf("Concurrente %zu claves, %zu operaciones (%u%% obtener), %ld procesadores:\n",
+           largo, operaciones, 100 - escrituras, procesadores);
+
+    for (size_t hilos = 1; hilos <= HILOS_MAXIMOS; hilos *= 2) {
+        double tiempos[2];
+        for (int forma = 0; forma < 2; forma++) {
+            hash_concurrente_t* hash = forma == 0 ? hash_concurrente_crear(NULL) : NULL;
+            hash_t* comun = forma == 1 ? hash_crear(NULL) : NULL;
+            pthread_mutex_t global;
+            pthread_mutex_init(&global, NULL);
+            for (size_t i = 0; i < largo; i++) {
+                if (hash) hash_concurrente_guardar(hash, claves[i], NULL);
+                else hash_guardar(comun, claves[i], NULL);
+            }
+
+            trabajo_t trabajos[HILOS_MAXIMOS];
+            pthread_t ids[HILOS_MAXIMOS];
+            double inicio = ahora();
+            for (size_t i = 0; i < hilos; i++) {
+                trabajos[i] = (trabajo_t) { hash, comun, &global, claves, largo, operaciones / hilos, escrituras,
+                                          88172645463325252ull + i };
+                pthread_create(&ids[i], NULL, trabajar, &trabajos[i]);
+            }
+            for (size_t i = 0; i < hilos; i++)
+                pthread_join(ids[i], NULL);
+            tiempos[forma] = ahora() - inicio;
+
+            pthread_mutex_destroy(&global);
+            hash_concurrente_destruir(hash);
+            hash_destruir(comun);
+        }
+        double concurrente = (double) operaciones / tiempos[0] / 1e6, global = (double) operaciones / tiempos[1] / 1e6;
+        printf("  %2zu hilos: concurrente %.2f Mop/s (%.2f por hilo), mutex global %.2f Mop/s (%.2f por hilo)\n",
+               hilos, concurrente, concurrente / (double) hilos, global, global / (double) hilos);
+    }
+    free(claves);
+}
+
+/* Carga de un hilo de rendimiento_particionado */
+typedef struct carga {
+    hash_particionado_t* hash;
+    hash_t* comun;
+    pthread_mutex_t* global;
+    char (*claves)[10];
+    size_t desde, hasta;
+} carga_t;
+
+static void* cargar(void* extra)
+{
+    carga_t* carga = extra;
+    for (size_t i = carga->desde; i < carga->hasta; i++) {
+        if (carga->hash) {
+            hash_particionado_guardar(carga->hash, carga->claves[i], NULL);
+            continue;
+        }
+        pthread_mutex_lock(carga->global);
+        hash_guardar(carga->comun, carga->claves[i], NULL);
+        pthread_mutex_unlock(carga->global);
+    }
+    return NULL;
+}
+
+/* Carga 'largo' claves en un hash comun y en uno con 'particiones'
+ * particiones: de un solo hilo, midiendo la peor insercion (la que
+ * redimensiona), y repartidas entre 'hilos' hilos, comparando con el comun
+ * detras de un mutex global.
+ */
+static void rendimiento_particionado(size_t largo, size_t particiones, size_t hilos)
+{
+    char (*claves)[10] = crear_claves(largo);
+    if (!claves || hilos > HILOS_MAXIMOS) {
+        free(claves);
+        return;
+    }
+
+    double peores[2] = { 0, 0 }, totales[2];
+    for (int forma = 0; forma < 2; forma++) {
+        hash_t* comun = forma == 0 ? hash_crear(NULL) : NULL;
+        hash_particionado_t* hash = forma == 1 ? hash_particionado_crear(NULL, particiones) : NULL;
+        double inicio = ahora();
+        for (size_t i = 0; i < largo; i++) {
+            double antes = ahora();
+            if (hash) hash_particionado_guardar(hash, claves[i], NULL);
+            else hash_guardar(comun, claves[i], NULL);
+            double tiempo = ahora() - antes;
+            if (tiempo > peores[forma]) peores[forma] = tiempo;
+        }
+        totales[forma] = ahora() - inicio;
+        hash_particionado_destruir(hash);
+        hash_destruir(comun);
+    }
+    printf("Particionado %9zu claves, %zu particiones: peor insercion %.3f ms (comun %.3f ms), total %.3f s (comun %.3f s)\n",
+           largo, particiones, peores[1] * 1e3, peores[0] * 1e3, totales[1], totales[0]);
+
+    double tiempos[2];
+    for (int forma = 0; forma < 2; forma++) {
+        hash_t* comun = forma == 0 ? hash_crear(NULL) : NULL;
+        hash_particionado_t* hash = forma == 1 ? hash_particionado_crear(NULL, particiones) : NULL;
+        pthread_mutex_t global;
+        pthread_mutex_init(&global, NULL);
+        carga_t cargas[HILOS_MAXIMOS];
+        pthread_t ids[HILOS_MAXIMOS];
+        double inicio = ahora();
+        for (size_t i = 0; i < hilos; i++) {
+            cargas[i] = (carga_t) { hash, comun, &global, claves, largo * i / hilos, largo * (i + 1) / hilos };
+            pthread_create(&ids[i], NULL, cargar, &cargas[i]);
+        }
+        for (size_t i = 0; i < hilos; i++)
+            pthread_join(ids[i], NULL);
+        tiempos[forma] = ahora() - inicio;
+        pthread_mutex_destroy(&global);
+        hash_particionado_destruir(hash);
+        hash_destruir(comun);
+    }
+    printf("Particionado %9zu claves con %zu hilos: %.3f s (comun con mutex global %.3f s)\n",
+           largo, hilos, tiempos[1], tiempos[0]);
+    free(claves);
+}
+
+
+/* ******************************************************************
+ *                        FUNCIÓN PRINCIPAL
+ * *****************************************************************/
+
+void pruebas_rendimiento_alumno()
+{
+    rendimiento_redimension(HASH_ABIERTO, "abierto", 2000000, false);
+    rendimiento_redimension(HASH_ABIERTO, "abierto", 2000000, true);
+    rendimiento_redimension(HASH_CERRADO_ROBIN_HOOD, "cerrado robin hood", 2000000, false);
+    rendimiento_redimension(HASH_CERRADO_ROBIN_HOOD, "cerrado robin hood", 2000000, true);
+    rendimiento_latencia(false, 2000000);
+    rendimiento_latencia(true, 2000000);
+    rendimiento_politicas(1000000);
+    rendimiento_funciones_hash();
+    rendimiento_memoria(2000000);
+    rendimiento_chicos(1000000);
+    rendimiento_vaiven(1900, 100, 200);
+    rendimiento_vaiven(2000, 4000, 20);
+    rendimiento_lote(HASH_ABIERTO, "abierto", 4000000);
+    rendimiento_lote(HASH_CERRADO_ROBIN_HOOD, "cerrado robin hood", 4000000);
+    rendimiento_lote(HASH_CERRADO_GRUPOS, "cerrado por grupos", 4000000);
+    rendimiento_carga(HASH_ABIERTO, "abierto", 4000000);
+    rendimiento_carga(HASH_CERRADO_ROBIN_HOOD, "cerrado robin hood", 4000000);
+    rendimiento_carga(HASH_CERRADO_GRUPOS, "cerrado por grupos", 4000000);
+    rendimiento_contar(HASH_ABIERTO, "abierto", 4000000, 100000);
+    rendimiento_contar(HASH_CERRADO_ROBIN_HOOD, "cerrado robin hood", 4000000, 100000);
+    rendimiento_contar(HASH_CERRADO_GRUPOS, "cerrado por grupos", 4000000, 100000);
+    rendimiento_recorrer(HASH_ABIERTO, "abierto", 4000000);
+    rendimiento_recorrer(HASH_CERRADO_ROBIN_HOOD, "cerrado robin hood", 4000000);
+    rendimiento_recorrer(HASH_CERRADO_GRUPOS, "cerrado por grupos", 4000000);
+    rendimiento_concurrente(1000000, 8000000, 20);
+    rendimiento_concurrente(1000000, 8000000, 2);
+    rendimiento_particionado(2000000, 16, 4);
+    rendimiento_hilos(HASH_ABIERTO, "abierto", 4000000);
+    rendimiento_hilos(HASH_CERRADO_LINEAL, "cerrado lineal", 4000000);
+    rendimiento_hilos(HASH_CERRADO_ROBIN_HOOD, "cerrado robin hood", 4000000);
+    rendimiento_hilos(HASH_CERRADO_GRUPOS, "cerrado por grupos", 4000000);
+}